@@ -0,0 +1,45 @@
+/**
+ * \file
+ * Benchmark: Autotuning the traversal of a complex
+ *
+ * Tune the traversal of the faces of a three-dimensional grid with long fibers in the last
+ * direction for a kernel adding the values on the edges of each face, and print the time of
+ * each candidate. The cache file is not used, such that the tuning is always run.
+ */
+
+#include <iostream>
+#include <vector>
+
+#include <tpcc/autotune.h>
+
+int main()
+{
+  TPCC::AutotuneOptions options;
+  options.cache_file.clear();
+  options.log = &std::cout;
+
+  double checksum = 0.;
+  auto kernel = [&](const TPCC::Traversal<3, 2>& traversal) {
+    const auto edges = traversal.mesh().boundary();
+    std::vector<double> values(edges.size(), 1.);
+    traversal.for_each_batch(
+      [&](const TPCC::ElementBlock<3, 2>& elements, const std::vector<unsigned int>&) {
+        for (unsigned int i = 0; i < elements.size(); ++i)
+        {
+          const auto e = elements[i];
+          for (unsigned int f = 0; f < e.n_facets(); ++f)
+            checksum += values[edges.index(e.facet(f))];
+        }
+      });
+  };
+
+  const auto traversal = TPCC::autotune<3, 2>(std::array<unsigned short, 3>{ { 24, 48, 384 } },
+                                              std::array<bool, 3>{}, kernel, options);
+  const auto& config = traversal.configuration();
+  std::cout << "best order";
+  for (unsigned int d = 0; d < 3; ++d)
+    std::cout << ' ' << (unsigned int)config.order[d];
+  std::cout << " tile " << config.tile << " batch " << config.batch_size << "  (" << checksum
+            << ")" << std::endl;
+  return 0;
+}
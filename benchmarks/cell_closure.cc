@@ -0,0 +1,98 @@
+/**
+ * \file
+ * Benchmark: Closure tables of n-cells
+ *
+ * Compute the indices of all `3^n` faces of each `n`-cell, once by constructing each face and
+ * calling Lexicographic::index() for it, and once by CellClosure, serially and in parallel.
+ */
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <tpcc/cell_closure.h>
+
+/// Compute the entries for faces of dimension `k` by constructing each face
+template <int n, int k>
+void decode(const TPCC::Lexicographic<n, n>& cells, std::vector<unsigned int>& table)
+{
+  typedef TPCC::CellClosure<n> closure;
+  std::array<unsigned short, n> dim;
+  std::array<bool, n> periodic;
+  for (unsigned int d = 0; d < n; ++d)
+  {
+    dim[d] = cells.fiber_dimension(d);
+    periodic[d] = cells.is_periodic(d);
+  }
+  const TPCC::Lexicographic<n, k> faces(dim, periodic, cells.direction_order());
+  for (unsigned int i = 0; i < cells.size(); ++i)
+  {
+    const auto cell = cells[i];
+    for (unsigned int f = 0; f < closure::n_faces(); ++f)
+    {
+      if (closure::face_dimension(f) != k)
+        continue;
+      std::array<unsigned int, k> in{};
+      std::array<unsigned int, n - k> out{};
+      std::array<unsigned short, n> x;
+      unsigned int a = 0, c = 0, code = f;
+      for (unsigned int d = 0; d < n; ++d, code /= 3)
+      {
+        if (code % 3 == 1)
+          in[a++] = n - 1 - d;
+        else
+          out[c++] = n - 1 - d;
+        x[d] = cell[d] + ((code % 3 == 2) ? 1 : 0);
+      }
+      const TPCC::Element<n, k> face{ TPCC::Combination<n, k>(in, out), x };
+      table[i * closure::n_faces() + f] = faces.index(face);
+    }
+  }
+}
+
+template <int n, int... k>
+void benchmark(unsigned short size, std::integer_sequence<int, k...>)
+{
+  std::array<unsigned short, n> dim;
+  dim.fill(size);
+  TPCC::Lexicographic<n, n> cells(dim);
+  TPCC::CellClosure<n> closure(cells);
+  std::vector<unsigned int> reference(cells.size() * closure.n_faces());
+  std::vector<unsigned int> table(reference.size());
+  const unsigned int n_threads = std::max(1u, std::thread::hardware_concurrency());
+
+  auto start = std::chrono::steady_clock::now();
+  (decode<n, k>(cells, reference), ...);
+  auto stop = std::chrono::steady_clock::now();
+  const double t_decode = std::chrono::duration<double>(stop - start).count();
+
+  start = std::chrono::steady_clock::now();
+  closure.fill(table.data());
+  stop = std::chrono::steady_clock::now();
+  const double t_serial = std::chrono::duration<double>(stop - start).count();
+  if (table != reference)
+    std::cerr << "Tables differ!" << std::endl;
+
+  start = std::chrono::steady_clock::now();
+  closure.fill(table.data(), n_threads);
+  stop = std::chrono::steady_clock::now();
+  const double t_parallel = std::chrono::duration<double>(stop - start).count();
+  if (table != reference)
+    std::cerr << "Tables differ!" << std::endl;
+
+  std::cout << "n=" << n << " cells " << std::setw(9) << cells.size() << "  decode "
+            << std::setw(10) << t_decode << "s  increments " << std::setw(10) << t_serial
+            << "s  " << n_threads << " threads " << std::setw(10) << t_parallel << 's'
+            << std::endl;
+}
+
+int main()
+{
+  benchmark<2>(512, std::make_integer_sequence<int, 3>());
+  benchmark<3>(64, std::make_integer_sequence<int, 4>());
+  benchmark<4>(16, std::make_integer_sequence<int, 5>());
+  return 0;
+}
@@ -0,0 +1,65 @@
+/**
+ * \file
+ * Benchmark: Combination versus BitCombination
+ *
+ * For all combinations `k` out of `n`, eliminate every member and compute the index of the
+ * result, as done by Element::facet() followed by Lexicographic::index(). The same loop is run
+ * with the array based Combination and the bitmask based BitCombination.
+ */
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include <tpcc/combinations.h>
+
+/// The number of eliminate() operations timed for each pair `(n,k)`
+constexpr unsigned int operations = 5000000;
+
+template <class C, int n, int k>
+double run(const std::vector<C>& combis, unsigned int& checksum)
+{
+  const unsigned int repetitions = operations / (combis.size() * k);
+  auto start = std::chrono::steady_clock::now();
+  for (unsigned int r = 0; r < repetitions; ++r)
+    for (const auto& c : combis)
+      for (unsigned int j = 0; j < k; ++j)
+        checksum += TPCC::Combinations<n, k - 1>::index(c.eliminate(j)) + c.out(0);
+  auto stop = std::chrono::steady_clock::now();
+  return std::chrono::duration<double>(stop - start).count();
+}
+
+template <int n, int k>
+void benchmark()
+{
+  TPCC::Combinations<n, k> combinations;
+  std::vector<TPCC::Combination<n, k, unsigned char>> arrays;
+  std::vector<TPCC::BitCombination<n, k>> masks;
+  for (unsigned int i = 0; i < combinations.size(); ++i)
+  {
+    arrays.emplace_back(combinations[i]);
+    masks.emplace_back(combinations[i]);
+  }
+
+  unsigned int check_array = 0, check_mask = 0;
+  const double t_array = run<TPCC::Combination<n, k, unsigned char>, n, k>(arrays, check_array);
+  const double t_mask = run<TPCC::BitCombination<n, k>, n, k>(masks, check_mask);
+  if (check_array != check_mask)
+    std::cerr << "Checksums differ!" << std::endl;
+
+  std::cout << "n=" << std::setw(2) << n << " k=" << std::setw(2) << k << "  array "
+            << std::setw(10) << t_array << "s  bitmask " << std::setw(10) << t_mask
+            << "s  speedup " << t_array / t_mask << std::endl;
+}
+
+int main()
+{
+  benchmark<3, 1>();
+  benchmark<3, 2>();
+  benchmark<4, 2>();
+  benchmark<6, 3>();
+  benchmark<8, 4>();
+  benchmark<10, 5>();
+  return 0;
+}
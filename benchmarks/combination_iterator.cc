@@ -0,0 +1,75 @@
+/**
+ * \file
+ * Benchmark: Combinations::operator[] versus CombinationIterator
+ *
+ * Visit all combinations `k` out of `n` and sum up their members, once by computing each
+ * combination from its index and once by stepping through them in lexicographic and revolving
+ * door order.
+ */
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+
+#include <tpcc/combinations.h>
+
+/// The number of combinations visited for each pair `(n,k)`
+constexpr unsigned int operations = 5000000;
+
+template <int n, int k, class F>
+double run(F f, unsigned int& checksum)
+{
+  const unsigned int repetitions = operations / TPCC::Combinations<n, k>::size();
+  auto start = std::chrono::steady_clock::now();
+  for (unsigned int r = 0; r < repetitions; ++r)
+    checksum += f();
+  auto stop = std::chrono::steady_clock::now();
+  return std::chrono::duration<double>(stop - start).count();
+}
+
+template <int n, int k>
+void benchmark()
+{
+  unsigned int check_index = 0, check_lex = 0, check_door = 0;
+  const double t_index = run<n, k>(
+    [] {
+      TPCC::Combinations<n, k> combinations;
+      unsigned int sum = 0;
+      for (unsigned int i = 0; i < combinations.size(); ++i)
+      {
+        const auto c = combinations[i];
+        for (unsigned int j = 0; j < k; ++j)
+          sum += c.in(j);
+      }
+      return sum;
+    },
+    check_index);
+
+  auto walk = [](TPCC::CombinationOrder order) {
+    unsigned int sum = 0;
+    for (TPCC::CombinationIterator<n, k> it(order); !it.at_end(); ++it)
+      for (unsigned int j = 0; j < k; ++j)
+        sum += it.in(j);
+    return sum;
+  };
+  const double t_lex =
+    run<n, k>([&] { return walk(TPCC::CombinationOrder::lexicographic); }, check_lex);
+  const double t_door =
+    run<n, k>([&] { return walk(TPCC::CombinationOrder::revolving_door); }, check_door);
+  if (check_index != check_lex || check_index != check_door)
+    std::cerr << "Checksums differ!" << std::endl;
+
+  std::cout << "n=" << std::setw(2) << n << " k=" << std::setw(2) << k << "  operator[] "
+            << std::setw(10) << t_index << "s  lexicographic " << std::setw(10) << t_lex
+            << "s  revolving door " << std::setw(10) << t_door << 's' << std::endl;
+}
+
+int main()
+{
+  benchmark<3, 1>();
+  benchmark<4, 2>();
+  benchmark<6, 3>();
+  benchmark<8, 4>();
+  benchmark<10, 5>();
+  return 0;
+}
@@ -0,0 +1,58 @@
+/**
+ * \file
+ * Benchmark: Diagonal Hodge star through the primal to dual index map
+ *
+ * On a three-dimensional grid, apply a diagonal Hodge star from primal `k`-cochains to dual
+ * `n-k`-cochains by DualMap::vmult(), which maps runs of primal cells to strided runs of dual
+ * cells, and compare with decoding each primal element, computing its dual and its index.
+ */
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include <tpcc/dual.h>
+
+template <int k>
+void benchmark(const std::array<unsigned short, 3>& dim)
+{
+  const TPCC::Lexicographic<3, k> primal(dim);
+  const TPCC::DualMap<3, k> map(primal);
+  const unsigned int N = primal.size();
+  std::vector<double> diagonal(N, 2.), x(N, 1.), y(map.dual().size());
+
+  auto start = std::chrono::steady_clock::now();
+  for (unsigned int i = 0; i < N; ++i)
+    y[map.dual().index(map.dual_element(primal[i]))] = diagonal[i] * x[i];
+  auto stop = std::chrono::steady_clock::now();
+  const double t_elements = std::chrono::duration<double>(stop - start).count() / N;
+
+  start = std::chrono::steady_clock::now();
+  for (unsigned int i = 0; i < N; ++i)
+    y[map.dual_index(i)] = diagonal[i] * x[i];
+  stop = std::chrono::steady_clock::now();
+  const double t_index = std::chrono::duration<double>(stop - start).count() / N;
+
+  const unsigned int repetitions = 10;
+  start = std::chrono::steady_clock::now();
+  for (unsigned int r = 0; r < repetitions; ++r)
+    map.vmult(y.data(), x.data(), diagonal.data());
+  stop = std::chrono::steady_clock::now();
+  const double t_vmult = std::chrono::duration<double>(stop - start).count() / N / repetitions;
+
+  std::cout << "k=" << k << " cells " << std::setw(8) << N << "  elements " << std::setw(6)
+            << std::setprecision(3) << t_elements * 1.e9 << "ns  dual_index " << std::setw(6)
+            << t_index * 1.e9 << "ns  vmult " << std::setw(6) << t_vmult * 1.e9 << "ns  ("
+            << y[N / 2] << ")" << std::endl;
+}
+
+int main()
+{
+  const std::array<unsigned short, 3> dim{ { 96, 96, 96 } };
+  benchmark<0>(dim);
+  benchmark<1>(dim);
+  benchmark<2>(dim);
+  benchmark<3>(dim);
+  return 0;
+}
@@ -0,0 +1,104 @@
+/**
+ * \file
+ * Benchmark: Fast diagonalization against conjugate gradients
+ *
+ * Solve with the Hodge Laplacian on the edges and faces of a three-dimensional complex, once by
+ * the conjugate gradient method with the KroneckerOperator and once by FastDiagonalization,
+ * serially and in parallel.
+ */
+
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include <tpcc/fast_diagonalization.h>
+
+double dot(const std::vector<double>& a, const std::vector<double>& b)
+{
+  double result = 0.;
+  for (unsigned int i = 0; i < a.size(); ++i)
+    result += a[i] * b[i];
+  return result;
+}
+
+/// Unpreconditioned CG with relative tolerance `tolerance`, returning the number of steps
+template <class OP>
+unsigned int cg(const OP& op, std::vector<double>& x, const std::vector<double>& b,
+                double tolerance)
+{
+  std::vector<double> r = b, p = b, Ap(b.size());
+  std::fill(x.begin(), x.end(), 0.);
+  double rr = dot(r, r);
+  const double target = tolerance * tolerance * rr;
+  unsigned int step = 0;
+  for (; rr > target && step < 10000; ++step)
+  {
+    op.vmult(Ap.data(), p.data());
+    const double alpha = rr / dot(p, Ap);
+    for (unsigned int i = 0; i < x.size(); ++i)
+    {
+      x[i] += alpha * p[i];
+      r[i] -= alpha * Ap[i];
+    }
+    const double rr_new = dot(r, r);
+    for (unsigned int i = 0; i < x.size(); ++i)
+      p[i] = r[i] + rr_new / rr * p[i];
+    rr = rr_new;
+  }
+  return step;
+}
+
+template <int n, int k>
+void benchmark(unsigned short size)
+{
+  std::array<unsigned short, n> dim;
+  dim.fill(size);
+  TPCC::Lexicographic<n, k> mesh(dim);
+  const auto op = TPCC::laplacian_operator(mesh);
+  const unsigned int n_threads = std::max(1u, std::thread::hardware_concurrency());
+
+  std::vector<double> b(mesh.size()), x(mesh.size()), y(mesh.size());
+  for (unsigned int i = 0; i < b.size(); ++i)
+    b[i] = std::sin(0.1 * i);
+
+  auto start = std::chrono::steady_clock::now();
+  const unsigned int steps = cg(op, x, b, 1.e-10);
+  auto stop = std::chrono::steady_clock::now();
+  const double t_cg = std::chrono::duration<double>(stop - start).count();
+
+  start = std::chrono::steady_clock::now();
+  const TPCC::FastDiagonalization<n> inverse(op);
+  stop = std::chrono::steady_clock::now();
+  const double t_setup = std::chrono::duration<double>(stop - start).count();
+
+  start = std::chrono::steady_clock::now();
+  inverse.vmult(y.data(), b.data());
+  stop = std::chrono::steady_clock::now();
+  const double t_serial = std::chrono::duration<double>(stop - start).count();
+
+  double error = 0.;
+  for (unsigned int i = 0; i < x.size(); ++i)
+    error = std::max(error, std::fabs(x[i] - y[i]));
+
+  start = std::chrono::steady_clock::now();
+  inverse.vmult(y.data(), b.data(), n_threads);
+  stop = std::chrono::steady_clock::now();
+  const double t_parallel = std::chrono::duration<double>(stop - start).count();
+
+  std::cout << "n=" << n << " k=" << k << " cells " << std::setw(8) << mesh.size() << "  CG "
+            << std::setw(4) << steps << " steps " << std::setw(10) << t_cg << "s  setup "
+            << std::setw(10) << t_setup << "s  solve " << std::setw(10) << t_serial << "s  "
+            << n_threads << " threads " << std::setw(10) << t_parallel << "s  difference "
+            << error << std::endl;
+}
+
+int main()
+{
+  benchmark<3, 1>(24);
+  benchmark<3, 2>(24);
+  benchmark<3, 3>(48);
+  return 0;
+}
@@ -0,0 +1,67 @@
+/**
+ * \file
+ * Benchmark: Decoding and indexing for high tensor orders
+ *
+ * For `n=4..10` and `k=n/2`, where the number of orientation blocks is largest, measure the
+ * time per element of Lexicographic::operator[] and Lexicographic::index() over a sample of
+ * indices spread over all blocks, as well as Combinations::operator[] and
+ * Combinations::index() per orientation.
+ */
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+
+#include <tpcc/lexicographic.h>
+
+template <int n>
+void benchmark(unsigned int samples)
+{
+  constexpr int k = n / 2;
+  std::array<unsigned short, n> dim;
+  dim.fill(4);
+  const TPCC::Lexicographic<n, k> mesh(dim);
+  const unsigned int step = mesh.size() / samples + 1;
+
+  unsigned int checksum = 0;
+  auto start = std::chrono::steady_clock::now();
+  unsigned int count = 0;
+  for (unsigned int i = 0; i < mesh.size(); i += step, ++count)
+    checksum += mesh[i][n - 1];
+  auto stop = std::chrono::steady_clock::now();
+  const double t_decode = std::chrono::duration<double>(stop - start).count() / count;
+
+  start = std::chrono::steady_clock::now();
+  for (unsigned int i = 0; i < mesh.size(); i += step)
+    checksum += mesh.index(mesh[i]);
+  stop = std::chrono::steady_clock::now();
+  const double t_both = std::chrono::duration<double>(stop - start).count() / count;
+
+  TPCC::Combinations<n, k> combinations;
+  start = std::chrono::steady_clock::now();
+  const unsigned int repetitions = 1000;
+  for (unsigned int r = 0; r < repetitions; ++r)
+    for (unsigned int b = 0; b < combinations.size(); ++b)
+      checksum += TPCC::Combinations<n, k>::index(combinations[b]);
+  stop = std::chrono::steady_clock::now();
+  const double t_combination = std::chrono::duration<double>(stop - start).count() /
+                               (repetitions * combinations.size());
+
+  std::cout << "n=" << std::setw(2) << n << " k=" << k << " blocks " << std::setw(3)
+            << combinations.size() << " elements " << std::setw(10) << mesh.size()
+            << "  operator[] " << std::setw(8) << t_decode * 1.e9 << "ns  index(operator[]) "
+            << std::setw(8) << t_both * 1.e9 << "ns  combination " << std::setw(8)
+            << t_combination * 1.e9 << "ns  (" << checksum % 10 << ")" << std::endl;
+}
+
+int main()
+{
+  benchmark<4>(100000);
+  benchmark<5>(100000);
+  benchmark<6>(100000);
+  benchmark<7>(100000);
+  benchmark<8>(100000);
+  benchmark<9>(100000);
+  benchmark<10>(100000);
+  return 0;
+}
@@ -0,0 +1,117 @@
+/**
+ * \file
+ * Benchmark: Kronecker-factored Laplacian
+ *
+ * Apply the Hodge Laplacian on the edges and faces of two- and three-dimensional complexes, once
+ * as a KroneckerOperator and once as a CSRMatrix assembled from its factors, and compare time and
+ * memory.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include <tpcc/kronecker.h>
+#include <tpcc/transfer.h>
+
+template <int n, int k>
+void benchmark(unsigned short size, unsigned int repetitions)
+{
+  std::array<unsigned short, n> dim;
+  dim.fill(size);
+  TPCC::Lexicographic<n, k> mesh(dim);
+  const auto laplacian = TPCC::laplacian_operator(mesh);
+
+  // Assemble the matrix from the terms, multiplying the entries of the factors
+  const unsigned int N = mesh.size();
+  std::vector<std::vector<std::pair<unsigned int, double>>> rows(N);
+  for (unsigned int t = 0; t < laplacian.n_terms(); ++t)
+  {
+    const auto& term = laplacian.term(t);
+    const auto& from = laplacian.domain_layout(term.domain_block);
+    const auto& to = laplacian.range_layout(term.range_block);
+    for (unsigned int i = 0; i < to.size(); ++i)
+    {
+      // Decode the row position and collect the entries of each factor in this row
+      std::array<unsigned short, n> y;
+      unsigned int rest = i;
+      for (unsigned int j = 0; j < n; ++j)
+      {
+        y[to.order[j]] = rest % to.extents[to.order[j]];
+        rest /= to.extents[to.order[j]];
+      }
+      std::vector<std::pair<unsigned int, double>> entries{ { from.offset, term.coefficient } };
+      for (unsigned int d = 0; d < n; ++d)
+      {
+        const auto& A = laplacian.factor(term.factors[d]);
+        std::vector<std::pair<unsigned int, double>> next;
+        for (const auto& e : entries)
+          if (A.is_identity)
+            next.push_back({ e.first + y[d] * from.strides[d], e.second });
+          else
+            for (unsigned int j = A.row_offsets[y[d]]; j < A.row_offsets[y[d] + 1]; ++j)
+              next.push_back({ e.first + A.columns[j] * from.strides[d], e.second * A.values[j] });
+        entries.swap(next);
+      }
+      auto& row = rows[to.index(y)];
+      row.insert(row.end(), entries.begin(), entries.end());
+    }
+  }
+  TPCC::CSRMatrix<unsigned int, double> matrix;
+  matrix.row_offsets.push_back(0);
+  for (auto& row : rows)
+  {
+    // Sum the entries of different terms in the same column
+    std::sort(row.begin(), row.end());
+    for (unsigned int j = 0; j < row.size(); ++j)
+      if (j > 0 && row[j].first == row[j - 1].first)
+        matrix.values.back() += row[j].second;
+      else
+      {
+        matrix.columns.push_back(row[j].first);
+        matrix.values.push_back(row[j].second);
+      }
+    matrix.row_offsets.push_back(matrix.columns.size());
+  }
+  const std::size_t csr_memory = matrix.row_offsets.size() * sizeof(unsigned int) +
+                                 matrix.columns.size() * sizeof(unsigned int) +
+                                 matrix.values.size() * sizeof(double);
+
+  std::vector<double> x(N), y(N), z(N);
+  for (unsigned int i = 0; i < N; ++i)
+    x[i] = 1. / (1. + i);
+
+  auto start = std::chrono::steady_clock::now();
+  for (unsigned int r = 0; r < repetitions; ++r)
+    matrix.vmult(y.data(), x.data());
+  auto stop = std::chrono::steady_clock::now();
+  const double t_csr = std::chrono::duration<double>(stop - start).count() / repetitions;
+
+  start = std::chrono::steady_clock::now();
+  for (unsigned int r = 0; r < repetitions; ++r)
+    laplacian.vmult(z.data(), x.data());
+  stop = std::chrono::steady_clock::now();
+  const double t_kronecker = std::chrono::duration<double>(stop - start).count() / repetitions;
+
+  double error = 0.;
+  for (unsigned int i = 0; i < N; ++i)
+    error = std::max(error, std::abs(y[i] - z[i]));
+  if (error > 1.e-10)
+    std::cerr << "Results differ by " << error << std::endl;
+
+  std::cout << "n=" << n << " k=" << k << " cells " << std::setw(8) << N << "  CSR "
+            << std::setw(10) << t_csr << "s " << std::setw(9) << csr_memory << " bytes"
+            << "  Kronecker " << std::setw(10) << t_kronecker << "s " << std::setw(6)
+            << laplacian.memory_consumption() << " bytes" << std::endl;
+}
+
+int main()
+{
+  benchmark<2, 1>(256, 10);
+  benchmark<3, 1>(32, 10);
+  benchmark<3, 2>(32, 10);
+  return 0;
+}
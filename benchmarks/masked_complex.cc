@@ -0,0 +1,75 @@
+/**
+ * \file
+ * Benchmark: Masked complexes with holes
+ *
+ * Remove a ball of a third of the volume and a row of small obstacles from a three-dimensional
+ * box. For each dimension k, compare the memory of a vector of doubles on the full complex with
+ * the compressed vector and the mask, and measure the time of the mapping between the
+ * numberings in both directions and of building the mask.
+ */
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include <tpcc/masked_complex.h>
+
+template <int k>
+void benchmark(const TPCC::MaskedComplex<3, k>& masked)
+{
+  const unsigned int N = masked.full().size();
+  unsigned int checksum = 0;
+  auto start = std::chrono::steady_clock::now();
+  // A stride coprime to the sizes visits the indices in scattered order
+  for (unsigned int i = 0, j = 0; i < N; ++i, j = (j + 7919) % N)
+    checksum += masked.compressed_index(j);
+  auto stop = std::chrono::steady_clock::now();
+  const double t_rank = std::chrono::duration<double>(stop - start).count() / N;
+
+  const unsigned int M = masked.size();
+  start = std::chrono::steady_clock::now();
+  for (unsigned int i = 0, j = 0; i < M; ++i, j = (j + 7919) % M)
+    checksum += masked.full_index(j);
+  stop = std::chrono::steady_clock::now();
+  const double t_select = std::chrono::duration<double>(stop - start).count() / M;
+
+  const double full_memory = N * sizeof(double);
+  const double masked_memory = M * sizeof(double) + masked.mask().memory_consumption();
+  std::cout << "k=" << k << " active " << std::setw(8) << M << " of " << std::setw(8) << N
+            << "  vector+mask/full " << std::setprecision(3) << masked_memory / full_memory
+            << "  mask bits/cell " << masked.mask().memory_consumption() * 8. / N
+            << "  rank " << t_rank * 1.e9 << "ns  select " << t_select * 1.e9 << "ns  ("
+            << checksum % 10 << ")" << std::endl;
+  if constexpr (k > 0)
+  {
+    start = std::chrono::steady_clock::now();
+    const auto boundary = masked.boundary();
+    stop = std::chrono::steady_clock::now();
+    std::cout << "    boundary mask built in "
+              << std::chrono::duration<double>(stop - start).count() << "s" << std::endl;
+    benchmark(boundary);
+  }
+}
+
+int main()
+{
+  std::array<unsigned short, 3> dim;
+  dim.fill(128);
+  const TPCC::Lexicographic<3, 3> cells(dim);
+  std::vector<bool> mask(cells.size());
+  for (unsigned int i = 0; i < cells.size(); ++i)
+  {
+    const auto e = cells[i];
+    double r2 = 0.;
+    for (unsigned int d = 0; d < 3; ++d)
+    {
+      const double x = (e[d] + 0.5) / dim[d] - 0.5;
+      r2 += x * x;
+    }
+    const bool obstacle = e[0] % 16 < 4 && e[1] % 16 < 4 && e[2] < 16;
+    mask[i] = r2 > 0.185 && !obstacle;
+  }
+  benchmark(TPCC::MaskedComplex<3, 3>(cells, mask));
+  return 0;
+}
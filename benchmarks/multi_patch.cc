@@ -0,0 +1,108 @@
+/**
+ * \file
+ * Benchmark: Global numbering of multi-patch complexes
+ *
+ * Glue eight patches of `48^3` cells, arranged as a `2x2x2` block with alternating reversed
+ * directions, and build the global numbering for each dimension. Compare the memory of the
+ * runs of shared cells with a table of global indices for all cells, and measure the time of
+ * global_index(), global_indices() per cell and local_index().
+ */
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include <tpcc/multi_patch.h>
+
+template <int k>
+void benchmark(const std::vector<TPCC::Lexicographic<3, k>>& patches,
+               const std::vector<TPCC::PatchInterface<3>>& interfaces)
+{
+  auto start = std::chrono::steady_clock::now();
+  const TPCC::MultiPatchComplex<3, k> complex(patches, interfaces);
+  auto stop = std::chrono::steady_clock::now();
+  const double t_setup = std::chrono::duration<double>(stop - start).count();
+
+  std::size_t total = 0, runs = 0;
+  for (unsigned int p = 0; p < complex.n_patches(); ++p)
+  {
+    total += complex.patch(p).size();
+    runs += complex.n_shared_runs(p);
+  }
+
+  unsigned int checksum = 0;
+  start = std::chrono::steady_clock::now();
+  for (unsigned int p = 0; p < complex.n_patches(); ++p)
+    for (unsigned int i = 0; i < complex.patch(p).size(); ++i)
+      checksum += complex.global_index(p, i);
+  stop = std::chrono::steady_clock::now();
+  const double t_single = std::chrono::duration<double>(stop - start).count() / total;
+
+  std::vector<unsigned int> indices(complex.patch(0).size());
+  start = std::chrono::steady_clock::now();
+  for (unsigned int p = 0; p < complex.n_patches(); ++p)
+  {
+    complex.global_indices(p, indices.data());
+    checksum += indices[p];
+  }
+  stop = std::chrono::steady_clock::now();
+  const double t_all = std::chrono::duration<double>(stop - start).count() / total;
+
+  start = std::chrono::steady_clock::now();
+  for (unsigned int g = 0; g < complex.size(); ++g)
+    checksum += complex.local_index(g).second;
+  stop = std::chrono::steady_clock::now();
+  const double t_local = std::chrono::duration<double>(stop - start).count() / complex.size();
+
+  std::cout << "k=" << k << " cells " << std::setw(8) << complex.size() << " of " << std::setw(8)
+            << total << "  runs " << std::setw(5) << runs << "  memory "
+            << complex.memory_consumption() << "B (table " << total * sizeof(unsigned int)
+            << "B)  setup " << std::setprecision(3) << t_setup << "s  global_index "
+            << t_single * 1.e9 << "ns  global_indices " << t_all * 1.e9 << "ns  local_index "
+            << t_local * 1.e9 << "ns  (" << checksum % 10 << ")" << std::endl;
+  if constexpr (k > 0)
+  {
+    std::vector<TPCC::Lexicographic<3, k - 1>> boundaries;
+    for (const auto& patch : patches)
+      boundaries.push_back(patch.boundary());
+    benchmark(boundaries, interfaces);
+  }
+}
+
+int main()
+{
+  const unsigned short size = 48;
+  std::vector<TPCC::Lexicographic<3, 3>> patches;
+  for (unsigned int p = 0; p < 8; ++p)
+    patches.emplace_back(std::array<unsigned short, 3>{ { size, size, size } });
+
+  // Patch `p` sits at position `(p>>d)&1` in direction `d`. Odd patches have all directions
+  // reversed, such that their cut planes also run backwards.
+  std::vector<TPCC::PatchInterface<3>> interfaces;
+  for (unsigned int p = 0; p < 8; ++p)
+    for (unsigned int d = 0; d < 3; ++d)
+      if (((p >> d) & 1) == 0)
+      {
+        const unsigned int q = p | (1u << d);
+        TPCC::PatchInterface<3> interface;
+        const bool flip_p = p % 2, flip_q = q % 2;
+        interface.first.patch = p;
+        interface.first.face = 2 * d + (flip_p ? 0 : 1);
+        interface.second.patch = q;
+        interface.second.face = 2 * d + (flip_q ? 1 : 0);
+        unsigned int i = 0;
+        for (unsigned char e = 0; e < 3; ++e)
+          if (e != d)
+          {
+            interface.first.directions[i] = e;
+            interface.second.directions[i] = e;
+            interface.first.reverse[i] = false;
+            interface.second.reverse[i] = flip_p != flip_q;
+            ++i;
+          }
+        interfaces.push_back(interface);
+      }
+  benchmark(patches, interfaces);
+  return 0;
+}
@@ -0,0 +1,75 @@
+/**
+ * \file
+ * Benchmark: pipeline_for_each() versus a serial loop
+ *
+ * For each 3-cell of a Lexicographic<3,3>, perform an artificial computation depending on the
+ * indices of its facets. The serial loop decodes each element and its facets and computes
+ * immediately, the pipeline decodes in the calling thread and computes in worker threads.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+#include <tpcc/pipeline.h>
+
+/// Some floating point work standing in for a cell kernel
+inline double kernel(unsigned int facet)
+{
+  double x = facet;
+  for (unsigned int i = 0; i < 200; ++i)
+    x = std::sqrt(x + i);
+  return x;
+}
+
+int main()
+{
+  constexpr std::array<unsigned short, 3> dim{ { 64, 64, 64 } };
+  TPCC::Lexicographic<3, 3> mesh(dim);
+  const auto boundary = mesh.boundary();
+
+  auto start = std::chrono::steady_clock::now();
+  double serial_sum = 0.;
+  for (unsigned int i = 0; i < mesh.size(); ++i)
+  {
+    const auto e = mesh[i];
+    for (unsigned int f = 0; f < e.n_facets(); ++f)
+      serial_sum += kernel(boundary.index(e.facet(f)));
+  }
+  const double t_serial =
+    std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  std::cout << "Serial:              " << std::setw(10) << t_serial << "s" << std::endl;
+
+  const unsigned int hardware = std::max(1u, std::thread::hardware_concurrency());
+  for (std::size_t batch_size : { 64, 256, 1024 })
+    for (unsigned int workers = 1; workers <= hardware; workers *= 2)
+    {
+      TPCC::PipelineOptions options;
+      options.batch_size = batch_size;
+      options.n_workers = workers;
+      options.facets = true;
+      std::atomic<double> sum(0.);
+      start = std::chrono::steady_clock::now();
+      TPCC::pipeline_for_each(
+        mesh,
+        [&](const TPCC::ElementBatch<TPCC::Lexicographic<3, 3>>& batch) {
+          double local = 0.;
+          for (unsigned int f : batch.facets)
+            local += kernel(f);
+          double expected = sum.load();
+          while (!sum.compare_exchange_weak(expected, expected + local))
+            ;
+        },
+        options);
+      const double t =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      std::cout << "Batch " << std::setw(5) << batch_size << " workers " << std::setw(3)
+                << workers << std::setw(10) << t << "s  speedup " << t_serial / t
+                << (std::abs(sum - serial_sum) > 1.e-6 * serial_sum ? "  WRONG SUM" : "")
+                << std::endl;
+    }
+  return 0;
+}
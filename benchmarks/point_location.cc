@@ -0,0 +1,69 @@
+/**
+ * \file
+ * Benchmark: Batched point location
+ *
+ * Locate random points in the cells of a three-dimensional grid with uniform and with graded
+ * nodes. Measure the time per point for cell indices only, with local coordinates, and with the
+ * indices of all faces of the cells, serially and in parallel.
+ */
+
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <tpcc/point_location.h>
+
+template <class LOCATOR>
+double run(const LOCATOR& locator, const std::vector<double>& points, bool local, bool faces,
+           unsigned int n_threads)
+{
+  const std::size_t n_points = points.size() / 3;
+  std::vector<unsigned int> cells(n_points);
+  std::vector<double> local_values(local ? points.size() : 0);
+  std::vector<unsigned int> face_values(faces ? n_points * locator.n_faces() : 0);
+  const auto start = std::chrono::steady_clock::now();
+  locator.locate(n_points, points.data(), cells.data(), local ? local_values.data() : nullptr,
+                 faces ? face_values.data() : nullptr, n_threads);
+  const auto stop = std::chrono::steady_clock::now();
+  return std::chrono::duration<double>(stop - start).count() / n_points * 1.e9;
+}
+
+int main()
+{
+  const unsigned short size = 64;
+  const std::size_t n_points = 1000000;
+  const unsigned int n_threads = std::max(1u, std::thread::hardware_concurrency());
+  std::array<unsigned short, 3> dim;
+  dim.fill(size);
+  TPCC::Lexicographic<3, 3> cells(dim);
+
+  std::array<std::vector<double>, 3> nodes;
+  for (unsigned int d = 0; d < 3; ++d)
+    for (unsigned int i = 0; i <= size; ++i)
+      nodes[d].push_back(std::pow(double(i) / size, 1.5));
+  const TPCC::PointLocator<3> graded(cells, nodes);
+  const TPCC::PointLocator<3> uniform(cells, { { 0., 0., 0. } },
+                                      { { 1. / size, 1. / size, 1. / size } });
+
+  std::mt19937 gen(1);
+  std::uniform_real_distribution<double> dist(0., 1.);
+  std::vector<double> points(3 * n_points);
+  for (auto& x : points)
+    x = dist(gen);
+
+  std::cout << "ns per point, " << n_points << " points, " << n_threads << " threads"
+            << std::endl;
+  for (const auto* locator : { &uniform, &graded })
+  {
+    std::cout << ((locator == &uniform) ? "uniform" : "graded ") << "  cells " << std::setw(8)
+              << run(*locator, points, false, false, 1) << "  +local " << std::setw(8)
+              << run(*locator, points, true, false, 1) << "  +faces " << std::setw(8)
+              << run(*locator, points, true, true, 1) << "  parallel cells " << std::setw(8)
+              << run(*locator, points, false, false, n_threads) << std::endl;
+  }
+  return 0;
+}
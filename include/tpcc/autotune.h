@@ -0,0 +1,432 @@
+#ifndef TPCC_AUTOTUNE_H
+#define TPCC_AUTOTUNE_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <ostream>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <tpcc/element_block.h>
+
+namespace TPCC
+{
+/**
+ * \brief The parameters of a Traversal of a Lexicographic complex.
+ */
+template <int n, typename Tint = unsigned char>
+struct TraversalConfiguration
+{
+  /// The direction order of the complex, fastest first
+  std::array<Tint, n> order;
+  /// The edge length of the tiles in each orientation block, or zero for no tiling
+  unsigned int tile = 0;
+  /// The number of elements decoded together into an ElementBlock
+  std::size_t batch_size = 256;
+
+  bool operator==(const TraversalConfiguration& other) const
+  {
+    return order == other.order && tile == other.tile && batch_size == other.batch_size;
+  }
+};
+
+/**
+ * \brief A loop over all elements of a Lexicographic complex in batches decoded into an
+ * ElementBlock.
+ *
+ * The complex is created with the direction order of the TraversalConfiguration, which also
+ * determines the numbering of the data of a kernel. Without tiling, the batches are consecutive
+ * index ranges. Otherwise, each orientation block is traversed in tiles of `tile` elements in
+ * each direction, and the elements of each tile in the order of the block, such that a kernel
+ * accessing neighbors finds them in cache more often for large fibers.
+ */
+template <int n, int k, typename Bint = unsigned int, typename Sint = unsigned short,
+          typename Tint = unsigned char>
+class Traversal
+{
+public:
+  typedef Lexicographic<n, k, Bint, Sint, Tint> complex_type;
+  typedef TraversalConfiguration<n, Tint> configuration_type;
+
+  /// Constructor for a complex with dimensions `dimensions` and periodic directions `periodic`
+  Traversal(const std::array<Sint, n>& dimensions, const std::array<bool, n>& periodic,
+            const configuration_type& configuration)
+    : complex(dimensions, periodic, configuration.order)
+    , config(configuration)
+  {
+  }
+
+  /// The complex traversed, numbered with the configured direction order
+  const complex_type& mesh() const { return complex; }
+
+  /// The configuration
+  const configuration_type& configuration() const { return config; }
+
+  /**
+   * \brief Call `f(elements, indices)` for batches of elements covering the complex once.
+   *
+   * The ElementBlock `elements` holds the elements with the indices `indices` in mesh().
+   */
+  template <class F>
+  void for_each_batch(F f) const;
+
+private:
+  complex_type complex;
+  configuration_type config;
+};
+
+/**
+ * \brief Options for autotune().
+ */
+struct AutotuneOptions
+{
+  /// The file storing the best configurations, or empty to always tune
+  std::string cache_file = "tpcc_autotune.cache";
+  /// A name of the kernel, which is part of the key in the cache file
+  std::string kernel_name = "kernel";
+  /// The number of runs of the kernel for each candidate, of which the fastest counts
+  unsigned int repetitions = 3;
+  /// The tile sizes tried besides no tiling
+  std::vector<unsigned int> tile_sizes{ 4, 8, 16, 32 };
+  /// The batch sizes tried
+  std::vector<std::size_t> batch_sizes{ 64, 256, 1024, 4096 };
+  /// Tune even if the cache file has an entry
+  bool force = false;
+  /// If not null, the time of each candidate is written to this stream
+  std::ostream* log = nullptr;
+};
+
+/**
+ * \brief Candidate direction orders for the fiber dimensions `dimensions`.
+ *
+ * For `n<=3`, these are all permutations. Otherwise, they are the default order, its reverse,
+ * and the orders by decreasing and by increasing fiber dimension.
+ */
+template <int n, typename Sint, typename Tint = unsigned char>
+std::vector<std::array<Tint, n>> direction_orders(const std::array<Sint, n>& dimensions)
+{
+  std::vector<std::array<Tint, n>> result;
+  std::array<Tint, n> order;
+  std::iota(order.begin(), order.end(), Tint(0));
+  if (n <= 3)
+  {
+    std::array<unsigned int, n> permutation;
+    std::iota(permutation.begin(), permutation.end(), 0u);
+    do
+    {
+      std::copy(permutation.begin(), permutation.end(), order.begin());
+      result.push_back(order);
+    } while (std::next_permutation(permutation.begin(), permutation.end()));
+    return result;
+  }
+  result.push_back(order);
+  std::reverse(order.begin(), order.end());
+  result.push_back(order);
+  std::stable_sort(order.begin(), order.end(),
+                   [&](Tint a, Tint b) { return dimensions[a] > dimensions[b]; });
+  result.push_back(order);
+  std::reverse(order.begin(), order.end());
+  result.push_back(order);
+  std::sort(result.begin(), result.end());
+  result.erase(std::unique(result.begin(), result.end()), result.end());
+  return result;
+}
+
+/**
+ * \brief The key of a tuning problem in the cache file of autotune().
+ *
+ * It consists of the kernel name, `n`, `k`, the sizes of the integer types, the fiber dimensions
+ * and periodic directions, the host name and the number of hardware threads, separated by
+ * commas. Spaces are replaced by underscores.
+ */
+template <int n, int k, typename Bint, typename Sint, typename Tint>
+std::string autotune_key(const std::string& kernel_name, const std::array<Sint, n>& dimensions,
+                         const std::array<bool, n>& periodic)
+{
+  char host[256] = "unknown";
+  gethostname(host, sizeof(host) - 1);
+  std::ostringstream key;
+  key << kernel_name << ',' << n << ',' << k << ',' << sizeof(Bint) << sizeof(Sint)
+      << sizeof(Tint) << ',';
+  for (Tint d = 0; d < n; ++d)
+    key << dimensions[d] << (periodic[d] ? "p" : "") << (d + 1 < n ? "x" : "");
+  key << ',' << host << ',' << std::thread::hardware_concurrency();
+  std::string result = key.str();
+  std::replace(result.begin(), result.end(), ' ', '_');
+  return result;
+}
+
+/**
+ * \brief Find the fastest traversal of a complex for `kernel` on this machine.
+ *
+ * The function object `kernel` is called with a `const Traversal<n,k,Bint,Sint,Tint>&` and
+ * should run a representative sweep over all elements, for instance by
+ * Traversal::for_each_batch(). Since the numbering depends on the direction order, it must set
+ * up its data from Traversal::mesh().
+ *
+ * The search is staged to keep the number of candidates small. First, the direction orders of
+ * direction_orders() are timed without tiling and with the first batch size. Then, the tile
+ * sizes smaller than the largest fiber dimension are tried with the best order, and finally
+ * the batch sizes. Each candidate counts with the fastest of `options.repetitions` runs.
+ *
+ * The winner is stored in the text file `options.cache_file`. Its first line is
+ * `tpcc-autotune` followed by the format #autotune_version, and each further line contains the
+ * autotune_key(), the direction order, the tile size, the batch size and the time in seconds.
+ * If the file contains the key with a valid entry, the kernel is not run at all, unless
+ * `options.force` is set. Files of another version are ignored and overwritten. The file is
+ * read again before the new entry is stored, and replaced through a temporary file with a
+ * unique name, such that processes tuning concurrently keep each other's entries in most
+ * cases. If the file cannot be written, the result is returned anyway.
+ */
+template <int n, int k, typename Bint = unsigned int, typename Sint = unsigned short,
+          typename Tint = unsigned char, class KERNEL>
+Traversal<n, k, Bint, Sint, Tint> autotune(const std::array<Sint, n>& dimensions,
+                                           const std::array<bool, n>& periodic, KERNEL kernel,
+                                           const AutotuneOptions& options = AutotuneOptions());
+
+/// The version of the cache file format of autotune()
+constexpr unsigned int autotune_version = 1;
+
+//----------------------------------------------------------------------//
+
+template <int n, int k, typename Bint, typename Sint, typename Tint>
+template <class F>
+void Traversal<n, k, Bint, Sint, Tint>::for_each_batch(F f) const
+{
+  ElementBlock<n, k, Bint, Sint, Tint> elements;
+  std::vector<Bint> indices;
+  indices.reserve(config.batch_size);
+
+  if (config.tile == 0)
+  {
+    for (Bint first = 0; first < complex.size(); first += config.batch_size)
+    {
+      const Bint last = std::min<Bint>(first + config.batch_size, complex.size());
+      indices.resize(last - first);
+      std::iota(indices.begin(), indices.end(), first);
+      elements.clear();
+      elements.fill(complex, first, last);
+      f(elements, indices);
+    }
+    return;
+  }
+
+  auto flush = [&]() {
+    f(elements, indices);
+    elements.clear();
+    indices.clear();
+  };
+  elements.reserve(config.batch_size);
+  // Corners are accumulated in unsigned int, since adding the tile size may exceed Sint
+  const unsigned int tile = config.tile;
+  for (Tint b = 0; b < complex.n_blocks(); ++b)
+  {
+    const auto layout = complex.block_layout(b);
+    if (layout.size() == 0)
+      continue;
+    // The elements of the tile are known from the coordinates, without decoding their indices
+    const auto orientation = complex[layout.offset].combination();
+    // The lower corner of the tile and the position inside, both running over layout.order
+    std::array<unsigned int, n> corner{};
+    bool tiles_done = false;
+    while (!tiles_done)
+    {
+      std::array<Sint, n> end;
+      std::array<Sint, n> x;
+      for (Tint d = 0; d < n; ++d)
+      {
+        end[d] = std::min<unsigned int>(corner[d] + tile, layout.extents[d]);
+        x[d] = corner[d];
+      }
+      bool tile_done = false;
+      while (!tile_done)
+      {
+        indices.push_back(layout.index(x));
+        elements.push_back(Element<n, k, Sint, Tint>{ orientation, x });
+        if (indices.size() == config.batch_size)
+          flush();
+        tile_done = true;
+        for (Tint i = 0; i < n; ++i)
+        {
+          const Tint d = layout.order[i];
+          if (++x[d] < end[d])
+          {
+            tile_done = false;
+            break;
+          }
+          x[d] = corner[d];
+        }
+      }
+      tiles_done = true;
+      for (Tint i = 0; i < n; ++i)
+      {
+        const Tint d = layout.order[i];
+        corner[d] += tile;
+        if (corner[d] < layout.extents[d])
+        {
+          tiles_done = false;
+          break;
+        }
+        corner[d] = 0;
+      }
+    }
+  }
+  if (!indices.empty())
+    flush();
+}
+
+template <int n, int k, typename Bint, typename Sint, typename Tint, class KERNEL>
+Traversal<n, k, Bint, Sint, Tint> autotune(const std::array<Sint, n>& dimensions,
+                                           const std::array<bool, n>& periodic, KERNEL kernel,
+                                           const AutotuneOptions& options)
+{
+  typedef TraversalConfiguration<n, Tint> configuration_type;
+  const std::string key = autotune_key<n, k, Bint, Sint, Tint>(options.kernel_name, dimensions,
+                                                               periodic);
+
+  // Read all entries of the cache file, keeping the lines of other keys. Returns the entry for
+  // `key` if it is valid, in particular if its order is a permutation.
+  std::vector<std::string> lines;
+  auto read = [&](configuration_type& config) {
+    lines.clear();
+    bool found = false;
+    std::ifstream in(options.cache_file);
+    std::string line;
+    std::ostringstream expected;
+    expected << "tpcc-autotune " << autotune_version;
+    if (options.cache_file.empty() || !std::getline(in, line) || line != expected.str())
+      return false;
+    while (std::getline(in, line))
+    {
+      std::istringstream entry(line);
+      std::string entry_key;
+      entry >> entry_key;
+      if (entry_key != key)
+      {
+        lines.push_back(line);
+        continue;
+      }
+      std::array<bool, n> seen{};
+      unsigned int d;
+      bool valid = true;
+      for (Tint i = 0; i < n; ++i)
+      {
+        valid = valid && (entry >> d) && d < n && !seen[d];
+        if (valid)
+        {
+          seen[d] = true;
+          config.order[i] = d;
+        }
+      }
+      valid = valid && (entry >> config.tile >> config.batch_size) && config.batch_size > 0;
+      found = found || valid;
+    }
+    return found;
+  };
+  {
+    configuration_type cached;
+    if (read(cached) && !options.force)
+      return Traversal<n, k, Bint, Sint, Tint>(dimensions, periodic, cached);
+  }
+
+  auto time = [&](const configuration_type& config) {
+    const Traversal<n, k, Bint, Sint, Tint> traversal(dimensions, periodic, config);
+    double best = 0.;
+    for (unsigned int r = 0; r < std::max(1u, options.repetitions); ++r)
+    {
+      const auto start = std::chrono::steady_clock::now();
+      kernel(traversal);
+      const auto stop = std::chrono::steady_clock::now();
+      const double t = std::chrono::duration<double>(stop - start).count();
+      best = (r == 0) ? t : std::min(best, t);
+    }
+    return best;
+  };
+
+  configuration_type best;
+  best.order = Lexicographic<n, k, Bint, Sint, Tint>::default_order();
+  if (!options.batch_sizes.empty())
+    best.batch_size = options.batch_sizes.front();
+  double best_time = -1.;
+  auto consider = [&](const configuration_type& config) {
+    const double t = time(config);
+    if (options.log != nullptr)
+    {
+      *options.log << "order";
+      for (Tint i = 0; i < n; ++i)
+        *options.log << ' ' << (unsigned int)config.order[i];
+      *options.log << " tile " << config.tile << " batch " << config.batch_size << "  " << t
+                   << "s" << std::endl;
+    }
+    if (best_time < 0. || t < best_time)
+    {
+      best = config;
+      best_time = t;
+    }
+  };
+
+  for (const auto& order : direction_orders<n, Sint, Tint>(dimensions))
+  {
+    configuration_type config = best;
+    config.order = order;
+    consider(config);
+  }
+  const Sint largest = *std::max_element(dimensions.begin(), dimensions.end());
+  for (unsigned int tile : options.tile_sizes)
+    if (tile > 0 && tile < largest)
+    {
+      configuration_type config = best;
+      config.tile = tile;
+      consider(config);
+    }
+  const std::size_t first_batch = best.batch_size;
+  for (std::size_t batch_size : options.batch_sizes)
+    if (batch_size > 0 && batch_size != first_batch)
+    {
+      configuration_type config = best;
+      config.batch_size = batch_size;
+      consider(config);
+    }
+
+  if (!options.cache_file.empty())
+  {
+    // Other processes may have added entries while tuning, so read the file again
+    configuration_type ignored;
+    read(ignored);
+    std::ostringstream entry;
+    entry << key;
+    for (Tint i = 0; i < n; ++i)
+      entry << ' ' << (unsigned int)best.order[i];
+    entry << ' ' << best.tile << ' ' << best.batch_size << ' ' << best_time;
+    lines.push_back(entry.str());
+    // Write a temporary file with a unique name and rename it, such that readers never see a
+    // partial file and concurrent writers do not overwrite each other's temporary file
+    std::string temporary = options.cache_file + ".XXXXXX";
+    const int fd = mkstemp(&temporary[0]);
+    if (fd >= 0)
+    {
+      fchmod(fd, 0644);
+      close(fd);
+      std::ofstream out(temporary);
+      out << "tpcc-autotune " << autotune_version << '\n';
+      for (const auto& line : lines)
+        out << line << '\n';
+      out.close();
+      if (!out || std::rename(temporary.c_str(), options.cache_file.c_str()) != 0)
+        std::remove(temporary.c_str());
+    }
+  }
+  return Traversal<n, k, Bint, Sint, Tint>(dimensions, periodic, best);
+}
+} // namespace TPCC
+
+#endif
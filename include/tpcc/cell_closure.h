@@ -0,0 +1,246 @@
+#ifndef TPCC_CELL_CLOSURE_H
+#define TPCC_CELL_CLOSURE_H
+
+#include <algorithm>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <tpcc/lexicographic.h>
+
+namespace TPCC
+{
+/**
+ * \brief Tables of the indices of all faces in the closure of each `n`-cell of a complex.
+ *
+ * An `n`-cell with coordinates `x` has `3^n` faces of all dimensions including itself. Face
+ * number `s = sum s[d] 3^d` has the coordinate `x[d]` in direction `d` if `s[d]==0` and
+ * `x[d]+1` if `s[d]==2`, both across the face, while it extends along direction `d` if
+ * `s[d]==1`. Thus, its dimension is the number of digits equal to one, see face_dimension(),
+ * and the table entry is its index in the Lexicographic complex of this dimension with the
+ * same fiber dimensions, periodic directions and direction order. Face `(3^n-1)/2` is the cell
+ * itself.
+ *
+ * For each face, the difference of its index between neighboring cells is constant within an
+ * orientation block. Therefore, the tables are computed by adding a precomputed increment
+ * for each face when stepping to the next cell, without decoding any element or computing
+ * facets. Only periodic directions need a separate increment for the step into the last cell,
+ * whose upper faces wrap around to the coordinate zero.
+ */
+template <int n, typename Bint = unsigned int, typename Sint = unsigned short,
+          typename Tint = unsigned char>
+class CellClosure
+{
+public:
+  typedef Lexicographic<n, n, Bint, Sint, Tint> complex_type;
+  typedef typename BlockLayout<n, Bint, Sint, Tint>::difference_t difference_t;
+
+  /// Constructor computing the increments for the complex of `n`-cells `cells`
+  CellClosure(const complex_type& cells);
+
+  /// The number of faces of each cell, namely `3^n`
+  static constexpr unsigned int n_faces()
+  {
+    return BlockLayout<n, Bint, Sint, Tint>::n_neighbors();
+  }
+
+  /// The dimension of the face with local number `face`
+  static constexpr Tint face_dimension(unsigned int face)
+  {
+    Tint result = 0;
+    for (Tint d = 0; d < n; ++d, face /= 3)
+      result += (face % 3 == 1) ? 1 : 0;
+    return result;
+  }
+
+  /// The number of `n`-cells
+  Bint size() const { return layout.size(); }
+
+  /**
+   * \brief Write the face indices of the cells `first` to `last-1` into `table`.
+   *
+   * The entry for face `f` of cell `i` is `table[(i-first)*n_faces()+f]`.
+   */
+  void fill(Bint first, Bint last, Bint* table) const;
+
+  /**
+   * \brief Write the face indices of all cells into `table`, which must have at least
+   * `size()*n_faces()` entries.
+   *
+   * The cells are split into `n_threads` ranges processed concurrently.
+   */
+  void fill(Bint* table, unsigned int n_threads = 1) const;
+
+  /// The table for the cells `first` to `last-1`
+  std::vector<Bint> table(Bint first, Bint last) const
+  {
+    std::vector<Bint> result((last - first) * n_faces());
+    fill(first, last, result.data());
+    return result;
+  }
+
+private:
+  /// Compute offsets and strides of the faces of dimension `k`
+  template <int k>
+  void setup(const complex_type& cells);
+
+  /// Call setup() for all dimensions
+  template <int... k>
+  void setup_all(const complex_type& cells, std::integer_sequence<int, k...>)
+  {
+    (setup<k>(cells), ...);
+  }
+
+  /// The coordinate of face `face` in direction `d` of the cell with coordinate `x`
+  Sint position(Sint x, unsigned int face, Tint d) const
+  {
+    for (Tint i = 0; i < d; ++i)
+      face /= 3;
+    if (face % 3 != 2)
+      return x;
+    return (periodic[d] && x + 1 == layout.extents[d]) ? 0 : x + 1;
+  }
+
+  /// The layout of the `n`-cells
+  BlockLayout<n, Bint, Sint, Tint> layout;
+  std::array<bool, n> periodic;
+  /// The index of each face of the cell with coordinates zero
+  std::array<Bint, BlockLayout<n, Bint, Sint, Tint>::n_neighbors()> offsets;
+  /// The strides of the orientation block of each face
+  std::array<std::array<Bint, n>, BlockLayout<n, Bint, Sint, Tint>::n_neighbors()> strides;
+  /// Increments of each face for a step in direction `d`, stored at `d*n_faces()+face`
+  std::vector<difference_t> increments;
+  /// Increments for the step into the last cell in direction `d`
+  std::vector<difference_t> last_increments;
+  /// Increments for going back from the last cell to the first in direction `d`
+  std::vector<difference_t> resets;
+};
+
+//----------------------------------------------------------------------//
+
+template <int n, typename Bint, typename Sint, typename Tint>
+CellClosure<n, Bint, Sint, Tint>::CellClosure(const complex_type& cells)
+  : layout(cells.block_layout(0))
+  , increments(n * n_faces())
+  , last_increments(n * n_faces())
+  , resets(n * n_faces())
+{
+  require_unreversed(cells, "CellClosure");
+  for (Tint d = 0; d < n; ++d)
+    periodic[d] = cells.is_periodic(d);
+  setup_all(cells, std::make_integer_sequence<int, n + 1>());
+
+  for (unsigned int f = 0; f < n_faces(); ++f)
+    for (Tint d = 0; d < n; ++d)
+    {
+      const difference_t stride = strides[f][d];
+      const difference_t extent = layout.extents[d];
+      auto pos = [&](Sint x) { return difference_t(position(x, f, d)); };
+      increments[d * n_faces() + f] = stride;
+      // With a single cell in direction `d`, there is no step to the last cell
+      last_increments[d * n_faces() + f] =
+        (extent > 1) ? (pos(extent - 1) - pos(extent - 2)) * stride : 0;
+      resets[d * n_faces() + f] = (pos(0) - pos(extent - 1)) * stride;
+    }
+}
+
+template <int n, typename Bint, typename Sint, typename Tint>
+template <int k>
+void CellClosure<n, Bint, Sint, Tint>::setup(const complex_type& cells)
+{
+  std::array<Sint, n> dimensions;
+  for (Tint d = 0; d < n; ++d)
+    dimensions[d] = cells.fiber_dimension(d);
+  const Lexicographic<n, k, Bint, Sint, Tint> faces(dimensions, periodic, cells.direction_order());
+
+  for (Tint b = 0; b < faces.n_blocks(); ++b)
+  {
+    const auto face_layout = faces.block_layout(b);
+    std::array<bool, n> along{};
+    for (Tint i = 0; i < k; ++i)
+      along[face_layout.order[i]] = true;
+
+    // All faces with this orientation differ by lower and upper ends across
+    for (unsigned int f = 0; f < n_faces(); ++f)
+    {
+      bool match = true;
+      unsigned int code = f;
+      for (Tint d = 0; d < n; ++d, code /= 3)
+        match = match && ((code % 3 == 1) == along[d]);
+      if (!match)
+        continue;
+      strides[f] = face_layout.strides;
+      offsets[f] = face_layout.offset;
+      for (Tint d = 0; d < n; ++d)
+        offsets[f] += position(0, f, d) * face_layout.strides[d];
+    }
+  }
+}
+
+template <int n, typename Bint, typename Sint, typename Tint>
+void CellClosure<n, Bint, Sint, Tint>::fill(Bint first, Bint last, Bint* table) const
+{
+  if (first >= last)
+    return;
+  std::array<Sint, n> x{};
+  Bint rest = first;
+  for (Tint i = 0; i < n; ++i)
+  {
+    const Tint d = layout.order[i];
+    x[d] = rest % layout.extents[d];
+    rest /= layout.extents[d];
+  }
+  std::array<Bint, BlockLayout<n, Bint, Sint, Tint>::n_neighbors()> current;
+  for (unsigned int f = 0; f < n_faces(); ++f)
+  {
+    current[f] = offsets[f];
+    for (Tint d = 0; d < n; ++d)
+      current[f] += (position(x[d], f, d) - position(0, f, d)) * strides[f][d];
+  }
+
+  for (Bint i = first; i < last; ++i)
+  {
+    std::copy(current.begin(), current.end(), table);
+    table += n_faces();
+    for (Tint j = 0; j < n; ++j)
+    {
+      const Tint d = layout.order[j];
+      if (++x[d] < layout.extents[d])
+      {
+        const difference_t* inc = (x[d] + 1 == layout.extents[d])
+                                    ? &last_increments[d * n_faces()]
+                                    : &increments[d * n_faces()];
+        for (unsigned int f = 0; f < n_faces(); ++f)
+          current[f] += inc[f];
+        break;
+      }
+      x[d] = 0;
+      for (unsigned int f = 0; f < n_faces(); ++f)
+        current[f] += resets[d * n_faces() + f];
+    }
+  }
+}
+
+template <int n, typename Bint, typename Sint, typename Tint>
+void CellClosure<n, Bint, Sint, Tint>::fill(Bint* table, unsigned int n_threads) const
+{
+  n_threads = std::max(1u, n_threads);
+  const Bint total = size();
+  if (n_threads == 1 || total < 2 * n_threads)
+  {
+    fill(0, total, table);
+    return;
+  }
+  std::vector<std::thread> threads;
+  for (unsigned int t = 0; t < n_threads; ++t)
+  {
+    const Bint first = total * t / n_threads;
+    const Bint last = total * (t + 1) / n_threads;
+    threads.emplace_back([=]() { fill(first, last, table + first * n_faces()); });
+  }
+  for (auto& thread : threads)
+    thread.join();
+}
+} // namespace TPCC
+
+#endif
@@ -0,0 +1,200 @@
+#ifndef TPCC_COLORING_H
+#define TPCC_COLORING_H
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include <tpcc/lexicographic.h>
+
+namespace TPCC
+{
+/**
+ * \brief A coloring of the cells of a Lexicographic complex such that no two cells of the same
+ * color share a vertex, and thus neither a facet.
+ *
+ * Cells of one color can be processed concurrently, even if they scatter values into the
+ * entries of their facets or vertices, without atomic operations or locks.
+ *
+ * The coloring is analytic. Each color lies inside a single orientation block, and colors are
+ * numbered block by block. Inside a block, cells whose coordinates across differ do not
+ * intersect at all. Thus, only the parity of the `k` coordinates along the cells determines the
+ * color, and each block has `2^k` colors. In a periodic direction with an odd number of cells,
+ * the first and the last cell are neighbors of the same parity. There, the last cell receives a
+ * third color of its own, such that the block has up to `3^k` colors.
+ *
+ * The cells of one color form a strided subarray of their block. It is described by a
+ * BlockLayout with the strides of the block multiplied by two, such that the loops documented
+ * there and BlockLayout::index() apply to each color as well.
+ */
+template <int n, int k, typename Bint = unsigned int, typename Sint = unsigned short,
+          typename Tint = unsigned char>
+class Coloring
+{
+public:
+  typedef Lexicographic<n, k, Bint, Sint, Tint> complex_type;
+  typedef BlockLayout<n, Bint, Sint, Tint> layout_type;
+
+  /// Constructor computing the layouts of all colors of `mesh`
+  Coloring(const complex_type& mesh);
+
+  /// The total number of colors in all blocks
+  unsigned int n_colors() const { return layouts.size(); }
+
+  /// The orientation block containing the cells of color `color`
+  Tint block(unsigned int color) const { return blocks[color]; }
+
+  /// The first color in the orientation block `block`
+  unsigned int first_color(Tint block) const { return first_colors[block]; }
+
+  /**
+   * \brief The cells of color `color` as a strided subarray of their orientation block.
+   *
+   * The layout may be empty in directions with a single cell.
+   */
+  const layout_type& color_layout(unsigned int color) const { return layouts[color]; }
+
+  /// The color of the cell `e`
+  unsigned int color(const typename complex_type::value_type& e) const;
+
+  /**
+   * \brief Call `f(index)` for every cell, color by color.
+   *
+   * The cells of each color are split into `n_threads` ranges processed concurrently. All cells
+   * of one color are finished before the next color is started.
+   */
+  template <class F>
+  void for_each(F f, unsigned int n_threads = 1) const;
+
+private:
+  /// The number of values of the color digit in direction `d`, two or three
+  Sint radix(Tint d) const { return (periodic_odd[d]) ? 3 : 2; }
+
+  std::vector<layout_type> layouts;
+  std::vector<Tint> blocks;
+  std::array<unsigned int, binomial(n, k)> first_colors;
+  /// The layouts of the orientation blocks, whose first `k` directions are along the cells
+  std::array<layout_type, binomial(n, k)> block_layouts;
+  /// Directions where the last cell needs a color of its own
+  std::array<bool, n> periodic_odd;
+};
+
+//----------------------------------------------------------------------//
+
+template <int n, int k, typename Bint, typename Sint, typename Tint>
+Coloring<n, k, Bint, Sint, Tint>::Coloring(const complex_type& mesh)
+{
+  require_unreversed(mesh, "Coloring");
+  for (Tint d = 0; d < n; ++d)
+    periodic_odd[d] = mesh.is_periodic(d) && mesh.fiber_dimension(d) % 2 == 1 &&
+                      mesh.fiber_dimension(d) > 1;
+
+  for (Tint b = 0; b < mesh.n_blocks(); ++b)
+  {
+    const layout_type block_layout = mesh.block_layout(b);
+    block_layouts[b] = block_layout;
+    first_colors[b] = layouts.size();
+
+    unsigned int n_block_colors = 1;
+    for (Tint i = 0; i < k; ++i)
+      n_block_colors *= radix(block_layout.order[i]);
+
+    for (unsigned int c = 0; c < n_block_colors; ++c)
+    {
+      // The digits of the color, fastest direction first
+      layout_type layout = block_layout;
+      unsigned int code = c;
+      for (Tint i = 0; i < k; ++i)
+      {
+        const Tint d = block_layout.order[i];
+        const Sint digit = code % radix(d);
+        code /= radix(d);
+        // With the extra color, the even and odd colors exclude the last cell
+        const Sint extent = block_layout.extents[d] - (periodic_odd[d] ? 1 : 0);
+        if (digit == 2)
+        {
+          layout.offset += extent * block_layout.strides[d];
+          layout.extents[d] = 1;
+        }
+        else
+        {
+          layout.offset += digit * block_layout.strides[d];
+          layout.extents[d] = (extent > digit) ? (extent - digit + 1) / 2 : 0;
+          layout.strides[d] *= 2;
+        }
+      }
+      layouts.push_back(layout);
+      blocks.push_back(b);
+    }
+  }
+}
+
+template <int n, int k, typename Bint, typename Sint, typename Tint>
+unsigned int Coloring<n, k, Bint, Sint, Tint>::color(
+  const typename complex_type::value_type& e) const
+{
+  const Tint b = e.direction_index();
+  const layout_type& block_layout = block_layouts[b];
+  unsigned int result = 0;
+  unsigned int factor = 1;
+  for (Tint i = 0; i < k; ++i)
+  {
+    const Tint d = block_layout.order[i];
+    const bool last = periodic_odd[d] && e[d] + 1 == block_layout.extents[d];
+    result += factor * (last ? 2 : e[d] % 2);
+    factor *= radix(d);
+  }
+  return first_colors[b] + result;
+}
+
+template <int n, int k, typename Bint, typename Sint, typename Tint>
+template <class F>
+void Coloring<n, k, Bint, Sint, Tint>::for_each(F f, unsigned int n_threads) const
+{
+  n_threads = std::max(1u, n_threads);
+  for (const layout_type& layout : layouts)
+  {
+    const Bint size = layout.size();
+    if (size == 0)
+      continue;
+    auto kernel = [&](Bint first, Bint last) {
+      // Decode the coordinates of the first cell, then step through the color
+      std::array<Sint, n> x{};
+      Bint rest = first;
+      for (Tint i = 0; i < n; ++i)
+      {
+        const Tint d = layout.order[i];
+        x[d] = rest % layout.extents[d];
+        rest /= layout.extents[d];
+      }
+      Bint index = layout.index(x);
+      for (Bint i = first; i < last; ++i)
+      {
+        f(index);
+        for (Tint j = 0; j < n; ++j)
+        {
+          const Tint d = layout.order[j];
+          index += layout.strides[d];
+          if (++x[d] < layout.extents[d])
+            break;
+          index -= x[d] * layout.strides[d];
+          x[d] = 0;
+        }
+      }
+    };
+
+    if (n_threads == 1 || size < 2 * n_threads)
+      kernel(0, size);
+    else
+    {
+      std::vector<std::thread> threads;
+      for (unsigned int t = 0; t < n_threads; ++t)
+        threads.emplace_back(kernel, size * t / n_threads, size * (t + 1) / n_threads);
+      for (auto& thread : threads)
+        thread.join();
+    }
+  }
+}
+} // namespace TPCC
+
+#endif
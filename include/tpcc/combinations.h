@@ -3,8 +3,15 @@
 
 #include <array>
 #include <cassert>
+#include <cstdint>
 #include <ostream>
 
+#include <tpcc/instrumentation.h>
+
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
 namespace TPCC
 {
 /**
@@ -39,9 +46,9 @@ constexpr T binomial(T n, T k)
 template <typename T = unsigned int, T n, T k>
 constexpr std::array<T, n - k> compute_complement(std::array<T, k> combi)
 {
-  std::array<unsigned int, n - k> result{};
+  std::array<T, n - k> result{};
   unsigned int vpos = 0;
-  unsigned int current = n - 1;
+  T current = n - 1;
 
   for (unsigned int i = 0; i < n - k; ++i, --current)
   {
@@ -57,36 +64,62 @@ constexpr std::array<T, n - k> compute_complement(std::array<T, k> combi)
 
 /**
  * \brief Dataset for a combination k out of n
+ *
+ * The members and the non-members of the combination are stored consecutively in a single array
+ * of length `n`, the `k` members first. Thus, the object occupies exactly `n` integers of type
+ * `T`, which allows for small objects if `T` is chosen as a small type like `unsigned char`.
  */
 template <int n, int k, typename T = unsigned int>
 class Combination
 {
-  /// The array of members
-  std::array<T, k> data;
-  /// The array of non-members
-  std::array<T, n - k> cdata;
+  /// The array of members, followed by the array of non-members
+  std::array<T, n> data;
 
 public:
-  Combination(const std::array<T, k>& combi, const std::array<T, n - k>& comp)
-    : data(combi)
-    , cdata(comp)
+  template <typename T2>
+  constexpr Combination(const std::array<T2, k>& combi, const std::array<T2, n - k>& comp)
+    : data{}
+  {
+    for (unsigned int i = 0; i < k; ++i)
+      data[i] = combi[i];
+    for (unsigned int i = 0; i < n - k; ++i)
+      data[k + i] = comp[i];
+  }
+
+  /**
+   * \brief Conversion from a combination using a different integer type.
+   */
+  template <typename T2>
+  constexpr explicit Combination(const Combination<n, k, T2>& other)
+    : data{}
   {
+    for (unsigned int i = 0; i < n; ++i)
+      data[i] = (i < k) ? other.in(i) : other.out(i - k);
   }
+
   /**
    * \brief The `i`th element which is part of the combination in
    * descending order.
    */
-  T in(unsigned int i) const { return data[i]; }
+  constexpr T in(unsigned int i) const { return data[i]; }
   /**
    * \brief The `i`th element which is <b>not</b> part of the combination in
    * descending order.
    */
-  T out(unsigned int i) const { return cdata[i]; }
+  constexpr T out(unsigned int i) const { return data[k + i]; }
 
   /**
    * \brief Return the complement of this combination.
    */
-  Combination<n, n - k, T> complement() const { return Combination<n, n - k, T>(cdata, data); }
+  constexpr Combination<n, n - k, T> complement() const
+  {
+    std::array<T, n> result{};
+    for (unsigned int i = 0; i < n - k; ++i)
+      result[i] = out(i);
+    for (unsigned int i = 0; i < k; ++i)
+      result[n - k + i] = in(i);
+    return Combination<n, n - k, T>(result);
+  }
 
   /**
    * \brief The combination obtained by eliminating the `i`th element
@@ -98,27 +131,22 @@ public:
   constexpr typename std::enable_if<(kk > 0), Combination<n, k - 1, T>>::type eliminate(
     unsigned int i) const
   {
-    std::array<T, k - 1> outdata{};
-    for (unsigned int j = 0; j < i; ++j)
-      outdata[j] = data[j];
+    std::array<T, n> result{};
+    unsigned int j = 0;
+    for (; j < i; ++j)
+      result[j] = data[j];
     const T tmp = data[i];
-    for (unsigned int j = i; j < k - 1; ++j)
-      outdata[j] = data[j + 1];
+    for (; j < k - 1; ++j)
+      result[j] = data[j + 1];
 
-    std::array<T, n - k + 1> outcdata{};
-    unsigned int jj = 0, j = 0;
-    for (; j < n - k; ++j, ++jj)
-    {
-      if (jj == j && cdata[j] < tmp)
-      {
-        outcdata[j] = tmp;
-        ++jj;
-      }
-      outcdata[jj] = cdata[j];
-    }
-    if (jj == j)
-      outcdata[n - k] = tmp;
-    return Combination<n, k - 1>{ outdata, outcdata };
+    // Insert the eliminated value into the descending sequence of non-members
+    unsigned int src = k;
+    for (; src < n && data[src] > tmp; ++src, ++j)
+      result[j] = data[src];
+    result[j++] = tmp;
+    for (; src < n; ++src, ++j)
+      result[j] = data[src];
+    return Combination<n, k - 1, T>(result);
   }
   /**
    * \brief The combination obtained by adding the element `i`.
@@ -130,31 +158,20 @@ public:
   constexpr typename std::enable_if<(kk < n), Combination<n, k + 1, T>>::type add(
     unsigned int i) const
   {
-    std::array<T, k + 1> outdata{};
-    int jj = 0, j = 0;
-    for (; j < k; ++j, ++jj)
-    {
-      if (jj == j && data[j] <= i)
-      {
-        assert(data[j] != i);
-        outdata[j] = i;
-        ++jj;
-      }
-      outdata[jj] = data[j];
-    }
-    if (jj == j)
-      outdata[k] = i;
+    std::array<T, n> result{};
+    unsigned int j = 0, src = 0;
+    for (; src < k && data[src] > i; ++src, ++j)
+      result[j] = data[src];
+    assert(src == k || data[src] != i);
+    result[j++] = i;
+    for (; src < k; ++src, ++j)
+      result[j] = data[src];
 
-    std::array<T, n - k - 1> outcdata{};
-    j = 0;
-    jj = 0;
-    for (; j < n - k - 1; ++j, ++jj)
-    {
-      if (cdata[j] == i)
-        ++jj;
-      outcdata[j] = cdata[jj];
-    }
-    return Combination<n, k + 1>{ outdata, outcdata };
+    // Remove the added value from the non-members
+    for (; src < n && j < n; ++src)
+      if (data[src] != i)
+        result[j++] = data[src];
+    return Combination<n, k + 1, T>(result);
   }
 
   /**
@@ -164,10 +181,157 @@ public:
   constexpr typename std::enable_if<(kk <= n), Combination<n + 1, k + 1, T>>::type add_and_expand(
     unsigned int i) const
   {
-    std::array<T, n + 1 - k> outcdata{};
-    std::copy(cdata.begin(), cdata.end(), outcdata.begin());
-    outcdata[n - k] = n;
-    return Combination<n + 1, k>{ data, outcdata }.add(i);
+    std::array<T, n + 1> result{};
+    std::copy(data.begin(), data.end(), result.begin());
+    result[n] = n;
+    return Combination<n + 1, k, T>(result).add(i);
+  }
+
+  /**
+   * \brief Print the content of this object for debugging.
+   */
+  void print_debug(std::ostream& os) const
+  {
+    for (int i = 0; i < k; ++i)
+      os << (unsigned int)in(i);
+    os << ':';
+    for (int i = 0; i < n - k; ++i)
+      os << (unsigned int)out(i);
+  }
+
+private:
+  /// Constructor from the concatenated arrays of members and non-members
+  constexpr explicit Combination(const std::array<T, n>& all)
+    : data(all)
+  {
+  }
+
+  template <int, int, typename>
+  friend class Combination;
+};
+
+/**
+ * \brief Position of the `r`th set bit of `mask`, counted from the least significant bit.
+ *
+ * Uses the `pdep` instruction if the code is compiled with BMI2 support, otherwise clears the
+ * lowest `r` bits one by one.
+ */
+inline unsigned int select_bit(std::uint32_t mask, unsigned int r)
+{
+#if defined(__BMI2__)
+  return __builtin_ctz(_pdep_u32(std::uint32_t(1) << r, mask));
+#else
+  for (; r > 0; --r)
+    mask &= mask - 1;
+  return __builtin_ctz(mask);
+#endif
+}
+
+/**
+ * \brief A combination `k` out of `n` stored as a bitmask
+ *
+ * This class offers the same interface as Combination, but stores the combination in a single
+ * integer with bit `i` set if `i` is a member. Thus, complement(), eliminate() and add() are
+ * single bit operations and in() and out() amount to selecting a set bit, which is a single
+ * `pdep` instruction on processors supporting BMI2. It is restricted to `n` at most 32.
+ *
+ * Members and non-members are still reported in descending order by in() and out().
+ *
+ * \note Since non-members are always sorted, the result of add_and_expand() only coincides with
+ * the one of Combination::add_and_expand() if the added element is `n`.
+ */
+template <int n, int k>
+class BitCombination
+{
+  static_assert(n <= 32, "BitCombination is restricted to n <= 32");
+
+  /// The bit `i` is set if `i` is member of the combination
+  std::uint32_t mask;
+
+  /// The mask with all `n` bits set
+  static constexpr std::uint32_t all() { return (n == 32) ? ~std::uint32_t(0) : ((1u << n) - 1); }
+
+public:
+  /// Constructor from a bitmask with exactly `k` bits set
+  constexpr explicit BitCombination(std::uint32_t bits)
+    : mask(bits)
+  {
+    assert(__builtin_popcount(bits) == k);
+    assert((bits & ~all()) == 0);
+  }
+
+  /// Conversion from the array based Combination
+  template <typename T>
+  constexpr explicit BitCombination(const Combination<n, k, T>& combi)
+    : mask(0)
+  {
+    for (unsigned int i = 0; i < k; ++i)
+      mask |= std::uint32_t(1) << combi.in(i);
+  }
+
+  /// Conversion to the array based Combination
+  template <typename T = unsigned int>
+  Combination<n, k, T> combination() const
+  {
+    std::array<T, k> data{};
+    std::array<T, n - k> cdata{};
+    for (unsigned int i = 0; i < k; ++i)
+      data[i] = in(i);
+    for (unsigned int i = 0; i < n - k; ++i)
+      cdata[i] = out(i);
+    return Combination<n, k, T>(data, cdata);
+  }
+
+  /// The bitmask of members
+  constexpr std::uint32_t bits() const { return mask; }
+
+  /**
+   * \brief The `i`th element which is part of the combination in
+   * descending order.
+   */
+  unsigned int in(unsigned int i) const { return select_bit(mask, k - 1 - i); }
+  /**
+   * \brief The `i`th element which is <b>not</b> part of the combination in
+   * descending order.
+   */
+  unsigned int out(unsigned int i) const { return select_bit(mask ^ all(), n - k - 1 - i); }
+
+  /**
+   * \brief Return the complement of this combination.
+   */
+  constexpr BitCombination<n, n - k> complement() const
+  {
+    return BitCombination<n, n - k>(mask ^ all());
+  }
+
+  /**
+   * \brief The combination obtained by eliminating the `i`th element
+   */
+  template <int kk = k>
+  typename std::enable_if<(kk > 0), BitCombination<n, k - 1>>::type eliminate(unsigned int i) const
+  {
+    return BitCombination<n, k - 1>(mask & ~(std::uint32_t(1) << in(i)));
+  }
+
+  /**
+   * \brief The combination obtained by adding the element `i`.
+   */
+  template <int kk = k>
+  constexpr typename std::enable_if<(kk < n), BitCombination<n, k + 1>>::type add(
+    unsigned int i) const
+  {
+    assert((mask & (std::uint32_t(1) << i)) == 0);
+    return BitCombination<n, k + 1>(mask | (std::uint32_t(1) << i));
+  }
+
+  /**
+   * \brief The combination out of `n+1` obtained by adding one element
+   */
+  template <int kk = k>
+  constexpr typename std::enable_if<(kk <= n), BitCombination<n + 1, k + 1>>::type add_and_expand(
+    unsigned int i) const
+  {
+    return BitCombination<n + 1, k + 1>(mask | (std::uint32_t(1) << i));
   }
 
   /**
@@ -183,6 +347,19 @@ public:
   }
 };
 
+/**
+ * \brief The table of binomial coefficients `table[m][r]` for `m<=n` and `r<=k`.
+ */
+template <int n, int k>
+constexpr std::array<std::array<unsigned int, k + 1>, n + 1> binomial_table()
+{
+  std::array<std::array<unsigned int, k + 1>, n + 1> result{};
+  for (unsigned int m = 0; m <= n; ++m)
+    for (unsigned int r = 0; r <= k; ++r)
+      result[m][r] = binomial<unsigned int>(m, r);
+  return result;
+}
+
 /**
  * The combinations of `k` elements out of `n` as a container.
  *
@@ -223,15 +400,17 @@ struct Combinations
    * \brief The index of a combination within the lexicographic enumeration
    */
   template <typename T>
-  static constexpr unsigned int index(const Combination<n, k, T>& combi);
+  static TPCC_INSTRUMENTED_CONSTEXPR unsigned int index(const Combination<n, k, T>& combi);
 
-private:
   /**
-   * \brief The function template computing the combination in
-   * lexicographic ordering recursively.
+   * \brief The index of a combination stored as bitmask within the lexicographic enumeration
    */
-  template <unsigned int size, typename... I>
-  static constexpr std::array<unsigned int, k> compute_value(unsigned int index, I... args);
+  static TPCC_INSTRUMENTED_CONSTEXPR unsigned int index(const BitCombination<n, k>& combi);
+
+private:
+  /// The binomial coefficients needed by value() and index()
+  static constexpr std::array<std::array<unsigned int, k + 1>, n + 1> binomials =
+    binomial_table<n, k>();
 };
 
 //----------------------------------------------------------------------//
@@ -243,38 +422,28 @@ constexpr unsigned int Combinations<n, k>::size()
 }
 
 template <int n, int k>
-template <unsigned int sz, typename... I>
-constexpr std::array<unsigned int, k> Combinations<n, k>::compute_value(unsigned int index,
-                                                                        I... args)
+template <typename T>
+inline TPCC_INSTRUMENTED_CONSTEXPR unsigned int
+Combinations<n, k>::index(const Combination<n, k, T>& combi)
 {
-  if (index > size())
-    abort();
-  if constexpr (sz == 1)
-    return std::array<unsigned int, k>{ args..., index };
-  else
-  {
-    unsigned int cs = sz - 1;
-    unsigned int bn = 0;
-    for (; cs <= n; ++cs)
-    {
-      unsigned int bi = binomial(cs, sz);
-      if (bi > index)
-        break;
-      bn = bi;
-    }
-    --cs;
-    return compute_value<sz - 1>(index - bn, args..., cs);
-  }
+  TPCC_INSTRUMENT_SCOPE(combinations_index, n, k);
+  unsigned int result = 0;
+  if constexpr (k > 0)
+    for (unsigned int i = 0; i < k; ++i)
+      result += binomials[combi.in(i)][k - i];
+  return result;
 }
 
 template <int n, int k>
-template <typename T>
-inline constexpr unsigned int Combinations<n, k>::index(const Combination<n, k, T>& combi)
+inline TPCC_INSTRUMENTED_CONSTEXPR unsigned int
+Combinations<n, k>::index(const BitCombination<n, k>& combi)
 {
+  TPCC_INSTRUMENT_SCOPE(combinations_index, n, k);
+  // The `j`th member counted from the least significant bit contributes binomial(position, j)
   unsigned int result = 0;
-  if constexpr (k > 0)
-    for (unsigned int i = 0; i < k; ++i)
-      result += binomial(combi.in(i), k - i);
+  std::uint32_t mask = combi.bits();
+  for (unsigned int j = 1; mask != 0; ++j, mask &= mask - 1)
+    result += binomials[__builtin_ctz(mask)][j];
   return result;
 }
 
@@ -283,13 +452,22 @@ inline constexpr unsigned int Combinations<n, k>::index(const Combination<n, k,
 template <int n, int k>
 std::array<unsigned int, k> Combinations<n, k>::value(unsigned int index)
 {
-  if constexpr (k == 0)
+  TPCC_INSTRUMENT_SCOPE(combinations_value, n, k);
+  if (index >= size())
+    abort();
+  // The members in descending order are the largest values `c` with binomial(c, k-i) not
+  // exceeding the remaining index. Since they decrease, `c` is scanned only once.
+  std::array<unsigned int, k> result{};
+  unsigned int c = n;
+  for (unsigned int i = 0; i < k; ++i)
   {
-    ++index; // Avoid warning about unused variable
-    return std::array<unsigned int, 0>();
+    do
+      --c;
+    while (binomials[c][k - i] > index);
+    result[i] = c;
+    index -= binomials[c][k - i];
   }
-  else
-    return compute_value<k>(index);
+  return result;
 }
 
 template <int n, int k>
@@ -306,6 +484,235 @@ constexpr Combination<n, k> Combinations<n, k>::operator[](unsigned int index)
 {
   return Combination<n, k>(value(index), dual(index));
 }
+
+//----------------------------------------------------------------------//
+
+/**
+ * \brief The orders in which a CombinationIterator visits combinations
+ */
+enum class CombinationOrder
+{
+  /// The order of Combinations, such that rank() and index() coincide
+  lexicographic,
+  /// The revolving door order, where each step exchanges a single member
+  revolving_door
+};
+
+/**
+ * \brief Visit all combinations `k` out of `n` by updating the previous one.
+ *
+ * Combinations::operator[]() computes a combination from its index from scratch. Loops visiting
+ * all combinations in sequence can instead step from one combination to the next, which takes
+ * amortized constant time, independent of `n` and `k`.
+ *
+ * In CombinationOrder::lexicographic, combinations are visited in the order of Combinations, and
+ * rank() equals index(). In CombinationOrder::revolving_door, the Gray code order of Algorithm R
+ * in Knuth, TAOCP 7.2.1.3, is used, where each step removes the member removed() and adds the
+ * member added(). In both orders, the first combination is the one with index zero, and index()
+ * is updated incrementally using a table of binomial coefficients.
+ *
+ * Members are stored in ascending order internally, but accessed by in() in descending order as
+ * in Combination. Conversion into a Combination by combination() takes `O(n)` operations.
+ *
+ * A typical loop reads
+ * \code
+ * for (CombinationIterator<n, k> it(CombinationOrder::revolving_door); !it.at_end(); ++it)
+ *   use(it.combination());
+ * \endcode
+ */
+template <int n, int k>
+class CombinationIterator
+{
+public:
+  /// Constructor positioned at the combination with index zero
+  constexpr CombinationIterator(CombinationOrder order = CombinationOrder::lexicographic);
+
+  /// True if the iterator has been advanced beyond the last combination
+  constexpr bool at_end() const { return finished; }
+
+  /// Advance to the next combination
+  constexpr CombinationIterator& operator++();
+
+  /**
+   * \brief The `i`th element which is part of the combination in descending order.
+   */
+  constexpr unsigned int in(unsigned int i) const { return members[k - 1 - i]; }
+
+  /// The index of the current combination in Combinations
+  constexpr unsigned int index() const { return current_index; }
+
+  /// The number of steps taken from the first combination
+  constexpr unsigned int rank() const { return current_rank; }
+
+  /**
+   * \brief The element added to the combination by the last step.
+   *
+   * Only meaningful in revolving door order after at least one step.
+   */
+  constexpr unsigned int added() const { return last_added; }
+
+  /**
+   * \brief The element removed from the combination by the last step.
+   *
+   * Only meaningful in revolving door order after at least one step.
+   */
+  constexpr unsigned int removed() const { return last_removed; }
+
+  /// The current combination
+  template <typename T = unsigned int>
+  constexpr Combination<n, k, T> combination() const;
+
+private:
+  /// Change the member at position `j` in ascending order to `value`
+  constexpr void set(unsigned int j, unsigned int value);
+
+  /// Step in lexicographic order
+  constexpr void next_lexicographic();
+
+  /// Step in revolving door order, Algorithm R
+  constexpr void next_revolving_door();
+
+  static constexpr std::array<std::array<unsigned int, k + 1>, n + 1> binomials =
+    binomial_table<n, k>();
+
+  CombinationOrder order;
+  /// The members in ascending order, followed by the sentinel `n`
+  std::array<unsigned int, k + 1> members;
+  unsigned int current_index;
+  unsigned int current_rank;
+  unsigned int last_added;
+  unsigned int last_removed;
+  bool finished;
+};
+
+//----------------------------------------------------------------------//
+
+template <int n, int k>
+constexpr CombinationIterator<n, k>::CombinationIterator(CombinationOrder order)
+  : order(order)
+  , members{}
+  , current_index(0)
+  , current_rank(0)
+  , last_added(0)
+  , last_removed(0)
+  , finished(false)
+{
+  for (unsigned int j = 0; j < k; ++j)
+    members[j] = j;
+  members[k] = n;
+}
+
+template <int n, int k>
+constexpr void CombinationIterator<n, k>::set(unsigned int j, unsigned int value)
+{
+  current_index += binomials[value][j + 1];
+  current_index -= binomials[members[j]][j + 1];
+  members[j] = value;
+}
+
+template <int n, int k>
+constexpr CombinationIterator<n, k>& CombinationIterator<n, k>::operator++()
+{
+  ++current_rank;
+  // Knuth's algorithm R requires 1 < k < n, all other cases are covered by lexicographic order
+  if constexpr (k > 1 && k < n)
+    if (order == CombinationOrder::revolving_door)
+    {
+      next_revolving_door();
+      return *this;
+    }
+  next_lexicographic();
+  return *this;
+}
+
+template <int n, int k>
+constexpr void CombinationIterator<n, k>::next_lexicographic()
+{
+  // Find the lowest member which can be increased and reset all members below it
+  unsigned int j = 0;
+  while (j < k && members[j] + 1 == members[j + 1])
+    ++j;
+  if (j == k)
+  {
+    finished = true;
+    return;
+  }
+  last_removed = members[j];
+  last_added = members[j] + 1;
+  ++members[j];
+  for (unsigned int i = 0; i < j; ++i)
+    members[i] = i;
+  ++current_index;
+}
+
+template <int n, int k>
+constexpr void CombinationIterator<n, k>::next_revolving_door()
+{
+  // The steps R3 to R5 of Knuth's algorithm, with his c_j stored in members[j-1]
+  if constexpr (k % 2 == 1)
+  {
+    if (members[0] + 1 < members[1])
+    {
+      last_removed = members[0];
+      last_added = members[0] + 1;
+      set(0, members[0] + 1);
+      return;
+    }
+  }
+  else if (members[0] > 0)
+  {
+    last_removed = members[0];
+    last_added = members[0] - 1;
+    set(0, members[0] - 1);
+    return;
+  }
+
+  // Alternate between R4 and R5, starting with R4 for odd k
+  bool decrease = (k % 2 == 1);
+  for (unsigned int j = 2; j <= k; ++j, decrease = !decrease)
+    if (decrease)
+    {
+      // R4: try to decrease c_j, where c_j = c_{j-1}+1
+      if (members[j - 1] >= j)
+      {
+        last_removed = members[j - 1];
+        last_added = j - 2;
+        set(j - 1, members[j - 2]);
+        set(j - 2, j - 2);
+        return;
+      }
+    }
+    else
+    {
+      // R5: try to increase c_j, where c_{j-1} = j-2
+      if (members[j - 1] + 1 < members[j])
+      {
+        last_removed = j - 2;
+        last_added = members[j - 1] + 1;
+        set(j - 2, members[j - 1]);
+        set(j - 1, members[j - 1] + 1);
+        return;
+      }
+    }
+  finished = true;
+}
+
+template <int n, int k>
+template <typename T>
+constexpr Combination<n, k, T> CombinationIterator<n, k>::combination() const
+{
+  std::array<T, k> in_values{};
+  std::array<T, n - k> out_values{};
+  unsigned int j = k, o = 0;
+  for (unsigned int v = n; v-- > 0;)
+  {
+    if (j > 0 && members[j - 1] == v)
+      in_values[k - (j--)] = v;
+    else
+      out_values[o++] = v;
+  }
+  return Combination<n, k, T>(in_values, out_values);
+}
 } // namespace TPCC
 
 #endif
@@ -0,0 +1,284 @@
+#ifndef TPCC_DUAL_H
+#define TPCC_DUAL_H
+
+#include <algorithm>
+#include <limits>
+
+#include <tpcc/lexicographic.h>
+
+namespace TPCC
+{
+/**
+ * \brief The dual grid of the complex `primal`, with the `n-k`-cells dual to its `k`-cells.
+ *
+ * The nodes of the dual grid are the centers of the primal cells plus the ends of each
+ * non-periodic fiber, such that its cells are centered at the primal nodes. Thus, the fiber
+ * dimension is increased by one in non-periodic directions and unchanged in periodic ones.
+ * Periodicity, direction order and reversed directions are those of `primal`.
+ */
+template <int n, int k, typename Bint, typename Sint, typename Tint>
+Lexicographic<n, n - k, Bint, Sint, Tint> dual_complex(
+  const Lexicographic<n, k, Bint, Sint, Tint>& primal)
+{
+  std::array<Sint, n> dimensions;
+  std::array<bool, n> periodic;
+  for (Tint d = 0; d < n; ++d)
+  {
+    periodic[d] = primal.is_periodic(d);
+    dimensions[d] = primal.fiber_dimension(d) + (periodic[d] ? 0 : 1);
+  }
+  return Lexicographic<n, n - k, Bint, Sint, Tint>(dimensions, periodic,
+                                                   primal.direction_order(),
+                                                   primal.reversed_directions());
+}
+
+/**
+ * \brief The map from the `k`-cells of a Lexicographic complex to their dual `n-k`-cells in
+ * dual_complex().
+ *
+ * The dual of a `k`-cell has the orientation Combination::complement(). Across the directions
+ * in which the primal cell extends, its coordinate is the primal one plus one, since the dual
+ * node there is the center of the primal fiber cell. Along the directions across the primal
+ * cell, it has the primal coordinate, since the dual fiber cell is centered at the primal node.
+ * In periodic directions, the coordinate `fiber_dimension(d)` is identified with zero.
+ *
+ * Each primal orientation block maps to one dual block, and there the dual index is an affine
+ * function of the primal coordinates. Thus, the map is computed for runs along the fastest
+ * direction of each primal block, which are strided runs in the dual numbering, as in
+ * Slab::for_each_run(). Only a periodic direction along the primal cells splits such a run,
+ * because the last cell wraps around to the dual node zero.
+ *
+ * The map is injective, but the dual cells on the boundary of the dual grid in non-periodic
+ * directions have no primal counterpart. A diagonal Hodge star maps primal `k`-cochains to dual
+ * `n-k`-cochains entry by entry, such that it is applied as a permuted diagonal by vmult(), and
+ * its inverse by Tvmult() with the reciprocal diagonal.
+ */
+template <int n, int k, typename Bint = unsigned int, typename Sint = unsigned short,
+          typename Tint = unsigned char>
+class DualMap
+{
+public:
+  typedef Lexicographic<n, k, Bint, Sint, Tint> primal_type;
+  typedef Lexicographic<n, n - k, Bint, Sint, Tint> dual_type;
+  typedef typename BlockLayout<n, Bint, Sint, Tint>::difference_t difference_t;
+
+  /// The primal index of dual cells without primal counterpart
+  static constexpr Bint invalid = std::numeric_limits<Bint>::max();
+
+  /// Constructor for the `k`-cells of `primal`
+  DualMap(const primal_type& primal);
+
+  /// The primal complex
+  const primal_type& primal() const { return primal_complex; }
+
+  /// The dual complex, see dual_complex()
+  const dual_type& dual() const { return dual_cells; }
+
+  /// The dual of the element `e`, with coordinate `fiber_dimension(d)` in periodic directions
+  Element<n, n - k, Sint, Tint> dual_element(const Element<n, k, Sint, Tint>& e) const
+  {
+    std::array<Sint, n> coordinates;
+    for (Tint d = 0; d < n; ++d)
+      coordinates[d] = e[d];
+    for (Tint i = 0; i < k; ++i)
+      ++coordinates[e.along_direction(i)];
+    return Element<n, n - k, Sint, Tint>(e.combination().complement(), coordinates);
+  }
+
+  /// The index of the dual of the primal cell `index`
+  Bint dual_index(Bint index) const;
+
+  /// The index of the primal cell dual to the dual cell `index`, or #invalid
+  Bint primal_index(Bint index) const;
+
+  /// Write the dual indices of the primal cells `first` to `last-1` to `indices`
+  void dual_indices(Bint first, Bint last, Bint* indices) const;
+
+  /**
+   * \brief Call `f(primal, dual, count, stride)` for runs of consecutive primal cells.
+   *
+   * The primal cells `primal` to `primal+count-1` have the duals `dual`, `dual+stride`, and so
+   * on.
+   */
+  template <class F>
+  void for_each_run(F f) const;
+
+  /**
+   * \brief Apply the diagonal Hodge star, `dual_values[dual_index(i)] =
+   * diagonal[i]*primal_values[i]`.
+   *
+   * Dual cells without primal counterpart are not touched.
+   */
+  template <typename Number>
+  void vmult(Number* dual_values, const Number* primal_values, const Number* diagonal) const
+  {
+    for_each_run([&](Bint primal, Bint dual, Bint count, difference_t stride) {
+      for (Bint i = 0; i < count; ++i, dual += stride)
+        dual_values[dual] = diagonal[primal + i] * primal_values[primal + i];
+    });
+  }
+
+  /// Apply the transpose, `primal_values[i] = diagonal[i]*dual_values[dual_index(i)]`
+  template <typename Number>
+  void Tvmult(Number* primal_values, const Number* dual_values, const Number* diagonal) const
+  {
+    for_each_run([&](Bint primal, Bint dual, Bint count, difference_t stride) {
+      for (Bint i = 0; i < count; ++i, dual += stride)
+        primal_values[primal + i] = diagonal[primal + i] * dual_values[dual];
+    });
+  }
+
+private:
+  /// The dual coordinate in direction `d` for the primal coordinate `x`
+  Sint dual_coordinate(Tint d, bool along, Sint x) const
+  {
+    if (!along)
+      return x;
+    return (primal_complex.is_periodic(d) && x + 1 == primal_complex.fiber_dimension(d)) ? 0
+                                                                                       : x + 1;
+  }
+
+  primal_type primal_complex;
+  dual_type dual_cells;
+  std::array<BlockLayout<n, Bint, Sint, Tint>, binomial(n, k)> primal_layouts;
+  /// The layouts of the dual blocks in the order of the primal blocks
+  std::array<BlockLayout<n, Bint, Sint, Tint>, binomial(n, k)> dual_layouts;
+  /// The directions along the cells of each primal block
+  std::array<std::array<bool, n>, binomial(n, k)> along;
+  /// The offsets of the dual blocks in their own order, and the primal block of each
+  std::array<Bint, binomial(n, k)> dual_offsets;
+  std::array<Tint, binomial(n, k)> primal_blocks;
+};
+
+//----------------------------------------------------------------------//
+
+template <int n, int k, typename Bint, typename Sint, typename Tint>
+DualMap<n, k, Bint, Sint, Tint>::DualMap(const primal_type& primal)
+  : primal_complex(primal)
+  , dual_cells(dual_complex(primal))
+{
+  require_unreversed(primal, "DualMap");
+  Combinations<n, k> combinations;
+  for (Tint b = 0; b < primal.n_blocks(); ++b)
+  {
+    const auto combination = combinations[b];
+    along[b] = {};
+    for (Tint i = 0; i < k; ++i)
+      along[b][n - 1 - combination.in(i)] = true;
+    const Tint dual_block = Combinations<n, n - k>::index(combination.complement());
+    primal_layouts[b] = primal.block_layout(b);
+    dual_layouts[b] = dual_cells.block_layout(dual_block);
+    dual_offsets[dual_block] = dual_layouts[b].offset;
+    primal_blocks[dual_block] = b;
+  }
+}
+
+template <int n, int k, typename Bint, typename Sint, typename Tint>
+Bint DualMap<n, k, Bint, Sint, Tint>::dual_index(Bint index) const
+{
+  const Tint b = std::upper_bound(primal_layouts.begin(), primal_layouts.end(), index,
+                                  [](Bint i, const BlockLayout<n, Bint, Sint, Tint>& layout) {
+                                    return i < layout.offset;
+                                  }) -
+                 primal_layouts.begin() - 1;
+  const auto& layout = primal_layouts[b];
+  index -= layout.offset;
+  Bint result = dual_layouts[b].offset;
+  for (Tint i = 0; i < n; ++i)
+  {
+    const Tint d = layout.order[i];
+    result += dual_coordinate(d, along[b][d], index % layout.extents[d]) *
+              dual_layouts[b].strides[d];
+    index /= layout.extents[d];
+  }
+  return result;
+}
+
+template <int n, int k, typename Bint, typename Sint, typename Tint>
+Bint DualMap<n, k, Bint, Sint, Tint>::primal_index(Bint index) const
+{
+  const Tint b = primal_blocks[std::upper_bound(dual_offsets.begin(), dual_offsets.end(), index) -
+                               dual_offsets.begin() - 1];
+  const auto& layout = dual_layouts[b];
+  index -= layout.offset;
+  Bint result = primal_layouts[b].offset;
+  for (Tint i = 0; i < n; ++i)
+  {
+    const Tint d = layout.order[i];
+    Sint x = index % layout.extents[d];
+    index /= layout.extents[d];
+    if (along[b][d])
+    {
+      // The dual nodes at the ends of non-periodic fibers are not centers of primal cells
+      if (!primal_complex.is_periodic(d))
+      {
+        if (x == 0 || x == layout.extents[d] - 1)
+          return invalid;
+        --x;
+      }
+      else
+        x = (x == 0) ? layout.extents[d] - 1 : x - 1;
+    }
+    result += x * primal_layouts[b].strides[d];
+  }
+  return result;
+}
+
+template <int n, int k, typename Bint, typename Sint, typename Tint>
+void DualMap<n, k, Bint, Sint, Tint>::dual_indices(Bint first, Bint last, Bint* indices) const
+{
+  for_each_run([&](Bint primal, Bint dual, Bint count, difference_t stride) {
+    const Bint begin = std::max(primal, first);
+    const Bint end = std::min(primal + count, last);
+    dual += (begin - primal) * stride;
+    for (Bint i = begin; i < end; ++i, dual += stride)
+      indices[i - first] = dual;
+  });
+}
+
+template <int n, int k, typename Bint, typename Sint, typename Tint>
+template <class F>
+void DualMap<n, k, Bint, Sint, Tint>::for_each_run(F f) const
+{
+  for (Tint b = 0; b < primal_complex.n_blocks(); ++b)
+  {
+    const auto& layout = primal_layouts[b];
+    const auto& dual_layout = dual_layouts[b];
+    const Tint d0 = layout.order[0];
+    const Bint count = layout.extents[d0];
+    const difference_t stride = dual_layout.strides[d0];
+    // Along a periodic direction, the last cell is dual to the node zero
+    const bool wrap = along[b][d0] && primal_complex.is_periodic(d0);
+    const Bint shift = along[b][d0] ? 1 : 0;
+
+    std::array<Sint, n> y{};
+    for (Bint primal = layout.offset; primal < layout.offset + layout.size(); primal += count)
+    {
+      Bint dual = dual_layout.offset + shift * stride;
+      for (Tint i = 1; i < n; ++i)
+      {
+        const Tint d = layout.order[i];
+        dual += dual_coordinate(d, along[b][d], y[d]) * dual_layout.strides[d];
+      }
+      if (!wrap)
+        f(primal, dual, count, stride);
+      else
+      {
+        if (count > 1)
+          f(primal, dual, count - 1, stride);
+        f(primal + count - 1, dual - shift * stride, 1, stride);
+      }
+
+      for (Tint i = 1; i < n; ++i)
+      {
+        const Tint d = layout.order[i];
+        if (++y[d] < layout.extents[d])
+          break;
+        y[d] = 0;
+      }
+    }
+  }
+}
+} // namespace TPCC
+
+#endif
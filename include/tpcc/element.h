@@ -43,15 +43,18 @@ class Element
    * Since combinations are generated in descending order, coordinates usually are referenced in
    * ascending order, the directions are actually not the value in the combination or its
    * complement. The index `i` returned by the combination is immediately replaced by `n-1-i`.
+   *
+   * The directions are stored with the integer type `Tint`, such that the whole element occupies
+   * `n` times the size of `Sint` and `Tint` plus padding.
    */
-  Combination<n, k> orientation;
+  Combination<n, k, Tint> orientation;
   /// The integer coordinates within the `n`-dimensional complex
   std::array<Sint, n> positions;
 
 public:
   /// Constructor with both data elements
-  template <typename T>
-  Element(const Combination<n, k>& combi, const std::array<T, n>& pos)
+  template <typename C, typename T>
+  Element(const Combination<n, k, C>& combi, const std::array<T, n>& pos)
     : orientation(combi)
     , positions(pos)
   {
@@ -63,6 +66,9 @@ public:
   /// The index of the combination enumerating directions
   constexpr Tint direction_index() const { return Combinations<n, k>::index(orientation); }
 
+  /// The combination enumerating directions, see #orientation
+  constexpr const Combination<n, k, Tint>& combination() const { return orientation; }
+
   /**
    * \brief The coordinates in the `n`-dimensional chain complex
    *
@@ -130,12 +136,13 @@ public:
    * which was eliminated, the coordinate is either the same as for
    * the element for the lower boundary, or plus one for the upper.
    */
-  constexpr Element<n, k - 1, Sint, Tint> facet(Tint index) const
+  TPCC_INSTRUMENTED_CONSTEXPR Element<n, k - 1, Sint, Tint> facet(Tint index) const
   {
+    TPCC_INSTRUMENT_SCOPE(element_facet, n, k);
     Tint i2 = index / 2;           // The direction index out of k
     Tint im = index % 2;           // Lower or upper boundary in this direction?
     Tint gi = along_direction(i2); // The global direction out of n belonging to index
-    Combination<n, k - 1> combi = orientation.eliminate(i2);
+    Combination<n, k - 1, Tint> combi = orientation.eliminate(i2);
     std::array<Sint, n> new_positions = positions;
     if (im == 1)
       ++new_positions[gi];
@@ -146,6 +153,12 @@ public:
   template <int, int, typename, typename, typename>
   friend class Slab;
 };
+
+// Elements are stored in large arrays, for instance in work lists. Make sure that with the default
+// integer types they do not exceed 16 bytes for the dimensions used most.
+static_assert(sizeof(Element<2, 1>) <= 8, "Element<2,1> should fit into 8 bytes");
+static_assert(sizeof(Element<3, 1>) <= 16, "Element<3,1> should fit into 16 bytes");
+static_assert(sizeof(Element<4, 2>) <= 16, "Element<4,2> should fit into 16 bytes");
 } // namespace TPCC
 
 #endif
@@ -0,0 +1,235 @@
+#ifndef TPCC_ELEMENT_BLOCK_H
+#define TPCC_ELEMENT_BLOCK_H
+
+#include <algorithm>
+#include <tpcc/lexicographic.h>
+#include <vector>
+
+namespace TPCC
+{
+/**
+ * \brief A set of elements of a Lexicographic complex stored as structure of arrays.
+ *
+ * Instead of a `std::vector<Element>`, this container stores one column for each of the `n`
+ * coordinates and one column holding the index of the orientation, as obtained by
+ * Element::direction_index(). Thus, a loop which only needs a single coordinate of all elements
+ * only streams through this column.
+ *
+ * Elements are appended either one by one through push_back() or in bulk from an index range or
+ * an index list of a Lexicographic complex. The global indices of all stored elements are
+ * obtained by index() in a single pass without constructing Element objects.
+ *
+ * \tparam n: The dimension of the tensor product
+ * \tparam k: The dimension of the elements
+ * \tparam Bint: The big integer used for addressing in the whole tensor product
+ * \tparam Sint: The small integer used for addressing in each fiber
+ * \tparam Tint: The tiny integer with values addressing the fibers
+ */
+template <int n, int k, typename Bint = unsigned int, typename Sint = unsigned short,
+          typename Tint = unsigned char>
+class ElementBlock
+{
+  /// The coordinates of the elements, one column per direction
+  std::array<std::vector<Sint>, n> coordinates;
+  /// The index of the orientation of each element
+  std::vector<Tint> orientations;
+
+public:
+  /// The type of elements stored
+  typedef Element<n, k, Sint, Tint> value_type;
+  /// The complex the elements are taken from
+  typedef Lexicographic<n, k, Bint, Sint, Tint> complex_type;
+
+  /// The number of elements stored
+  std::size_t size() const { return orientations.size(); }
+
+  /// Remove all elements
+  void clear();
+
+  /// Reserve memory for `s` elements in all columns
+  void reserve(std::size_t s);
+
+  /// Append a single element
+  void push_back(const value_type& e);
+
+  /// Reconstruct the element at position `i`
+  value_type operator[](std::size_t i) const;
+
+  /// The column of coordinates in direction `d`
+  const std::vector<Sint>& coordinate(Tint d) const { return coordinates[d]; }
+
+  /// The column of orientation indices
+  const std::vector<Tint>& orientation() const { return orientations; }
+
+  /**
+   * \brief Append the elements with indices `first` to `last-1` of `mesh`.
+   *
+   * Each orientation block is decoded only once at its beginning, afterwards the coordinates
+   * are incremented like an odometer.
+   */
+  void fill(const complex_type& mesh, Bint first, Bint last);
+
+  /// Append the elements of `mesh` with the given indices
+  void fill(const complex_type& mesh, const std::vector<Bint>& indices);
+
+  /**
+   * \brief Compute the indices of all stored elements in `mesh`.
+   *
+   * The strides of each orientation block are computed once, such that the index of each
+   * element is a scalar product of its coordinates with the strides of its block.
+   */
+  std::vector<Bint> index(const complex_type& mesh) const;
+
+  /**
+   * \brief Replace each entry `c` of the coordinate column `d` by `f(c)`.
+   *
+   * The loop runs over a contiguous array without dependencies, such that it can be vectorized
+   * by the compiler if `f` is inlined.
+   */
+  template <typename F>
+  void transform(Tint d, F f);
+};
+
+//----------------------------------------------------------------------//
+
+template <int n, int k, typename Bint, typename Sint, typename Tint>
+void ElementBlock<n, k, Bint, Sint, Tint>::clear()
+{
+  for (Tint d = 0; d < n; ++d)
+    coordinates[d].clear();
+  orientations.clear();
+}
+
+template <int n, int k, typename Bint, typename Sint, typename Tint>
+void ElementBlock<n, k, Bint, Sint, Tint>::reserve(std::size_t s)
+{
+  for (Tint d = 0; d < n; ++d)
+    coordinates[d].reserve(s);
+  orientations.reserve(s);
+}
+
+template <int n, int k, typename Bint, typename Sint, typename Tint>
+void ElementBlock<n, k, Bint, Sint, Tint>::push_back(const value_type& e)
+{
+  for (Tint d = 0; d < n; ++d)
+    coordinates[d].push_back(e[d]);
+  orientations.push_back(e.direction_index());
+}
+
+template <int n, int k, typename Bint, typename Sint, typename Tint>
+Element<n, k, Sint, Tint> ElementBlock<n, k, Bint, Sint, Tint>::operator[](std::size_t i) const
+{
+  Combinations<n, k> combinations;
+  std::array<Sint, n> positions;
+  for (Tint d = 0; d < n; ++d)
+    positions[d] = coordinates[d][i];
+  return value_type{ combinations[orientations[i]], positions };
+}
+
+template <int n, int k, typename Bint, typename Sint, typename Tint>
+void ElementBlock<n, k, Bint, Sint, Tint>::fill(const complex_type& mesh, Bint first, Bint last)
+{
+  assert(last <= mesh.size());
+  if (first >= last)
+    return;
+  reserve(size() + (last - first));
+
+  // Find the block containing `first`
+  Tint block = 0;
+  Bint local = first;
+  while (local >= mesh.block_size(block))
+  {
+    local -= mesh.block_size(block);
+    ++block;
+  }
+
+  for (Bint remaining = last - first; remaining > 0; ++block, local = 0)
+  {
+    const auto layout = mesh.block_layout(block);
+    const std::array<Tint, n>& dirs = layout.order;
+    std::array<Sint, n> extents;
+    for (Tint i = 0; i < n; ++i)
+      extents[i] = layout.extents[dirs[i]];
+    const std::array<bool, n>& reverse = layout.reverse;
+
+    const Bint count = std::min<Bint>(remaining, mesh.block_size(block) - local);
+
+    // Decode the first element of this block, fastest direction first
+    std::array<Sint, n> position;
+    for (Tint i = 0; i < n; ++i)
+    {
+      position[i] = local % extents[i];
+      local /= extents[i];
+    }
+
+    for (Bint j = 0; j < count; ++j)
+    {
+      for (Tint i = 0; i < n; ++i)
+        coordinates[dirs[i]].push_back(reverse[dirs[i]] ? extents[i] - 1 - position[i]
+                                                        : position[i]);
+      orientations.push_back(block);
+      for (Tint i = 0; i < n; ++i)
+      {
+        if (++position[i] < extents[i])
+          break;
+        position[i] = 0;
+      }
+    }
+    remaining -= count;
+  }
+}
+
+template <int n, int k, typename Bint, typename Sint, typename Tint>
+void ElementBlock<n, k, Bint, Sint, Tint>::fill(const complex_type& mesh,
+                                                const std::vector<Bint>& indices)
+{
+  reserve(size() + indices.size());
+  for (Bint i : indices)
+    push_back(mesh[i]);
+}
+
+template <int n, int k, typename Bint, typename Sint, typename Tint>
+std::vector<Bint> ElementBlock<n, k, Bint, Sint, Tint>::index(const complex_type& mesh) const
+{
+  // Offset and strides of each orientation block, the latter in global directions. In reversed
+  // directions, the position `e-1-x` contributes `(e-1)*stride` to the offset and `-stride`
+  // per coordinate, which wraps around in the unsigned type `Bint`.
+  std::array<Bint, binomial(n, k)> offsets;
+  std::array<std::array<Bint, n>, binomial(n, k)> strides;
+  for (Tint b = 0; b < binomial(n, k); ++b)
+  {
+    const auto layout = mesh.block_layout(b);
+    offsets[b] = layout.offset;
+    strides[b] = layout.strides;
+    for (Tint d = 0; d < n; ++d)
+      if (layout.reverse[d])
+      {
+        offsets[b] += (layout.extents[d] - 1) * layout.strides[d];
+        strides[b][d] = Bint(0) - layout.strides[d];
+      }
+  }
+
+  std::vector<Bint> result(size());
+  for (std::size_t j = 0; j < size(); ++j)
+    result[j] = offsets[orientations[j]];
+  for (Tint d = 0; d < n; ++d)
+  {
+    const Sint* column = coordinates[d].data();
+    for (std::size_t j = 0; j < size(); ++j)
+      result[j] += column[j] * strides[orientations[j]][d];
+  }
+  return result;
+}
+
+template <int n, int k, typename Bint, typename Sint, typename Tint>
+template <typename F>
+void ElementBlock<n, k, Bint, Sint, Tint>::transform(Tint d, F f)
+{
+  Sint* column = coordinates[d].data();
+  const std::size_t s = size();
+  for (std::size_t j = 0; j < s; ++j)
+    column[j] = f(column[j]);
+}
+} // namespace TPCC
+
+#endif
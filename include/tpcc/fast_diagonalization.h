@@ -0,0 +1,535 @@
+#ifndef TPCC_FAST_DIAGONALIZATION_H
+#define TPCC_FAST_DIAGONALIZATION_H
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <tpcc/kronecker.h>
+
+namespace TPCC
+{
+/**
+ * \brief Eigenvalues and orthonormal eigenvectors of a symmetric matrix on a single fiber.
+ */
+template <typename Number = double>
+struct FiberEigensystem
+{
+  /// The eigenvalues in the order of the eigenvectors
+  std::vector<Number> values;
+  /// The matrix `Q` with the eigenvectors as columns
+  FiberMatrix<Number> vectors;
+  /// The transpose of #vectors
+  FiberMatrix<Number> transposed;
+
+  /**
+   * \brief Compute the eigensystem of the symmetric matrix `A`.
+   *
+   * The fiber matrices of differential operators, like the factors of laplacian_operator(), are
+   * tridiagonal except for the corner entries of periodic fibers. Tridiagonal matrices are
+   * diagonalized directly by the implicit QL method with Wilkinson shifts, which needs `O(m^2)`
+   * operations for the eigenvalues and `O(m^3)` with a small constant for accumulating the
+   * eigenvectors. Other matrices are first reduced to tridiagonal form by Householder
+   * transformations. Both follow the EISPACK routines `tred2` and `tql2`.
+   *
+   * Throws `std::runtime_error` if the QL iteration does not converge for an eigenvalue within
+   * #max_iterations steps.
+   */
+  explicit FiberEigensystem(const FiberMatrix<Number>& A);
+
+  /// The maximal number of QL steps for a single eigenvalue
+  static constexpr unsigned int max_iterations = 60;
+
+private:
+  /// Reduce the symmetric row-major matrix `V` to tridiagonal form, overwriting it with the
+  /// orthogonal transformation
+  static void tridiagonalize(unsigned int m, std::vector<Number>& V, std::vector<Number>& d,
+                             std::vector<Number>& e);
+
+  /// Diagonalize the tridiagonal matrix with diagonal `d` and subdiagonal `e[1..m-1]`,
+  /// applying the rotations to the columns of `V`
+  static void diagonalize(unsigned int m, std::vector<Number>& V, std::vector<Number>& d,
+                          std::vector<Number>& e);
+};
+
+/**
+ * \brief Exact inverse of a separable operator on a Lexicographic complex by fast
+ * diagonalization.
+ *
+ * The operator must be block diagonal with respect to the orientation blocks, and in each
+ * block a sum `c I + sum_d I x ... x A_d x ... x I` of Kronecker products with symmetric
+ * factors `A_d` in single directions, like the laplacian_operator(). With the eigensystems
+ * `A_d = Q_d L_d Q_d^T`, the inverse of the block is
+ *
+ *     (Q_{n-1} x ... x Q_0) (c + sum_d L_d)^{-1} (Q_{n-1}^T x ... x Q_0^T),
+ *
+ * two sequences of `n` mode products and a diagonal scaling. The eigensystems are computed once
+ * in the constructor and shared by all blocks and directions with the same factors.
+ *
+ * Eigenvalue sums which vanish up to round-off, like the constants in the kernel of the
+ * Laplacian on vertices, are not inverted but mapped to zero. Thus, for a singular operator,
+ * vmult() applies the pseudo-inverse.
+ *
+ * The mode products are split between `n_threads` threads, along the slower directions if
+ * there are enough of them and along the faster ones otherwise.
+ */
+template <int n, typename Number = double, typename Bint = unsigned int,
+          typename Sint = unsigned short, typename Tint = unsigned char>
+class FastDiagonalization
+{
+public:
+  typedef KroneckerOperator<n, Number, Bint, Sint, Tint> operator_type;
+  typedef BlockLayout<n, Bint, Sint, Tint> layout_type;
+
+  /**
+   * \brief Constructor computing the eigensystems of the factors of `op + shift I`.
+   *
+   * All terms of `op` must map a block to itself and have at most one factor which is not the
+   * identity. Otherwise, `std::invalid_argument` is thrown.
+   */
+  FastDiagonalization(const operator_type& op, Number shift = 0);
+
+  /// The number of different eigensystems computed
+  unsigned int n_eigensystems() const { return eigensystems.size(); }
+
+  /**
+   * \brief Compute `x = A^{-1} b` for the operator `A` given to the constructor.
+   *
+   * Used as a preconditioner, this is the exact block inverse.
+   */
+  void vmult(Number* x, const Number* b, unsigned int n_threads = 1) const;
+
+private:
+  /// The eigensystems and weights of the directions of an orientation block
+  struct Block
+  {
+    layout_type layout;
+    Number shift;
+    /// The eigensystem for each direction, or -1 for the identity
+    std::array<int, n> systems;
+  };
+
+  /// The mode product of FiberMatrix::mode_product(), split between `n_threads` threads
+  static void mode_product(const FiberMatrix<Number>& A, const Number* in, Number* out,
+                           std::size_t inner, std::size_t outer, unsigned int n_threads);
+
+  std::vector<Block> blocks;
+  std::vector<FiberEigensystem<Number>> eigensystems;
+};
+
+//----------------------------------------------------------------------//
+
+template <typename Number>
+FiberEigensystem<Number>::FiberEigensystem(const FiberMatrix<Number>& A)
+{
+  const unsigned int m = A.rows;
+  std::vector<Number> V(m * m), d(m), e(m);
+  bool tridiagonal = true;
+  for (unsigned int i = 0; i < m && !A.is_identity; ++i)
+    for (unsigned int j = A.row_offsets[i]; j < A.row_offsets[i + 1]; ++j)
+      tridiagonal = tridiagonal && A.columns[j] + 1 >= i && A.columns[j] <= i + 1;
+
+  if (A.is_identity)
+  {
+    std::fill(d.begin(), d.end(), Number(1));
+    for (unsigned int i = 0; i < m; ++i)
+      V[i * m + i] = 1;
+  }
+  else if (tridiagonal)
+  {
+    for (unsigned int i = 0; i < m; ++i)
+    {
+      V[i * m + i] = 1;
+      for (unsigned int j = A.row_offsets[i]; j < A.row_offsets[i + 1]; ++j)
+        if (A.columns[j] == i)
+          d[i] = A.values[j];
+        else if (A.columns[j] + 1 == i)
+          e[i] = A.values[j];
+    }
+  }
+  else
+  {
+    for (unsigned int i = 0; i < m; ++i)
+      for (unsigned int j = A.row_offsets[i]; j < A.row_offsets[i + 1]; ++j)
+        V[i * m + A.columns[j]] = A.values[j];
+    tridiagonalize(m, V, d, e);
+  }
+  diagonalize(m, V, d, e);
+
+  values = d;
+  std::vector<Number> VT(m * m);
+  for (unsigned int i = 0; i < m; ++i)
+    for (unsigned int j = 0; j < m; ++j)
+      VT[j * m + i] = V[i * m + j];
+  vectors = FiberMatrix<Number>::dense(m, m, V);
+  transposed = FiberMatrix<Number>::dense(m, m, VT);
+}
+
+template <typename Number>
+void FiberEigensystem<Number>::tridiagonalize(unsigned int m, std::vector<Number>& V,
+                                              std::vector<Number>& d, std::vector<Number>& e)
+{
+  // Householder reflections from the last row upwards, using the lower triangle
+  for (unsigned int j = 0; j < m; ++j)
+    d[j] = V[(m - 1) * m + j];
+  for (unsigned int i = m - 1; i > 0; --i)
+  {
+    Number scale = 0, h = 0;
+    for (unsigned int k = 0; k < i; ++k)
+      scale += std::abs(d[k]);
+    if (scale == Number(0))
+    {
+      e[i] = d[i - 1];
+      for (unsigned int j = 0; j < i; ++j)
+      {
+        d[j] = V[(i - 1) * m + j];
+        V[i * m + j] = 0;
+        V[j * m + i] = 0;
+      }
+    }
+    else
+    {
+      for (unsigned int k = 0; k < i; ++k)
+      {
+        d[k] /= scale;
+        h += d[k] * d[k];
+      }
+      Number f = d[i - 1];
+      Number g = (f > 0) ? -std::sqrt(h) : std::sqrt(h);
+      e[i] = scale * g;
+      h -= f * g;
+      d[i - 1] = f - g;
+      for (unsigned int j = 0; j < i; ++j)
+        e[j] = 0;
+      for (unsigned int j = 0; j < i; ++j)
+      {
+        f = d[j];
+        V[j * m + i] = f;
+        g = e[j] + V[j * m + j] * f;
+        for (unsigned int k = j + 1; k < i; ++k)
+        {
+          g += V[k * m + j] * d[k];
+          e[k] += V[k * m + j] * f;
+        }
+        e[j] = g;
+      }
+      f = 0;
+      for (unsigned int j = 0; j < i; ++j)
+      {
+        e[j] /= h;
+        f += e[j] * d[j];
+      }
+      const Number hh = f / (h + h);
+      for (unsigned int j = 0; j < i; ++j)
+        e[j] -= hh * d[j];
+      for (unsigned int j = 0; j < i; ++j)
+      {
+        f = d[j];
+        g = e[j];
+        for (unsigned int k = j; k < i; ++k)
+          V[k * m + j] -= f * e[k] + g * d[k];
+        d[j] = V[(i - 1) * m + j];
+        V[i * m + j] = 0;
+      }
+    }
+    d[i] = h;
+  }
+
+  // Accumulate the transformations
+  for (unsigned int i = 0; i + 1 < m; ++i)
+  {
+    V[(m - 1) * m + i] = V[i * m + i];
+    V[i * m + i] = 1;
+    const Number h = d[i + 1];
+    if (h != Number(0))
+    {
+      for (unsigned int k = 0; k <= i; ++k)
+        d[k] = V[k * m + i + 1] / h;
+      for (unsigned int j = 0; j <= i; ++j)
+      {
+        Number g = 0;
+        for (unsigned int k = 0; k <= i; ++k)
+          g += V[k * m + i + 1] * V[k * m + j];
+        for (unsigned int k = 0; k <= i; ++k)
+          V[k * m + j] -= g * d[k];
+      }
+    }
+    for (unsigned int k = 0; k <= i; ++k)
+      V[k * m + i + 1] = 0;
+  }
+  for (unsigned int j = 0; j < m; ++j)
+  {
+    d[j] = V[(m - 1) * m + j];
+    V[(m - 1) * m + j] = 0;
+  }
+  V[(m - 1) * m + m - 1] = 1;
+  e[0] = 0;
+}
+
+template <typename Number>
+void FiberEigensystem<Number>::diagonalize(unsigned int m, std::vector<Number>& V,
+                                           std::vector<Number>& d, std::vector<Number>& e)
+{
+  for (unsigned int i = 1; i < m; ++i)
+    e[i - 1] = e[i];
+  e[m - 1] = 0;
+
+  Number f = 0, norm = 0;
+  const Number eps = std::numeric_limits<Number>::epsilon();
+  for (unsigned int l = 0; l < m; ++l)
+  {
+    // Find a small subdiagonal entry splitting off the block starting at `l`
+    norm = std::max(norm, std::abs(d[l]) + std::abs(e[l]));
+    unsigned int last = l;
+    while (last + 1 < m && std::abs(e[last]) > eps * norm)
+      ++last;
+
+    for (unsigned int iteration = 0; last > l && std::abs(e[l]) > eps * norm; ++iteration)
+    {
+      if (iteration == max_iterations)
+        throw std::runtime_error("FiberEigensystem: QL iteration did not converge");
+
+      // Implicit shift by the eigenvalue of the leading 2x2 block closer to `d[l]`
+      Number g = d[l];
+      Number p = (d[l + 1] - g) / (2 * e[l]);
+      Number r = std::hypot(p, Number(1));
+      if (p < 0)
+        r = -r;
+      d[l] = e[l] / (p + r);
+      d[l + 1] = e[l] * (p + r);
+      const Number dl1 = d[l + 1];
+      Number h = g - d[l];
+      for (unsigned int i = l + 2; i < m; ++i)
+        d[i] -= h;
+      f += h;
+
+      // Chase the bulge with Givens rotations from the bottom of the block
+      p = d[last];
+      Number c = 1, c2 = 1, c3 = 1, s = 0, s2 = 0;
+      const Number el1 = e[l + 1];
+      for (unsigned int i = last; i-- > l;)
+      {
+        c3 = c2;
+        c2 = c;
+        s2 = s;
+        g = c * e[i];
+        h = c * p;
+        r = std::hypot(p, e[i]);
+        e[i + 1] = s * r;
+        s = e[i] / r;
+        c = p / r;
+        p = c * d[i] - s * g;
+        d[i + 1] = h + s * (c * g + s * d[i]);
+        for (unsigned int k = 0; k < m; ++k)
+        {
+          h = V[k * m + i + 1];
+          V[k * m + i + 1] = s * V[k * m + i] + c * h;
+          V[k * m + i] = c * V[k * m + i] - s * h;
+        }
+      }
+      p = -s * s2 * c3 * el1 * e[l] / dl1;
+      e[l] = s * p;
+      d[l] = c * p;
+    }
+    d[l] += f;
+    e[l] = 0;
+  }
+}
+
+//----------------------------------------------------------------------//
+
+template <int n, typename Number, typename Bint, typename Sint, typename Tint>
+FastDiagonalization<n, Number, Bint, Sint, Tint>::FastDiagonalization(const operator_type& op,
+                                                                     Number shift)
+{
+  // The terms in each block and direction, as pairs of factor and coefficient
+  typedef std::vector<std::pair<unsigned int, Number>> Key;
+  std::vector<std::array<Key, n>> keys(op.n_domain_blocks());
+  std::vector<Number> shifts(op.n_domain_blocks(), shift);
+  for (std::size_t t = 0; t < op.n_terms(); ++t)
+  {
+    const auto& term = op.term(t);
+    if (term.range_block != term.domain_block)
+      throw std::invalid_argument("FastDiagonalization: operator is not block diagonal");
+    int direction = -1;
+    for (Tint d = 0; d < n; ++d)
+      if (!op.factor(term.factors[d]).is_identity)
+      {
+        if (direction >= 0)
+          throw std::invalid_argument(
+            "FastDiagonalization: term with more than one non-identity factor");
+        direction = d;
+      }
+    if (direction < 0)
+      shifts[term.domain_block] += term.coefficient;
+    else
+      keys[term.domain_block][direction].push_back({ term.factors[direction], term.coefficient });
+  }
+
+  std::map<Key, int> cache;
+  for (std::size_t b = 0; b < keys.size(); ++b)
+  {
+    Block block{ op.domain_layout(b), shifts[b], {} };
+    for (Tint d = 0; d < n; ++d)
+    {
+      Key& key = keys[b][d];
+      block.systems[d] = -1;
+      if (key.empty())
+        continue;
+      std::sort(key.begin(), key.end());
+      auto it = cache.find(key);
+      if (it != cache.end())
+      {
+        block.systems[d] = it->second;
+        continue;
+      }
+
+      // Sum up the factors row by row, keeping them sparse
+      const unsigned int m = op.factor(key[0].first).rows;
+      FiberMatrix<Number> A;
+      A.rows = A.cols = m;
+      A.row_offsets.push_back(0);
+      std::vector<Number> row(m);
+      std::vector<unsigned int> pattern;
+      for (unsigned int i = 0; i < m; ++i)
+      {
+        pattern.clear();
+        auto add = [&](unsigned int j, Number value) {
+          if (std::find(pattern.begin(), pattern.end(), j) == pattern.end())
+            pattern.push_back(j);
+          row[j] += value;
+        };
+        for (const auto& entry : key)
+        {
+          const FiberMatrix<Number>& F = op.factor(entry.first);
+          for (unsigned int j = F.row_offsets[i]; j < F.row_offsets[i + 1]; ++j)
+            add(F.columns[j], entry.second * F.values[j]);
+        }
+        std::sort(pattern.begin(), pattern.end());
+        for (const unsigned int j : pattern)
+        {
+          A.columns.push_back(j);
+          A.values.push_back(row[j]);
+          row[j] = 0;
+        }
+        A.row_offsets.push_back(A.columns.size());
+      }
+      block.systems[d] = eigensystems.size();
+      cache[key] = eigensystems.size();
+      eigensystems.emplace_back(A);
+    }
+    blocks.push_back(block);
+  }
+}
+
+template <int n, typename Number, typename Bint, typename Sint, typename Tint>
+void FastDiagonalization<n, Number, Bint, Sint, Tint>::mode_product(
+  const FiberMatrix<Number>& A, const Number* in, Number* out, std::size_t inner,
+  std::size_t outer, unsigned int n_threads)
+{
+  // If neither index range can be split between the threads, as for the first direction of a
+  // single long fiber, the product is computed serially
+  const std::size_t work = A.rows * inner * outer;
+  if (n_threads <= 1 || work < 4096 || (outer < n_threads && inner < n_threads))
+  {
+    A.mode_product(in, out, inner, outer);
+    return;
+  }
+  std::vector<std::thread> threads;
+  for (unsigned int t = 0; t < n_threads; ++t)
+  {
+    if (outer >= n_threads)
+    {
+      const std::size_t first = outer * t / n_threads, last = outer * (t + 1) / n_threads;
+      threads.emplace_back([=, &A]() {
+        A.mode_product(in + first * A.cols * inner, out + first * A.rows * inner, inner,
+                       last - first);
+      });
+    }
+    else
+    {
+      const std::size_t first = inner * t / n_threads, last = inner * (t + 1) / n_threads;
+      threads.emplace_back([=, &A]() { A.mode_product(in, out, inner, outer, first, last); });
+    }
+  }
+  for (auto& thread : threads)
+    thread.join();
+}
+
+template <int n, typename Number, typename Bint, typename Sint, typename Tint>
+void FastDiagonalization<n, Number, Bint, Sint, Tint>::vmult(Number* x, const Number* b,
+                                                              unsigned int n_threads) const
+{
+  Bint max_size = 0;
+  for (const Block& block : blocks)
+    max_size = std::max(max_size, block.layout.size());
+  std::vector<Number> buffer(max_size);
+
+  for (const Block& block : blocks)
+  {
+    const layout_type& layout = block.layout;
+    const Bint block_size = layout.size();
+
+    // The mode products alternate between the block of `x` and the buffer
+    Number* result = x + layout.offset;
+    Number* other = buffer.data();
+    std::copy(b + layout.offset, b + layout.offset + block_size, result);
+    auto transform = [&](bool transpose) {
+      for (Tint i = 0; i < n; ++i)
+      {
+        const int system = block.systems[layout.order[i]];
+        if (system < 0)
+          continue;
+        std::size_t inner = 1;
+        for (Tint j = 0; j < i; ++j)
+          inner *= layout.extents[layout.order[j]];
+        const auto& Q = transpose ? eigensystems[system].transposed : eigensystems[system].vectors;
+        mode_product(Q, result, other, inner, block_size / inner / Q.rows, n_threads);
+        std::swap(result, other);
+      }
+    };
+
+    // Transform into the eigenbasis
+    transform(true);
+
+    // Divide by the sums of eigenvalues
+    Number largest = std::abs(block.shift);
+    for (Tint d = 0; d < n; ++d)
+      if (block.systems[d] >= 0)
+      {
+        const auto& values = eigensystems[block.systems[d]].values;
+        Number m = 0;
+        for (const Number v : values)
+          m = std::max(m, std::abs(v));
+        largest += m;
+      }
+    std::array<Sint, n> position{};
+    for (Bint i = 0; i < block_size; ++i)
+    {
+      Number sum = block.shift;
+      for (Tint d = 0; d < n; ++d)
+        if (block.systems[d] >= 0)
+          sum += eigensystems[block.systems[d]].values[position[d]];
+      result[i] = (std::abs(sum) > 1.e-12 * largest) ? result[i] / sum : Number(0);
+      for (Tint j = 0; j < n; ++j)
+      {
+        const Tint d = layout.order[j];
+        if (++position[d] < layout.extents[d])
+          break;
+        position[d] = 0;
+      }
+    }
+
+    transform(false);
+    if (result != x + layout.offset)
+      std::copy(result, result + block_size, x + layout.offset);
+  }
+}
+} // namespace TPCC
+
+#endif
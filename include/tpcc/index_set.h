@@ -0,0 +1,443 @@
+#ifndef TPCC_INDEX_SET_H
+#define TPCC_INDEX_SET_H
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+#include <tpcc/slab.h>
+
+namespace TPCC
+{
+/**
+ * \brief A set of indices stored as a sorted sequence of strided runs.
+ *
+ * Subsets of a Lexicographic complex like orientation blocks, sub-boxes and slabs are unions of
+ * arithmetic progressions in its numbering. Thus, they are stored as runs of `count` indices
+ * `first`, `first+stride`, and so on. The runs are sorted and do not interleave, that is, the
+ * last index of a run is smaller than the first index of the next. A run with a single index
+ * has stride one.
+ *
+ * Sets are built by appending indices or runs in ascending order with push_back(), which
+ * extends the last run whenever possible. Union, intersection and difference sweep over the
+ * runs of both sets. Runs which do not overlap are copied as a whole, and overlapping runs with
+ * the same stride and phase are combined in constant time. Only overlapping runs with different
+ * strides are merged index by index.
+ *
+ * The number of indices before each run is stored, such that rank() and select() take
+ * logarithmic time in the number of runs.
+ */
+template <typename Bint = unsigned int>
+class IndexSet
+{
+public:
+  /// A sequence of `count` indices with distance `stride`
+  struct Run
+  {
+    Bint first;
+    Bint count;
+    Bint stride;
+
+    /// The last index in the run
+    constexpr Bint last() const { return first + (count - 1) * stride; }
+
+    /// The `i`th index in the run
+    constexpr Bint operator[](Bint i) const { return first + i * stride; }
+
+    /// The number of indices in the run smaller than `index`
+    constexpr Bint count_below(Bint index) const
+    {
+      if (index <= first)
+        return 0;
+      return std::min(count, (index - first + stride - 1) / stride);
+    }
+  };
+
+  /// Iterator over the indices in ascending order
+  class const_iterator
+  {
+    const IndexSet* set;
+    std::size_t run;
+    Bint position;
+
+  public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef Bint value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const Bint* pointer;
+    typedef Bint reference;
+
+    const_iterator(const IndexSet* set, std::size_t run)
+      : set(set)
+      , run(run)
+      , position(0)
+    {
+    }
+    Bint operator*() const { return set->runs[run][position]; }
+    const_iterator& operator++()
+    {
+      if (++position == set->runs[run].count)
+      {
+        ++run;
+        position = 0;
+      }
+      return *this;
+    }
+    bool operator==(const const_iterator& other) const
+    {
+      return run == other.run && position == other.position;
+    }
+    bool operator!=(const const_iterator& other) const { return !(*this == other); }
+  };
+
+  /// The empty set
+  IndexSet()
+    : offsets(1, 0)
+  {
+  }
+
+  /// The set of indices from `first` to `last-1`
+  static IndexSet interval(Bint first, Bint last)
+  {
+    IndexSet result;
+    result.push_back(first, last - first);
+    return result;
+  }
+
+  /// The number of indices
+  Bint size() const { return offsets.back(); }
+
+  /// Whether the set is empty
+  bool empty() const { return size() == 0; }
+
+  /// The number of runs
+  std::size_t n_runs() const { return runs.size(); }
+
+  /// The run with number `r`
+  const Run& run(std::size_t r) const { return runs[r]; }
+
+  /// The memory used by the set in bytes
+  std::size_t memory_consumption() const
+  {
+    return sizeof(*this) + runs.capacity() * sizeof(Run) + offsets.capacity() * sizeof(Bint);
+  }
+
+  const_iterator begin() const { return const_iterator(this, 0); }
+  const_iterator end() const { return const_iterator(this, runs.size()); }
+
+  /// Append an index larger than all indices in the set
+  void push_back(Bint index);
+
+  /**
+   * \brief Append the run `first`, `first+stride`, ... with `count` indices, all larger than
+   * the indices in the set.
+   */
+  void push_back(Bint first, Bint count, Bint stride = 1);
+
+  /// Whether `index` is in the set
+  bool contains(Bint index) const;
+
+  /// The number of indices in the set smaller than `index`
+  Bint rank(Bint index) const;
+
+  /// The `i`th smallest index in the set
+  Bint select(Bint i) const;
+
+  /// The indices in at least one of the sets
+  IndexSet operator|(const IndexSet& other) const { return combine(*this, other, 0); }
+
+  /// The indices in both sets
+  IndexSet operator&(const IndexSet& other) const { return combine(*this, other, 1); }
+
+  /// The indices in this set but not in the other
+  IndexSet operator-(const IndexSet& other) const { return combine(*this, other, 2); }
+
+  /// Whether the sets contain the same indices, independent of their runs
+  bool operator==(const IndexSet& other) const
+  {
+    return size() == other.size() && std::equal(begin(), end(), other.begin());
+  }
+  bool operator!=(const IndexSet& other) const { return !(*this == other); }
+
+private:
+  /// Union (0), intersection (1) or difference (2) of two sets
+  static IndexSet combine(const IndexSet& a, const IndexSet& b, int operation);
+
+  /// Append a run without checking whether it extends the last one
+  void append(const Run& run)
+  {
+    runs.push_back(run);
+    offsets.push_back(offsets.back() + run.count);
+  }
+
+  /// Split `run` into the indices below `index`, returned, and the others, kept in `run`
+  static Run split(Run& run, Bint index)
+  {
+    const Bint below = run.count_below(index);
+    Run result{ run.first, below, run.stride };
+    run.first += below * run.stride;
+    run.count -= below;
+    return result;
+  }
+
+  std::vector<Run> runs;
+  /// The number of indices before each run, and the total number at the end
+  std::vector<Bint> offsets;
+};
+
+//----------------------------------------------------------------------//
+
+template <typename Bint>
+void IndexSet<Bint>::push_back(Bint index)
+{
+  if (!runs.empty())
+  {
+    Run& last = runs.back();
+    if (last.count == 1)
+      last.stride = index - last.first;
+    if (last.count == 1 || index == last.last() + last.stride)
+    {
+      ++last.count;
+      ++offsets.back();
+      return;
+    }
+  }
+  append(Run{ index, 1, 1 });
+}
+
+template <typename Bint>
+void IndexSet<Bint>::push_back(Bint first, Bint count, Bint stride)
+{
+  if (count == 0)
+    return;
+  if (count == 1)
+  {
+    push_back(first);
+    return;
+  }
+  if (!runs.empty())
+  {
+    Run& last = runs.back();
+    if ((last.count == 1 || last.stride == stride) && first == last.last() + stride)
+    {
+      last.stride = stride;
+      last.count += count;
+      offsets.back() += count;
+      return;
+    }
+  }
+  append(Run{ first, count, stride });
+}
+
+template <typename Bint>
+bool IndexSet<Bint>::contains(Bint index) const
+{
+  auto r = std::partition_point(runs.begin(), runs.end(),
+                                [&](const Run& run) { return run.last() < index; });
+  return r != runs.end() && index >= r->first && (index - r->first) % r->stride == 0;
+}
+
+template <typename Bint>
+Bint IndexSet<Bint>::rank(Bint index) const
+{
+  auto r = std::partition_point(runs.begin(), runs.end(),
+                                [&](const Run& run) { return run.last() < index; });
+  if (r == runs.end())
+    return size();
+  return offsets[r - runs.begin()] + r->count_below(index);
+}
+
+template <typename Bint>
+Bint IndexSet<Bint>::select(Bint i) const
+{
+  const std::size_t r = std::upper_bound(offsets.begin(), offsets.end(), i) - offsets.begin() - 1;
+  return runs[r][i - offsets[r]];
+}
+
+template <typename Bint>
+IndexSet<Bint> IndexSet<Bint>::combine(const IndexSet& a, const IndexSet& b, int operation)
+{
+  const bool keep_a = operation != 1;
+  const bool keep_b = operation == 0;
+  const bool keep_both = operation != 2;
+
+  IndexSet result;
+  std::size_t ai = 0, bi = 0;
+  Run ra{ 0, 0, 1 }, rb{ 0, 0, 1 };
+  for (;;)
+  {
+    if (ra.count == 0 && ai < a.runs.size())
+      ra = a.runs[ai++];
+    if (rb.count == 0 && bi < b.runs.size())
+      rb = b.runs[bi++];
+    if (ra.count == 0 && rb.count == 0)
+      break;
+
+    // Runs whose ranges do not overlap are copied or dropped as a whole
+    if (rb.count == 0 || (ra.count > 0 && ra.last() < rb.first))
+    {
+      if (keep_a)
+        result.push_back(ra.first, ra.count, ra.stride);
+      ra.count = 0;
+      continue;
+    }
+    if (ra.count == 0 || rb.last() < ra.first)
+    {
+      if (keep_b)
+        result.push_back(rb.first, rb.count, rb.stride);
+      rb.count = 0;
+      continue;
+    }
+
+    // The part of the run starting first which is below the other one
+    const Bint lo = std::max(ra.first, rb.first);
+    const Run below_a = split(ra, lo);
+    const Run below_b = split(rb, lo);
+    if (keep_a)
+      result.push_back(below_a.first, below_a.count, below_a.stride);
+    if (keep_b)
+      result.push_back(below_b.first, below_b.count, below_b.stride);
+
+    // The parts in the common range
+    const Bint hi = std::min(ra.last(), rb.last());
+    Run mid_a = split(ra, hi + 1);
+    Run mid_b = split(rb, hi + 1);
+    if (mid_a.first == mid_b.first && mid_a.count == mid_b.count &&
+        (mid_a.count == 1 || mid_a.stride == mid_b.stride))
+    {
+      // Both consist of the same indices
+      if (keep_both)
+        result.push_back(mid_a.first, mid_a.count, mid_a.stride);
+    }
+    else
+    {
+      Bint i = 0, j = 0;
+      while (i < mid_a.count || j < mid_b.count)
+      {
+        if (j == mid_b.count || (i < mid_a.count && mid_a[i] < mid_b[j]))
+        {
+          if (keep_a)
+            result.push_back(mid_a[i]);
+          ++i;
+        }
+        else if (i == mid_a.count || mid_b[j] < mid_a[i])
+        {
+          if (keep_b)
+            result.push_back(mid_b[j]);
+          ++j;
+        }
+        else
+        {
+          if (keep_both)
+            result.push_back(mid_a[i]);
+          ++i;
+          ++j;
+        }
+      }
+    }
+  }
+  return result;
+}
+
+//----------------------------------------------------------------------//
+
+/**
+ * \brief The indices of the orientation block `block` of `mesh`, a single run.
+ */
+template <int n, int k, typename Bint, typename Sint, typename Tint>
+IndexSet<Bint> block_index_set(const Lexicographic<n, k, Bint, Sint, Tint>& mesh, Tint block)
+{
+  return IndexSet<Bint>::interval(mesh.block_offset(block),
+                                  mesh.block_offset(block) + mesh.block_size(block));
+}
+
+/**
+ * \brief The indices of the elements of `mesh` with coordinates `lower[d] <= x[d] < upper[d]`.
+ *
+ * In each orientation block, the window is clipped to the extents of the block. It consists of
+ * one run along the fastest direction for each position in the other directions.
+ */
+template <int n, int k, typename Bint, typename Sint, typename Tint>
+IndexSet<Bint> window_index_set(const Lexicographic<n, k, Bint, Sint, Tint>& mesh,
+                                const std::array<Sint, std::size_t(n)>& lower,
+                                const std::array<Sint, std::size_t(n)>& upper)
+{
+  require_unreversed(mesh, "window_index_set()");
+  IndexSet<Bint> result;
+  for (Tint b = 0; b < mesh.n_blocks(); ++b)
+  {
+    const auto layout = mesh.block_layout(b);
+    std::array<Sint, n> lo, hi;
+    bool empty = false;
+    for (Tint d = 0; d < n; ++d)
+    {
+      lo[d] = lower[d];
+      hi[d] = std::min(upper[d], layout.extents[d]);
+      empty = empty || lo[d] >= hi[d];
+    }
+    if (empty)
+      continue;
+
+    const Tint fast = layout.order[0];
+    std::array<Sint, n> x = lo;
+    for (;;)
+    {
+      result.push_back(layout.index(x), hi[fast] - lo[fast], layout.strides[fast]);
+      Tint i = 1;
+      for (; i < n; ++i)
+      {
+        const Tint d = layout.order[i];
+        if (++x[d] < hi[d])
+          break;
+        x[d] = lo[d];
+      }
+      if (i >= n)
+        break;
+    }
+  }
+  return result;
+}
+
+/**
+ * \brief The indices of the elements of a Slab in its superset.
+ *
+ * The runs of Slab::for_each_run() are sorted. If runs interleave, which happens if the slab
+ * runs along a slower direction of the superset, they are merged by unions.
+ */
+template <int n, int k, typename Bint, typename Sint, typename Tint>
+IndexSet<Bint> slab_index_set(const Slab<n, k, Bint, Sint, Tint>& slab)
+{
+  typedef typename IndexSet<Bint>::Run Run;
+  std::vector<Run> runs;
+  slab.for_each_run([&](Bint, Bint global, Bint count, auto stride) {
+    if (stride < 0)
+      runs.push_back(Run{ Bint(global + (count - 1) * stride), count, Bint(-stride) });
+    else
+      runs.push_back(Run{ global, count, Bint(stride) });
+    if (count == 1)
+      runs.back().stride = 1;
+  });
+  std::sort(runs.begin(), runs.end(), [](const Run& a, const Run& b) { return a.first < b.first; });
+
+  // Append as long as runs do not interleave, then unite the resulting sets pairwise
+  std::vector<IndexSet<Bint>> sets(1);
+  for (const Run& run : runs)
+  {
+    if (!sets.back().empty() && sets.back().select(sets.back().size() - 1) >= run.first)
+      sets.emplace_back();
+    sets.back().push_back(run.first, run.count, run.stride);
+  }
+  while (sets.size() > 1)
+  {
+    std::vector<IndexSet<Bint>> merged;
+    for (std::size_t i = 0; i + 1 < sets.size(); i += 2)
+      merged.push_back(sets[i] | sets[i + 1]);
+    if (sets.size() % 2 == 1)
+      merged.push_back(sets.back());
+    sets.swap(merged);
+  }
+  return sets[0];
+}
+} // namespace TPCC
+
+#endif
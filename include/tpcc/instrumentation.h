@@ -0,0 +1,231 @@
+#ifndef TPCC_INSTRUMENTATION_H
+#define TPCC_INSTRUMENTATION_H
+
+/**
+ * \file
+ * \brief Optional counters for calls to the functions decoding single elements.
+ *
+ * If the preprocessor macro `TPCC_INSTRUMENT` is defined before including any header of this
+ * library, each call to one of the functions listed in TPCC::Instrumentation::Function is counted
+ * and timed. Counters are kept per thread and per pair `(n,k)`, and they are merged into a global
+ * table when a thread exits or when Instrumentation::merge() is called. Tensor orders of at least
+ * Instrumentation::max_order share a single overflow counter.
+ * Instrumentation::report() prints the merged table grouped by `(n,k)`.
+ *
+ * Without `TPCC_INSTRUMENT`, the macro #TPCC_INSTRUMENT_SCOPE expands to nothing and no code is
+ * generated at all.
+ *
+ * Timing is inclusive, thus the time of Lexicographic::index() contains the time of
+ * Combinations::index() called by it.
+ *
+ * \note In order to allow for the timer objects, the instrumented functions lose their
+ * `constexpr` qualifier if `TPCC_INSTRUMENT` is defined. See #TPCC_INSTRUMENTED_CONSTEXPR.
+ */
+
+#ifdef TPCC_INSTRUMENT
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <mutex>
+#include <ostream>
+
+namespace TPCC
+{
+namespace Instrumentation
+{
+/// The functions instrumented
+enum Function
+{
+  lexicographic_access,
+  lexicographic_index,
+  element_facet,
+  combinations_value,
+  combinations_index,
+  slab_access,
+  n_functions
+};
+
+/// Names of the functions in the report
+inline const char* function_name(unsigned int f)
+{
+  static const char* names[] = { "Lexicographic::operator[]", "Lexicographic::index()",
+                                 "Element::facet()",          "Combinations::value()",
+                                 "Combinations::index()",     "Slab::operator[]" };
+  return names[f];
+}
+
+/// The largest tensor order plus one for which separate counters are kept
+constexpr unsigned int max_order = 16;
+
+/// The number of counters per function, one for each pair `(n,k)` and one for larger orders
+constexpr unsigned int n_slots = max_order * max_order + 1;
+
+/// The counter of the pair `(n,k)`, or the overflow counter if `n` is at least #max_order
+constexpr unsigned int slot(unsigned int n, unsigned int k)
+{
+  return (n < max_order && k <= n) ? n * max_order + k : max_order * max_order;
+}
+
+/// Number of calls and accumulated time of one function for one pair `(n,k)`
+struct Counter
+{
+  std::uint64_t calls = 0;
+  std::uint64_t nanoseconds = 0;
+};
+
+/// A table of counters for all functions and pairs `(n,k)`
+struct Table
+{
+  std::array<Counter, n_functions * n_slots> counters{};
+
+  Counter& operator()(unsigned int f, unsigned int n, unsigned int k)
+  {
+    return counters[f * n_slots + slot(n, k)];
+  }
+
+  /// Add the counters of `other` to this table and reset `other`
+  void absorb(Table& other)
+  {
+    for (unsigned int i = 0; i < counters.size(); ++i)
+    {
+      counters[i].calls += other.counters[i].calls;
+      counters[i].nanoseconds += other.counters[i].nanoseconds;
+      other.counters[i] = Counter();
+    }
+  }
+};
+
+/// The global table with the merged counters of all threads
+struct Registry
+{
+  std::mutex mutex;
+  Table table;
+};
+
+inline Registry& registry()
+{
+  static Registry object;
+  return object;
+}
+
+/// The counters of a thread, merged into the Registry when the thread exits
+struct ThreadTable : public Table
+{
+  ThreadTable() { registry(); }
+  ~ThreadTable()
+  {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.table.absorb(*this);
+  }
+};
+
+inline ThreadTable& thread_table()
+{
+  static thread_local ThreadTable object;
+  return object;
+}
+
+/// Merge the counters of the calling thread into the global table
+inline void merge()
+{
+  Registry& r = registry();
+  std::lock_guard<std::mutex> lock(r.mutex);
+  r.table.absorb(thread_table());
+}
+
+/// Reset the global table and the counters of the calling thread
+inline void reset()
+{
+  merge();
+  Registry& r = registry();
+  std::lock_guard<std::mutex> lock(r.mutex);
+  r.table = Table();
+}
+
+/// The merged counter for function `f` and the pair `(n,k)`, after merging the calling thread
+inline Counter counter(Function f, unsigned int n, unsigned int k)
+{
+  merge();
+  Registry& r = registry();
+  std::lock_guard<std::mutex> lock(r.mutex);
+  return r.table(f, n, k);
+}
+
+/**
+ * \brief Print all nonzero counters grouped by `(n,k)`.
+ *
+ * The counters of the calling thread and of all threads which have exited are included. The
+ * overflow counter comes last.
+ */
+inline void report(std::ostream& os)
+{
+  merge();
+  Registry& r = registry();
+  std::lock_guard<std::mutex> lock(r.mutex);
+  for (unsigned int n = 0; n <= max_order; ++n)
+    for (unsigned int k = 0; k <= ((n < max_order) ? n : 0); ++k)
+    {
+      bool header = false;
+      for (unsigned int f = 0; f < n_functions; ++f)
+      {
+        const Counter& c = r.table(f, n, k);
+        if (c.calls == 0)
+          continue;
+        if (!header)
+        {
+          if (n < max_order)
+            os << "n=" << n << " k=" << k << '\n';
+          else
+            os << "n>=" << max_order << '\n';
+        }
+        header = true;
+        os << "  " << std::setw(28) << std::left << function_name(f) << std::right
+           << " calls " << std::setw(12) << c.calls << " time " << std::setw(12)
+           << c.nanoseconds * 1.e-9 << "s\n";
+      }
+    }
+}
+
+/**
+ * \brief Object counting a call and measuring the time until its destruction.
+ */
+class Scope
+{
+  Counter& counter;
+  std::chrono::steady_clock::time_point start;
+
+public:
+  Scope(Function f, unsigned int n, unsigned int k)
+    : counter(thread_table()(f, n, k))
+    , start(std::chrono::steady_clock::now())
+  {
+    ++counter.calls;
+  }
+  ~Scope()
+  {
+    counter.nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                             std::chrono::steady_clock::now() - start)
+                             .count();
+  }
+};
+} // namespace Instrumentation
+} // namespace TPCC
+
+/// Count and time the enclosing function as `function` for the pair `(n,k)`
+#define TPCC_INSTRUMENT_SCOPE(function, n, k)                                                      \
+  TPCC::Instrumentation::Scope tpcc_instrumentation_scope(TPCC::Instrumentation::function, n, k)
+
+/// Replaces `constexpr` for instrumented functions, empty if instrumentation is active
+#define TPCC_INSTRUMENTED_CONSTEXPR
+
+#else
+
+#define TPCC_INSTRUMENT_SCOPE(function, n, k)
+#define TPCC_INSTRUMENTED_CONSTEXPR constexpr
+
+#endif
+
+#endif
@@ -0,0 +1,655 @@
+#ifndef TPCC_KRONECKER_H
+#define TPCC_KRONECKER_H
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <utility>
+#include <vector>
+
+#include <tpcc/lexicographic.h>
+
+namespace TPCC
+{
+/**
+ * \brief A sparse matrix acting on a single fiber, a factor of a Kronecker product.
+ *
+ * The entries are stored in compressed row storage. A matrix created by identity() is flagged,
+ * such that mode products with it are skipped.
+ */
+template <typename Number = double>
+struct FiberMatrix
+{
+  unsigned int rows = 0;
+  unsigned int cols = 0;
+  /// Whether the matrix is the identity, in which case no entries are stored
+  bool is_identity = false;
+  /// The entries of row `i` are at positions `row_offsets[i]` to `row_offsets[i+1]-1`
+  std::vector<unsigned int> row_offsets;
+  std::vector<unsigned int> columns;
+  std::vector<Number> values;
+
+  /// The identity matrix of dimension `m`
+  static FiberMatrix identity(unsigned int m)
+  {
+    FiberMatrix result;
+    result.rows = result.cols = m;
+    result.is_identity = true;
+    return result;
+  }
+
+  /// The diagonal matrix with the entries `diagonal`
+  static FiberMatrix diagonal(const std::vector<Number>& diagonal)
+  {
+    FiberMatrix result;
+    result.rows = result.cols = diagonal.size();
+    result.row_offsets.push_back(0);
+    for (unsigned int i = 0; i < result.rows; ++i)
+    {
+      if (diagonal[i] != Number(0))
+      {
+        result.columns.push_back(i);
+        result.values.push_back(diagonal[i]);
+      }
+      result.row_offsets.push_back(result.columns.size());
+    }
+    return result;
+  }
+
+  /// The matrix with the nonzero entries of the row-major array `entries`
+  static FiberMatrix dense(unsigned int rows, unsigned int cols, const std::vector<Number>& entries)
+  {
+    FiberMatrix result;
+    result.rows = rows;
+    result.cols = cols;
+    result.row_offsets.push_back(0);
+    for (unsigned int i = 0; i < rows; ++i)
+    {
+      for (unsigned int j = 0; j < cols; ++j)
+        if (entries[i * cols + j] != Number(0))
+        {
+          result.columns.push_back(j);
+          result.values.push_back(entries[i * cols + j]);
+        }
+      result.row_offsets.push_back(result.columns.size());
+    }
+    return result;
+  }
+
+  /// The transpose, computed by counting the entries in each column
+  FiberMatrix transpose() const;
+
+  /// The number of stored entries
+  std::size_t n_nonzero_elements() const { return values.size(); }
+
+  /// The memory used by the matrix in bytes
+  std::size_t memory_consumption() const
+  {
+    return sizeof(*this) + row_offsets.capacity() * sizeof(unsigned int) +
+           columns.capacity() * sizeof(unsigned int) + values.capacity() * sizeof(Number);
+  }
+
+  /**
+   * \brief The mode product `out[o][i][m] = sum_j A(i,j) in[o][j][m]`.
+   *
+   * Here, `in` is a dense array with `outer*cols*inner` entries and `out` one with
+   * `outer*rows*inner` entries. If the inner index is not trivial, its range is split into
+   * chunks of #chunk_size entries, such that a chunk of each output row stays in cache while the
+   * input rows are added to it. The innermost loop is a contiguous `axpy` which the compiler
+   * vectorizes.
+   *
+   * If `begin` and `end` are given, only the inner indices `begin<=m<end` are computed, such
+   * that several threads can share a product with few outer indices.
+   */
+  void mode_product(const Number* in, Number* out, std::size_t inner, std::size_t outer,
+                    std::size_t begin = 0, std::size_t end = std::size_t(-1)) const;
+
+  /// The length of the chunks of the inner index in mode_product()
+  static constexpr std::size_t chunk_size = 256;
+};
+
+//----------------------------------------------------------------------//
+
+/**
+ * \brief An operator between cochains on tensor product complexes stored by its Kronecker
+ * factors.
+ *
+ * Within each pair of orientation blocks, the boundary operator, diagonal operators and the
+ * Laplacian of a Lexicographic complex are sums of Kronecker products of matrices acting on
+ * single fibers. Thus, the operator is stored as a list of terms, each with a range block, a
+ * domain block, a coefficient and one FiberMatrix for each direction. The factors are shared
+ * between terms, and the identities are not stored at all. Therefore, the memory scales with
+ * the sum of the fiber lengths, not with the number of cells.
+ *
+ * The blocks are dense arrays described by BlockLayout. vmult() applies each term by a sequence
+ * of mode products in the direction order of the domain block, skipping identities, and adds
+ * the result to the range block with its strides.
+ *
+ * The functions boundary_operator(), diagonal_operator() and laplacian_operator() create the
+ * operators for a Lexicographic complex.
+ */
+template <int n, typename Number = double, typename Bint = unsigned int,
+          typename Sint = unsigned short, typename Tint = unsigned char>
+class KroneckerOperator
+{
+public:
+  typedef BlockLayout<n, Bint, Sint, Tint> layout_type;
+
+  /// One Kronecker product between two orientation blocks
+  struct Term
+  {
+    Tint range_block;
+    Tint domain_block;
+    Number coefficient;
+    /// The number of the factor for each direction, see factor()
+    std::array<unsigned int, n> factors;
+  };
+
+  /// Constructor for an operator mapping cochains on `domain` to cochains on `range`
+  template <int k_range, int k_domain>
+  KroneckerOperator(const Lexicographic<n, k_range, Bint, Sint, Tint>& range,
+                    const Lexicographic<n, k_domain, Bint, Sint, Tint>& domain)
+    : range_size(range.size())
+    , domain_size(domain.size())
+  {
+    require_unreversed(range, "KroneckerOperator");
+    require_unreversed(domain, "KroneckerOperator");
+    for (Tint b = 0; b < range.n_blocks(); ++b)
+      range_layouts.push_back(range.block_layout(b));
+    for (Tint b = 0; b < domain.n_blocks(); ++b)
+      domain_layouts.push_back(domain.block_layout(b));
+  }
+
+  /// The number of rows
+  Bint n_rows() const { return range_size; }
+
+  /// The number of columns
+  Bint n_cols() const { return domain_size; }
+
+  /// The number of orientation blocks of the range
+  Tint n_range_blocks() const { return range_layouts.size(); }
+
+  /// The number of orientation blocks of the domain
+  Tint n_domain_blocks() const { return domain_layouts.size(); }
+
+  /// The layout of the orientation block `b` of the range
+  const layout_type& range_layout(Tint b) const { return range_layouts[b]; }
+
+  /// The layout of the orientation block `b` of the domain
+  const layout_type& domain_layout(Tint b) const { return domain_layouts[b]; }
+
+  /// Store a factor and return its number
+  unsigned int add_factor(const FiberMatrix<Number>& matrix)
+  {
+    factor_list.push_back(matrix);
+    return factor_list.size() - 1;
+  }
+
+  /// The number of an identity factor of dimension `m`, added if not yet stored
+  unsigned int identity_factor(unsigned int m);
+
+  /// The factor with number `f`
+  const FiberMatrix<Number>& factor(unsigned int f) const { return factor_list[f]; }
+
+  /**
+   * \brief Add the term `coefficient` times the Kronecker product of the factors from the
+   * domain block `domain_block` to the range block `range_block`.
+   *
+   * The factor for direction `d` must have as many columns as the domain block has elements
+   * in this direction and as many rows as the range block.
+   */
+  void add_term(Tint range_block, Tint domain_block, Number coefficient,
+                const std::array<unsigned int, n>& factors);
+
+  /// The number of terms
+  std::size_t n_terms() const { return terms.size(); }
+
+  /// The term with number `t`
+  const Term& term(std::size_t t) const { return terms[t]; }
+
+  /// The number of entries of the workspace needed by vmult_add()
+  std::size_t workspace_size() const { return 2 * work_size; }
+
+  /**
+   * \brief Compute `y += A x` with the caller's `workspace` of workspace_size() entries for
+   * the intermediate tensors of the mode products.
+   */
+  void vmult_add(Number* y, const Number* x, Number* workspace) const;
+
+  /// Compute `y += A x` with a workspace kept per thread and reused between calls
+  void vmult_add(Number* y, const Number* x) const
+  {
+    static thread_local std::vector<Number> workspace;
+    if (workspace.size() < workspace_size())
+      workspace.resize(workspace_size());
+    vmult_add(y, x, workspace.data());
+  }
+
+  /// Compute `y = A x`
+  void vmult(Number* y, const Number* x) const
+  {
+    std::fill(y, y + range_size, Number(0));
+    vmult_add(y, x);
+  }
+
+  /// The memory used by the operator in bytes
+  std::size_t memory_consumption() const;
+
+private:
+  Bint range_size;
+  Bint domain_size;
+  std::vector<layout_type> range_layouts;
+  std::vector<layout_type> domain_layouts;
+  std::vector<FiberMatrix<Number>> factor_list;
+  std::vector<Term> terms;
+  /// The largest intermediate tensor of a term, see workspace_size()
+  std::size_t work_size = 0;
+};
+
+//----------------------------------------------------------------------//
+
+template <typename Number>
+void FiberMatrix<Number>::mode_product(const Number* in, Number* out, std::size_t inner,
+                                       std::size_t outer, std::size_t begin, std::size_t end) const
+{
+  end = std::min(end, inner);
+  if (begin >= end)
+    return;
+  if (inner == 1)
+  {
+    for (std::size_t o = 0; o < outer; ++o, in += cols, out += rows)
+      for (unsigned int i = 0; i < rows; ++i)
+      {
+        Number sum = 0;
+        for (unsigned int j = row_offsets[i]; j < row_offsets[i + 1]; ++j)
+          sum += values[j] * in[columns[j]];
+        out[i] = sum;
+      }
+    return;
+  }
+
+  for (std::size_t o = 0; o < outer; ++o, in += cols * inner, out += rows * inner)
+    for (std::size_t first = begin; first < end; first += chunk_size)
+    {
+      const std::size_t length = std::min(chunk_size, end - first);
+      for (unsigned int i = 0; i < rows; ++i)
+      {
+        Number* y = out + i * inner + first;
+        std::fill(y, y + length, Number(0));
+        for (unsigned int j = row_offsets[i]; j < row_offsets[i + 1]; ++j)
+        {
+          const Number a = values[j];
+          const Number* x = in + columns[j] * inner + first;
+          for (std::size_t l = 0; l < length; ++l)
+            y[l] += a * x[l];
+        }
+      }
+    }
+}
+
+template <typename Number>
+FiberMatrix<Number> FiberMatrix<Number>::transpose() const
+{
+  if (is_identity)
+    return identity(rows);
+  FiberMatrix result;
+  result.rows = cols;
+  result.cols = rows;
+  result.row_offsets.assign(cols + 1, 0);
+  for (const unsigned int j : columns)
+    ++result.row_offsets[j + 1];
+  for (unsigned int j = 0; j < cols; ++j)
+    result.row_offsets[j + 1] += result.row_offsets[j];
+  result.columns.resize(columns.size());
+  result.values.resize(values.size());
+  std::vector<unsigned int> next(result.row_offsets.begin(), result.row_offsets.end() - 1);
+  for (unsigned int i = 0; i < rows; ++i)
+    for (unsigned int j = row_offsets[i]; j < row_offsets[i + 1]; ++j)
+    {
+      const unsigned int position = next[columns[j]]++;
+      result.columns[position] = i;
+      result.values[position] = values[j];
+    }
+  return result;
+}
+
+template <int n, typename Number, typename Bint, typename Sint, typename Tint>
+unsigned int KroneckerOperator<n, Number, Bint, Sint, Tint>::identity_factor(unsigned int m)
+{
+  for (unsigned int f = 0; f < factor_list.size(); ++f)
+    if (factor_list[f].is_identity && factor_list[f].rows == m)
+      return f;
+  return add_factor(FiberMatrix<Number>::identity(m));
+}
+
+template <int n, typename Number, typename Bint, typename Sint, typename Tint>
+void KroneckerOperator<n, Number, Bint, Sint, Tint>::add_term(
+  Tint range_block, Tint domain_block, Number coefficient,
+  const std::array<unsigned int, n>& factors)
+{
+  // Mode products may grow intermediate tensors beyond both blocks, thus bound generously
+  std::size_t size = 1;
+  for (Tint d = 0; d < n; ++d)
+  {
+    assert(factor_list[factors[d]].rows == range_layouts[range_block].extents[d]);
+    assert(factor_list[factors[d]].cols == domain_layouts[domain_block].extents[d]);
+    size *= std::max(factor_list[factors[d]].rows, factor_list[factors[d]].cols);
+  }
+  work_size = std::max(work_size, size);
+  terms.push_back(Term{ range_block, domain_block, coefficient, factors });
+}
+
+template <int n, typename Number, typename Bint, typename Sint, typename Tint>
+void KroneckerOperator<n, Number, Bint, Sint, Tint>::vmult_add(Number* y, const Number* x,
+                                                               Number* workspace) const
+{
+  Number* const buffer1 = workspace;
+  Number* const buffer2 = workspace + work_size;
+
+  for (const Term& term : terms)
+  {
+    const layout_type& from = domain_layouts[term.domain_block];
+    const layout_type& to = range_layouts[term.range_block];
+
+    // The work tensor in the direction order of the domain block
+    std::array<std::size_t, n> extents;
+    for (Tint i = 0; i < n; ++i)
+      extents[i] = from.extents[from.order[i]];
+    const Number* work = x + from.offset;
+    Number* next = buffer1;
+    for (Tint i = 0; i < n; ++i)
+    {
+      const FiberMatrix<Number>& A = factor_list[term.factors[from.order[i]]];
+      if (A.is_identity)
+        continue;
+      std::size_t inner = 1, outer = 1;
+      for (Tint j = 0; j < i; ++j)
+        inner *= extents[j];
+      for (Tint j = i + 1; j < n; ++j)
+        outer *= extents[j];
+      A.mode_product(work, next, inner, outer);
+      extents[i] = A.rows;
+      work = next;
+      next = (next == buffer1) ? buffer2 : buffer1;
+    }
+
+    // Add to the range block, where the fastest direction of the work tensor may have a stride
+    const Bint stride = to.strides[from.order[0]];
+    std::array<std::size_t, n> position{};
+    for (;;)
+    {
+      Bint index = to.offset;
+      for (Tint i = 1; i < n; ++i)
+        index += position[i] * to.strides[from.order[i]];
+      Number* target = y + index;
+      if (stride == 1)
+        for (std::size_t l = 0; l < extents[0]; ++l)
+          target[l] += term.coefficient * work[l];
+      else
+        for (std::size_t l = 0; l < extents[0]; ++l)
+          target[l * stride] += term.coefficient * work[l];
+      work += extents[0];
+
+      Tint i = 1;
+      for (; i < n; ++i)
+      {
+        if (++position[i] < extents[i])
+          break;
+        position[i] = 0;
+      }
+      if (i >= n)
+        break;
+    }
+  }
+}
+
+template <int n, typename Number, typename Bint, typename Sint, typename Tint>
+std::size_t KroneckerOperator<n, Number, Bint, Sint, Tint>::memory_consumption() const
+{
+  std::size_t result = sizeof(*this) + (range_layouts.capacity() + domain_layouts.capacity()) *
+                                         sizeof(layout_type) +
+                       terms.capacity() * sizeof(Term);
+  for (const auto& f : factor_list)
+    result += f.memory_consumption();
+  return result;
+}
+
+//----------------------------------------------------------------------//
+
+/**
+ * \brief The difference matrix of a single fiber, mapping cells to their boundary points.
+ *
+ * Column `x` has the entry `-1` in row `x` and `+1` in row `x+1`, which wraps around to zero
+ * in periodic directions. The matrix is stored with its at most two entries per row.
+ */
+template <typename Number = double>
+FiberMatrix<Number> fiber_difference(unsigned int cells, bool periodic)
+{
+  const unsigned int points = cells + (periodic ? 0 : 1);
+  FiberMatrix<Number> result;
+  result.rows = points;
+  result.cols = cells;
+  result.row_offsets.push_back(0);
+  for (unsigned int x = 0; x < points; ++x)
+  {
+    // The cell starting at the point and the one ending there, the latter wrapping around
+    std::array<std::pair<unsigned int, Number>, 2> entries;
+    unsigned int count = 0;
+    if (x < cells)
+      entries[count++] = { x, Number(-1) };
+    if (x > 0 || periodic)
+      entries[count++] = { (x > 0) ? x - 1 : cells - 1, Number(1) };
+    // A single periodic cell is its own neighbor, and the entries cancel
+    if (count == 2 && entries[0].first == entries[1].first)
+      count = 0;
+    std::sort(entries.begin(), entries.begin() + count);
+    for (unsigned int i = 0; i < count; ++i)
+    {
+      result.columns.push_back(entries[i].first);
+      result.values.push_back(entries[i].second);
+    }
+    result.row_offsets.push_back(result.columns.size());
+  }
+  return result;
+}
+
+/**
+ * \brief The product `A B` of two fiber matrices, where `A^T` or `B^T` is used if requested.
+ *
+ * The product is computed row by row from the sparse factors, accumulating each row of the
+ * result in a dense array. Thus, its complexity is the number of products of nonzero entries,
+ * linear in the fiber length for banded factors. Entries cancelling to zero are not stored.
+ */
+template <typename Number>
+FiberMatrix<Number> fiber_product(const FiberMatrix<Number>& A, const FiberMatrix<Number>& B,
+                                  bool transpose_a = false, bool transpose_b = false)
+{
+  const FiberMatrix<Number> a = transpose_a ? A.transpose() : A;
+  const FiberMatrix<Number> b = transpose_b ? B.transpose() : B;
+  assert(a.cols == b.rows);
+  if (a.is_identity)
+    return b;
+  if (b.is_identity)
+    return a;
+
+  FiberMatrix<Number> result;
+  result.rows = a.rows;
+  result.cols = b.cols;
+  result.row_offsets.push_back(0);
+  std::vector<Number> row(b.cols);
+  std::vector<bool> occupied(b.cols);
+  std::vector<unsigned int> pattern;
+  for (unsigned int i = 0; i < a.rows; ++i)
+  {
+    pattern.clear();
+    for (unsigned int l = a.row_offsets[i]; l < a.row_offsets[i + 1]; ++l)
+    {
+      const unsigned int r = a.columns[l];
+      for (unsigned int j = b.row_offsets[r]; j < b.row_offsets[r + 1]; ++j)
+      {
+        const unsigned int c = b.columns[j];
+        if (!occupied[c])
+        {
+          occupied[c] = true;
+          pattern.push_back(c);
+        }
+        row[c] += a.values[l] * b.values[j];
+      }
+    }
+    std::sort(pattern.begin(), pattern.end());
+    for (const unsigned int c : pattern)
+    {
+      if (row[c] != Number(0))
+      {
+        result.columns.push_back(c);
+        result.values.push_back(row[c]);
+      }
+      row[c] = 0;
+      occupied[c] = false;
+    }
+    result.row_offsets.push_back(result.columns.size());
+  }
+  return result;
+}
+
+/**
+ * \brief The boundary operator from the `k`-cells of `mesh` to the `(k-1)`-cells.
+ *
+ * The facets of a cell are oriented as in Element::facet(): the upper facet in the `i`th
+ * direction along the cell has the sign `(-1)^i` and the lower facet the opposite sign. For
+ * each orientation block of the cells and each direction along them, there is one term with the
+ * difference matrix in this direction and identities in all others.
+ */
+template <typename Number = double, int n, int k, typename Bint, typename Sint, typename Tint>
+KroneckerOperator<n, Number, Bint, Sint, Tint> boundary_operator(
+  const Lexicographic<n, k, Bint, Sint, Tint>& mesh)
+{
+  static_assert(k >= 1, "The boundary operator needs cells of dimension at least 1");
+  const auto facets = mesh.boundary();
+  KroneckerOperator<n, Number, Bint, Sint, Tint> result(facets, mesh);
+
+  std::array<unsigned int, n> differences, along_identities, across_identities;
+  for (Tint d = 0; d < n; ++d)
+  {
+    differences[d] =
+      result.add_factor(fiber_difference<Number>(mesh.fiber_dimension(d), mesh.is_periodic(d)));
+    along_identities[d] = result.identity_factor(mesh.fiber_dimension(d));
+    across_identities[d] = result.identity_factor(mesh.across_extent(d));
+  }
+
+  for (Tint b = 0; b < mesh.n_blocks(); ++b)
+  {
+    const auto layout = result.domain_layout(b);
+    std::array<bool, n> along{};
+    for (Tint i = 0; i < k; ++i)
+      along[layout.order[i]] = true;
+
+    // The position of the direction among the directions along the cell, in ascending order
+    Tint position = 0;
+    for (Tint d = 0; d < n; ++d)
+    {
+      if (!along[d])
+        continue;
+      std::array<bool, n> facet_along = along;
+      facet_along[d] = false;
+      Tint facet_block = 0;
+      for (Tint fb = 0; fb < facets.n_blocks(); ++fb)
+      {
+        const auto facet_layout = result.range_layout(fb);
+        bool match = true;
+        for (Tint i = 0; i + 1 < k; ++i)
+          match = match && facet_along[facet_layout.order[i]];
+        if (match)
+          facet_block = fb;
+      }
+
+      std::array<unsigned int, n> factors;
+      for (Tint e = 0; e < n; ++e)
+        factors[e] = (e == d) ? differences[e]
+                              : (along[e] ? along_identities[e] : across_identities[e]);
+      result.add_term(facet_block, b, (position % 2 == 0) ? 1 : -1, factors);
+      ++position;
+    }
+  }
+  return result;
+}
+
+/**
+ * \brief A diagonal operator on the `k`-cells of `mesh` which is a product of weights.
+ *
+ * The diagonal entry of a cell with coordinates `x` is the product of `along[d][x[d]]` over
+ * the directions along the cell and `across[d][x[d]]` over the directions across. With the
+ * lengths of the cells in each direction as `along` and ones as `across`, this is the volume of
+ * each cell, a lumped mass matrix.
+ */
+template <typename Number = double, int n, int k, typename Bint, typename Sint, typename Tint>
+KroneckerOperator<n, Number, Bint, Sint, Tint> diagonal_operator(
+  const Lexicographic<n, k, Bint, Sint, Tint>& mesh,
+  const std::array<std::vector<Number>, std::size_t(n)>& along,
+  const std::array<std::vector<Number>, std::size_t(n)>& across)
+{
+  KroneckerOperator<n, Number, Bint, Sint, Tint> result(mesh, mesh);
+  std::array<unsigned int, n> along_factors, across_factors;
+  for (Tint d = 0; d < n; ++d)
+  {
+    const unsigned int cells = mesh.fiber_dimension(d), points = mesh.across_extent(d);
+    along_factors[d] = result.add_factor(FiberMatrix<Number>::diagonal(
+      std::vector<Number>(along[d].begin(), along[d].begin() + cells)));
+    across_factors[d] = result.add_factor(FiberMatrix<Number>::diagonal(
+      std::vector<Number>(across[d].begin(), across[d].begin() + points)));
+  }
+  for (Tint b = 0; b < mesh.n_blocks(); ++b)
+  {
+    const auto layout = result.domain_layout(b);
+    std::array<unsigned int, n> factors = across_factors;
+    for (Tint i = 0; i < k; ++i)
+      factors[layout.order[i]] = along_factors[layout.order[i]];
+    result.add_term(b, b, 1, factors);
+  }
+  return result;
+}
+
+/**
+ * \brief The combinatorial Hodge Laplacian `B_k^T B_k + B_{k+1} B_{k+1}^T` on the `k`-cells of
+ * `mesh`, where `B_k` is the boundary_operator() of the `k`-cells.
+ *
+ * With the orientation of the tensor product, the Laplacian does not couple different
+ * orientation blocks. In each block, it is the sum over all directions of the one-dimensional
+ * Laplacian in this direction with identities in the others. This is `D^T D` in directions
+ * along the cells and `D D^T` in directions across, where `D` is the fiber_difference().
+ */
+template <typename Number = double, int n, int k, typename Bint, typename Sint, typename Tint>
+KroneckerOperator<n, Number, Bint, Sint, Tint> laplacian_operator(
+  const Lexicographic<n, k, Bint, Sint, Tint>& mesh)
+{
+  KroneckerOperator<n, Number, Bint, Sint, Tint> result(mesh, mesh);
+  std::array<unsigned int, n> along_laplacians, across_laplacians, along_identities,
+    across_identities;
+  for (Tint d = 0; d < n; ++d)
+  {
+    const auto D = fiber_difference<Number>(mesh.fiber_dimension(d), mesh.is_periodic(d));
+    along_laplacians[d] = result.add_factor(fiber_product(D, D, true));
+    across_laplacians[d] = result.add_factor(fiber_product(D, D, false, true));
+    along_identities[d] = result.identity_factor(mesh.fiber_dimension(d));
+    across_identities[d] = result.identity_factor(mesh.across_extent(d));
+  }
+  for (Tint b = 0; b < mesh.n_blocks(); ++b)
+  {
+    const auto layout = result.domain_layout(b);
+    std::array<bool, n> along{};
+    for (Tint i = 0; i < k; ++i)
+      along[layout.order[i]] = true;
+    for (Tint d = 0; d < n; ++d)
+    {
+      std::array<unsigned int, n> factors;
+      for (Tint e = 0; e < n; ++e)
+        factors[e] = along[e] ? along_identities[e] : across_identities[e];
+      factors[d] = along[d] ? along_laplacians[d] : across_laplacians[d];
+      result.add_term(b, b, 1, factors);
+    }
+  }
+  return result;
+}
+} // namespace TPCC
+
+#endif
@@ -1,10 +1,102 @@
 #ifndef TPCC_LEXICOGRAPHIC_H
 #define TPCC_LEXICOGRAPHIC_H
 
+#include <algorithm>
+#include <stdexcept>
+#include <string>
 #include <tpcc/element.h>
+#include <type_traits>
 
 namespace TPCC
 {
+/**
+ * \brief The layout of one orientation block of a Lexicographic enumeration.
+ *
+ * All elements in an orientation block form a dense `n`-dimensional array stored in first
+ * fastest order. This object describes this array in the spirit of `std::mdspan`: the element
+ * with coordinates `x` in the complex has the index `offset + sum position(d, x[d]) *
+ * strides[d]`, where the position is the coordinate itself, or counted from the end of the
+ * array in directions numbered in reverse. All arrays are indexed by the global coordinate
+ * directions of the complex.
+ *
+ * Thus, loops over a block can be written as nested loops over the positions, for instance
+ * in two dimensions with `order[0]` as the fastest direction:
+ * \code
+ * Bint index = layout.offset;
+ * for (Sint y = 0; y < layout.extents[layout.order[1]]; ++y)
+ *   for (Sint x = 0; x < layout.extents[layout.order[0]]; ++x, ++index)
+ *     ...
+ * \endcode
+ */
+template <int n, typename Bint = unsigned int, typename Sint = unsigned short,
+          typename Tint = unsigned char>
+struct BlockLayout
+{
+  /// Signed integer type for differences of indices
+  typedef typename std::make_signed<Bint>::type difference_t;
+
+  /// The index of the first element of the block in the whole enumeration
+  Bint offset;
+  /// The number of elements of the block in each coordinate direction
+  std::array<Sint, n> extents;
+  /// The difference of indices between neighbors in each coordinate direction
+  std::array<Bint, n> strides;
+  /// The coordinate directions ordered from the fastest to the slowest
+  std::array<Tint, n> order;
+  /// The directions in which the positions run from the upper end of the array
+  std::array<bool, n> reverse{};
+
+  /// The number of neighbors including the element itself, namely `3^n`
+  static constexpr unsigned int n_neighbors()
+  {
+    unsigned int result = 1;
+    for (int i = 0; i < n; ++i)
+      result *= 3;
+    return result;
+  }
+
+  /// The number of elements in the block
+  constexpr Bint size() const
+  {
+    Bint result = 1;
+    for (Tint d = 0; d < n; ++d)
+      result *= extents[d];
+    return result;
+  }
+
+  /// The position in the array in direction `d` of the coordinate `x`
+  constexpr Sint position(Tint d, Sint x) const { return reverse[d] ? extents[d] - 1 - x : x; }
+
+  /// The index of the element with coordinates `x`
+  constexpr Bint index(const std::array<Sint, n>& x) const
+  {
+    Bint result = offset;
+    for (Tint d = 0; d < n; ++d)
+      result += position(d, x[d]) * strides[d];
+    return result;
+  }
+
+  /**
+   * \brief The differences of indices to all neighbors within the block.
+   *
+   * The neighbor shifted by `s[d]` in {-1,0,1} in direction `d` has the entry
+   * `sum (s[d]+1) 3^d`. The differences are only meaningful if the neighbor exists, that is,
+   * for elements not at the boundary of the block.
+   */
+  constexpr std::array<difference_t, n_neighbors()> neighbor_offsets() const
+  {
+    std::array<difference_t, n_neighbors()> result{};
+    for (unsigned int i = 0; i < n_neighbors(); ++i)
+    {
+      unsigned int code = i;
+      for (Tint d = 0; d < n; ++d, code /= 3)
+        result[i] += (difference_t(code % 3) - 1) * difference_t(strides[d]) *
+                     (reverse[d] ? -1 : 1);
+    }
+    return result;
+  }
+};
+
 /**
  * \brief Lexicographic enumeration of the `k`-dimensional faces in a tensor product chain complex
  * of dimension `n`.
@@ -31,6 +123,28 @@ namespace TPCC
  *
  * The fastes level of enumeration is inside each sheet, where again the first coordinates
  * run fastest.
+ *
+ * \section order Direction order
+ *
+ * The order of directions inside each sheet and for the sheets can be changed by providing a
+ * permutation of the coordinate directions to the constructor, the fastest running one first.
+ * Inside each orientation block, the directions along the elements still run faster than
+ * those across, but each group is ordered according to this permutation. This way, for
+ * instance on anisotropic meshes, the longest fiber can be made the fastest running index.
+ *
+ * Additionally, directions can be numbered in reverse, such that the coordinate `x` counts as
+ * position `e-1-x` in a block with `e` positions in that direction. This matches arrays stored
+ * from the upper end in some direction. Order, extents, strides and reversal of each block are
+ * computed at construction, such that operator[]() and index() only decode and combine
+ * positions.
+ *
+ * \section periodic Periodic directions
+ *
+ * Optionally, some coordinate directions can be periodic. In such a direction `d`, the
+ * coordinates `0` and `fiber_dimension(d)` across an element are identified, such that there
+ * are only `fiber_dimension(d)` instead of `fiber_dimension(d)+1` positions across. All
+ * numbering remains arithmetic; index() maps the coordinate `fiber_dimension(d)`, as produced
+ * by Element::facet() for the upper facet of the last cell, back to zero.
  */
 template <int n, int k, typename Bint = unsigned int, typename Sint = unsigned short,
           typename Tint = unsigned char>
@@ -40,10 +154,47 @@ class Lexicographic
    * \brief The dimension of the fibers in each direction.
    */
   std::array<Sint, n> dimensions;
+  /**
+   * \brief Whether the coordinate directions are periodic.
+   */
+  std::array<bool, n> periodic;
+  /**
+   * \brief The coordinate directions from fastest to slowest.
+   */
+  std::array<Tint, n> directions;
+  /**
+   * \brief Whether the coordinate directions are numbered in reverse.
+   */
+  std::array<bool, n> reversed;
   /**
    * \brief The number of objects facing the same directions.
    */
   std::array<Bint, binomial(n, k)> block_sizes;
+  /**
+   * \brief The index of the first object in each orientation block, and the total number.
+   */
+  std::array<Bint, binomial(n, k) + 1> block_offsets;
+
+  /**
+   * \brief The numbering of an orientation block, with all arrays indexed by the position in
+   * the order from fastest to slowest.
+   */
+  struct BlockNumbering
+  {
+    /// The members and non-members of the Combination of the block
+    std::array<Tint, k> in;
+    std::array<Tint, n - k> out;
+    /// The directions from fastest to slowest, see block_order()
+    std::array<Tint, n> order;
+    /// The number of positions in each direction
+    std::array<Sint, n> extents;
+    /// The index difference between neighbors in each direction
+    std::array<Bint, n> strides;
+  };
+  std::array<BlockNumbering, binomial(n, k)> numberings;
+
+  static_assert(binomial(n, k) <= (1u << (8 * sizeof(Tint))) - 1,
+                "The orientation blocks must be numbered by the type Tint");
 
 public:
   /// The tensor order of the chain complex
@@ -62,35 +213,74 @@ public:
   /// The type of elements of this set in the complex
   typedef Element<n, k, Sint, Tint> value_type;
 
+  /// The identity permutation of directions, the default order with first fastest
+  static constexpr std::array<Tint, n> default_order()
+  {
+    std::array<Tint, n> result{};
+    for (Tint i = 0; i < n; ++i)
+      result[i] = i;
+    return result;
+  }
+
   /**
-   * \brief Constructor setting the dimensions of the complex.
+   * \brief Constructor setting the dimensions of the complex and optionally periodic
+   * directions, the order of directions, fastest first, and directions numbered in reverse.
+   *
+   * Throws `std::invalid_argument` if `order` is not a permutation of `0` to `n-1`.
    */
-  constexpr Lexicographic(const std::array<Sint, n>& d)
+  constexpr Lexicographic(const std::array<Sint, n>& d, const std::array<bool, n>& p = {},
+                          const std::array<Tint, n>& order = default_order(),
+                          const std::array<bool, n>& reverse = {})
     : dimensions(d)
+    , periodic(p)
+    , directions(order)
+    , reversed(reverse)
+    , block_sizes{}
+    , block_offsets{}
+    , numberings{}
   {
-    Combinations<n, k> combinations;
-    for (Tint i = 0; i < binomial(n, k); ++i)
+    std::array<bool, n> seen{};
+    for (Tint i = 0; i < n; ++i)
     {
-      Bint p = 1;
-      auto combination = combinations[i];
+      if (order[i] >= n || seen[order[i]])
+        throw std::invalid_argument("Lexicographic: direction order is not a permutation");
+      seen[order[i]] = true;
+    }
+
+    for (CombinationIterator<n, k> it; !it.at_end(); ++it)
+    {
+      BlockNumbering& numbering = numberings[it.index()];
+      const auto combination = it.template combination<Tint>();
+      std::array<bool, n> along{};
       for (Tint j = 0; j < k; ++j)
-        p *= dimensions[n - 1 - combination.in(j)];
+      {
+        numbering.in[j] = combination.in(j);
+        along[n - 1 - combination.in(j)] = true;
+      }
       for (Tint j = 0; j < n - k; ++j)
-        p *= 1 + dimensions[n - 1 - combination.out(j)];
-      block_sizes[i] = p;
+        numbering.out[j] = combination.out(j);
+      numbering.order = block_order(along);
+      Bint p = 1;
+      for (Tint i = 0; i < n; ++i)
+      {
+        const Tint d = numbering.order[i];
+        numbering.extents[i] = (i < k) ? dimensions[d] : across_extent(d);
+        numbering.strides[i] = p;
+        p *= numbering.extents[i];
+      }
+      block_sizes[it.index()] = p;
     }
+    for (unsigned int b = 0; b < block_sizes.size(); ++b)
+      block_offsets[b + 1] = block_offsets[b] + block_sizes[b];
   }
 
   /**
    * \brief The number of elements in this set.
    */
-  constexpr Bint size() const
-  {
-    Bint sum = 0;
-    for (unsigned int i = 0; i < block_sizes.size(); ++i)
-      sum += block_sizes[i];
-    return sum;
-  }
+  constexpr Bint size() const { return block_offsets.back(); }
+
+  /// The number of orientation blocks
+  static constexpr Tint n_blocks() { return binomial(n, k); }
 
   /**
    * \brief The number of elements in one direction
@@ -100,6 +290,44 @@ public:
   /// Dimension of the fiber with given index in the tensor product
   constexpr Sint fiber_dimension(Tint i) const { return dimensions[i]; }
 
+  /// Whether the direction `i` is periodic
+  constexpr bool is_periodic(Tint i) const { return periodic[i]; }
+
+  /// The permutation of coordinate directions, fastest first
+  constexpr const std::array<Tint, n>& direction_order() const { return directions; }
+
+  /// Whether the direction `i` is numbered in reverse
+  constexpr bool is_reversed(Tint i) const { return reversed[i]; }
+
+  /// The flags for directions numbered in reverse
+  constexpr const std::array<bool, n>& reversed_directions() const { return reversed; }
+
+  /// Whether any direction is numbered in reverse
+  constexpr bool has_reversed_directions() const
+  {
+    for (Tint d = 0; d < n; ++d)
+      if (reversed[d])
+        return true;
+    return false;
+  }
+
+  /**
+   * \brief The number of different coordinates of elements orthogonal to direction `i`.
+   *
+   * This is `fiber_dimension(i)+1`, or `fiber_dimension(i)` if the direction is periodic.
+   */
+  constexpr Sint across_extent(Tint i) const { return dimensions[i] + (periodic[i] ? 0 : 1); }
+
+  /**
+   * \brief The index of the first element in the orientation block `block`.
+   */
+  constexpr Bint block_offset(Tint block) const { return block_offsets[block]; }
+
+  /**
+   * \brief Offset, extents and strides of the orientation block `block` as a dense array.
+   */
+  BlockLayout<n, Bint, Sint, Tint> block_layout(Tint block) const;
+
   /**
    * \brief Descriptor for the element at given `index`.
    */
@@ -112,68 +340,107 @@ public:
 
   constexpr Lexicographic<n, k - 1, Bint, Sint, Tint> boundary() const
   {
-    return Lexicographic<n, k - 1, Bint, Sint, Tint>{ dimensions };
+    return Lexicographic<n, k - 1, Bint, Sint, Tint>{ dimensions, periodic, directions,
+                                                     reversed };
+  }
+
+private:
+  /**
+   * \brief The directions of the block with given orientation, from fastest to slowest.
+   *
+   * These are the `k` directions along the elements followed by the `n-k` directions across,
+   * each in the order of #directions.
+   *
+   * \param along: Flags for the directions along the elements of the block
+   */
+  constexpr std::array<Tint, n> block_order(const std::array<bool, n>& along) const
+  {
+    std::array<Tint, n> result{};
+    Tint a = 0, c = k;
+    for (Tint i = 0; i < n; ++i)
+    {
+      const Tint d = directions[i];
+      result[along[d] ? a++ : c++] = d;
+    }
+    return result;
   }
 };
 
 template <int n, int k, typename Bint, typename Sint, typename Tint>
-Element<n, k, Sint, Tint> Lexicographic<n, k, Bint, Sint, Tint>::operator[](Bint index) const
+BlockLayout<n, Bint, Sint, Tint> Lexicographic<n, k, Bint, Sint, Tint>::block_layout(
+  Tint block) const
 {
-  unsigned int b = 0;
-  while (b < block_sizes.size())
+  const BlockNumbering& numbering = numberings[block];
+  BlockLayout<n, Bint, Sint, Tint> result;
+  result.offset = block_offset(block);
+  result.order = numbering.order;
+  result.reverse = reversed;
+  for (Tint i = 0; i < n; ++i)
   {
-    if (index < block_sizes[b])
-      break;
-    index -= block_sizes[b];
-    ++b;
+    const Tint d = numbering.order[i];
+    result.extents[d] = numbering.extents[i];
+    result.strides[d] = numbering.strides[i];
   }
+  return result;
+}
 
+template <int n, int k, typename Bint, typename Sint, typename Tint>
+Element<n, k, Sint, Tint> Lexicographic<n, k, Bint, Sint, Tint>::operator[](Bint index) const
+{
+  TPCC_INSTRUMENT_SCOPE(lexicographic_access, n, k);
+  // The block is found by bisection, since there are up to 252 blocks for n=10
+  const unsigned int b = std::upper_bound(block_offsets.begin() + 1, block_offsets.end(), index) -
+                         block_offsets.begin() - 1;
   if (b == block_sizes.size())
     throw(b);
+  index -= block_offsets[b];
 
-  Combinations<n, k> combinations;
-  auto combination = combinations[b];
-
+  const BlockNumbering& numbering = numberings[b];
   std::array<Sint, n> coordinates;
-  for (int i = 0; i < k; ++i)
+  for (Tint i = 0; i < n; ++i)
   {
-    Sint fdim = dimensions[n - 1 - combination.in(i)];
-    coordinates[n - 1 - combination.in(i)] = index % fdim;
+    const Tint d = numbering.order[i];
+    const Sint fdim = numbering.extents[i];
+    const Sint x = index % fdim;
+    coordinates[d] = reversed[d] ? fdim - 1 - x : x;
     index /= fdim;
   }
-  for (int i = 0; i < n - k; ++i)
-  {
-    Sint fdim = 1 + dimensions[n - 1 - combination.out(i)];
-    coordinates[n - 1 - combination.out(i)] = index % fdim;
-    index /= fdim;
-  }
-  return Element<n, k, Sint, Tint>{ combination, coordinates };
+  return Element<n, k, Sint, Tint>{ Combination<n, k, Tint>(numbering.in, numbering.out),
+                                    coordinates };
 }
 
 template <int n, int k, typename Bint, typename Sint, typename Tint>
 Bint Lexicographic<n, k, Bint, Sint, Tint>::index(const value_type& e) const
 {
-  Bint ci = e.direction_index();
-  Bint result = 0;
-  for (unsigned int i = 0; i < ci; ++i)
-    result += block_sizes[i];
-
-  Bint factor = 1;
-  for (Tint i = 0; i < k; ++i)
+  TPCC_INSTRUMENT_SCOPE(lexicographic_index, n, k);
+  const Tint b = e.direction_index();
+  const BlockNumbering& numbering = numberings[b];
+  Bint result = block_offset(b);
+  for (Tint i = 0; i < n; ++i)
   {
-    Sint fdim = dimensions[e.along_direction(i)];
-    result += e.along_coordinate(i) * factor;
-    factor *= fdim;
-  }
-  for (unsigned int i = 0; i < n - k; ++i)
-  {
-    Tint fdim = 1 + dimensions[e.across_direction(i)];
-    result += e.across_coordinate(i) * factor;
-    factor *= fdim;
+    const Tint d = numbering.order[i];
+    const Sint fdim = numbering.extents[i];
+    // In periodic directions, the coordinate `fdim` is identified with zero
+    const Sint c = (i >= k && e[d] == fdim) ? 0 : e[d];
+    result += (reversed[d] ? fdim - 1 - c : c) * numbering.strides[i];
   }
   return result;
 }
 
+/**
+ * \brief Throw `std::invalid_argument` if `mesh` numbers a direction in reverse.
+ *
+ * Called by the classes named `name` which compute indices from the positions in the block
+ * layouts as if they were coordinates.
+ */
+template <int n, int k, typename Bint, typename Sint, typename Tint>
+constexpr void require_unreversed(const Lexicographic<n, k, Bint, Sint, Tint>& mesh,
+                                  const char* name)
+{
+  if (mesh.has_reversed_directions())
+    throw std::invalid_argument(std::string(name) + " does not support reversed directions");
+}
+
 } // namespace TPCC
 
 #endif
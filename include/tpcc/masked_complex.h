@@ -0,0 +1,309 @@
+#ifndef TPCC_MASKED_COMPLEX_H
+#define TPCC_MASKED_COMPLEX_H
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include <tpcc/cell_closure.h>
+
+namespace TPCC
+{
+/**
+ * \brief A bit vector with constant time rank and select.
+ *
+ * The bits are stored in 64-bit words. After all bits have been set, build() computes the
+ * number of set bits before each superblock of eight words and, for every 512th set bit, the
+ * superblock containing it. Then rank() adds at most eight population counts to a superblock
+ * entry, and select() searches the superblocks between two samples, which are few unless the
+ * set bits are very sparse, before selecting inside a word.
+ *
+ * Both auxiliary arrays hold one `Bint` per 512 bits, such that the whole structure uses
+ * little more than one bit per entry.
+ */
+template <typename Bint = unsigned int>
+class BitVector
+{
+public:
+  /// The number of bits in a superblock and the number of set bits between select samples
+  static constexpr Bint block_bits = 512;
+
+  /// Constructor for `size` bits, all zero
+  explicit BitVector(Bint size = 0)
+    : n_bits(size)
+    , words((std::size_t(size) + 63) / 64)
+  {
+  }
+
+  /// Constructor copying `bits` and calling build()
+  explicit BitVector(const std::vector<bool>& bits);
+
+  /// The number of bits
+  Bint size() const { return n_bits; }
+
+  /// Set the bit `i`, which invalidates the result of build()
+  void set(Bint i) { words[i / 64] |= std::uint64_t(1) << (i % 64); }
+
+  /// The bit `i`
+  bool operator[](Bint i) const { return (words[i / 64] >> (i % 64)) & 1; }
+
+  /// Compute the tables for rank() and select()
+  void build();
+
+  /// The number of set bits, available after build()
+  Bint count() const { return block_ranks.back(); }
+
+  /// The number of set bits before position `i`
+  Bint rank(Bint i) const
+  {
+    const std::size_t w = i / 64;
+    Bint result = block_ranks[w / 8];
+    for (std::size_t j = w & ~std::size_t(7); j < w; ++j)
+      result += __builtin_popcountll(words[j]);
+    const unsigned int bit = i % 64;
+    if (bit != 0)
+      result += __builtin_popcountll(words[w] << (64 - bit));
+    return result;
+  }
+
+  /// The position of the set bit with rank `r`, which must be less than count()
+  Bint select(Bint r) const;
+
+  /// Call `f(i)` for the position `i` of each set bit in ascending order
+  template <typename F>
+  void for_each(F f) const
+  {
+    for (std::size_t w = 0; w < words.size(); ++w)
+      for (std::uint64_t bits = words[w]; bits != 0; bits &= bits - 1)
+        f(Bint(w * 64 + __builtin_ctzll(bits)));
+  }
+
+  /// The memory used by the bit vector in bytes
+  std::size_t memory_consumption() const
+  {
+    return sizeof(*this) + words.capacity() * sizeof(std::uint64_t) +
+           (block_ranks.capacity() + samples.capacity()) * sizeof(Bint);
+  }
+
+private:
+  Bint n_bits;
+  std::vector<std::uint64_t> words;
+  /// The number of set bits before each superblock, and the total number
+  std::vector<Bint> block_ranks;
+  /// The superblock containing the set bit of rank `s*block_bits`, and the last superblock
+  std::vector<Bint> samples;
+};
+
+/**
+ * \brief The active `k`-cells of a Lexicographic complex with holes, numbered consecutively.
+ *
+ * A box with obstacles is described by a mask of its `n`-cells, numbered as in
+ * `Lexicographic<n,n>` with the same dimensions, periodic directions and direction order. A
+ * `k`-cell is active if it is a face of an active `n`-cell. Thus, the active cells of all
+ * dimensions form a subcomplex, and the facets of an active cell are active in boundary().
+ *
+ * The active cells are numbered in the order of their indices in the full complex. A
+ * BitVector over the full complex maps between both numberings, by rank() from full to
+ * compressed and by select() back, in constant time with about one bit per full cell. The
+ * mask of `n`-cells is shared between a complex and its boundary(), which derives the mask of
+ * its faces from it by CellClosure.
+ *
+ * Vectors of values on the active cells are converted to and from vectors on the full complex
+ * by compress() and expand().
+ */
+template <int n, int k, typename Bint = unsigned int, typename Sint = unsigned short,
+          typename Tint = unsigned char>
+class MaskedComplex
+{
+public:
+  typedef Lexicographic<n, k, Bint, Sint, Tint> complex_type;
+  typedef Element<n, k, Sint, Tint> value_type;
+
+  /// The index of inactive cells in the compressed numbering
+  static constexpr Bint invalid = std::numeric_limits<Bint>::max();
+
+  /**
+   * \brief Constructor for the `k`-cells of `full`, where `cell_mask[i]` states whether the
+   * `n`-cell with index `i` is active.
+   */
+  MaskedComplex(const complex_type& full, const std::vector<bool>& cell_mask)
+    : MaskedComplex(full, std::make_shared<const BitVector<Bint>>(cell_mask))
+  {
+  }
+
+  /// Constructor with a shared mask of `n`-cells, on which build() has been called
+  MaskedComplex(const complex_type& full, std::shared_ptr<const BitVector<Bint>> cell_mask);
+
+  /// The complex including inactive cells
+  const complex_type& full() const { return complex; }
+
+  /// The mask of the `k`-cells of full()
+  const BitVector<Bint>& mask() const { return active; }
+
+  /// The mask of the `n`-cells
+  const std::shared_ptr<const BitVector<Bint>>& cell_mask() const { return cells; }
+
+  /// The number of active cells
+  Bint size() const { return active.count(); }
+
+  /// Whether the cell with index `full_index` in full() is active
+  bool is_active(Bint full_index) const { return active[full_index]; }
+
+  /// The index of an active cell of full() in the compressed numbering, or #invalid
+  Bint compressed_index(Bint full_index) const
+  {
+    return active[full_index] ? active.rank(full_index) : invalid;
+  }
+
+  /// The index in full() of the active cell with index `index`
+  Bint full_index(Bint index) const { return active.select(index); }
+
+  /// The active cell with index `index`
+  value_type operator[](Bint index) const { return complex[full_index(index)]; }
+
+  /// The index of the cell `e`, or #invalid if it is not active
+  Bint index(const value_type& e) const { return compressed_index(complex.index(e)); }
+
+  /// The active `k-1`-cells, sharing the mask of `n`-cells
+  MaskedComplex<n, k - 1, Bint, Sint, Tint> boundary() const
+  {
+    return MaskedComplex<n, k - 1, Bint, Sint, Tint>(complex.boundary(), cells);
+  }
+
+  /// Copy the entries of active cells from `full_values` to `values`
+  template <typename Number>
+  void compress(const Number* full_values, Number* values) const
+  {
+    active.for_each([&](Bint i) { *values++ = full_values[i]; });
+  }
+
+  /// Copy `values` to the active cells of `full_values`, setting inactive cells to `fill`
+  template <typename Number>
+  void expand(const Number* values, Number* full_values, Number fill = Number(0)) const
+  {
+    std::fill(full_values, full_values + complex.size(), fill);
+    active.for_each([&](Bint i) { full_values[i] = *values++; });
+  }
+
+  /// The memory used by the masks in bytes
+  std::size_t memory_consumption() const
+  {
+    return sizeof(*this) + active.memory_consumption() - sizeof(active) +
+           cells->memory_consumption();
+  }
+
+private:
+  complex_type complex;
+  std::shared_ptr<const BitVector<Bint>> cells;
+  BitVector<Bint> active;
+};
+
+//----------------------------------------------------------------------//
+
+template <typename Bint>
+BitVector<Bint>::BitVector(const std::vector<bool>& bits)
+  : BitVector(bits.size())
+{
+  for (Bint i = 0; i < n_bits; ++i)
+    if (bits[i])
+      set(i);
+  build();
+}
+
+template <typename Bint>
+void BitVector<Bint>::build()
+{
+  const std::size_t n_blocks = (words.size() + 7) / 8;
+  block_ranks.assign(n_blocks + 1, 0);
+  samples.clear();
+  Bint total = 0;
+  for (std::size_t b = 0; b < n_blocks; ++b)
+  {
+    block_ranks[b] = total;
+    for (std::size_t w = 8 * b; w < std::min(words.size(), 8 * b + 8); ++w)
+    {
+      const unsigned int c = __builtin_popcountll(words[w]);
+      // The set bit with the next sampled rank is in this word
+      if ((total + c + block_bits - 1) / block_bits > (total + block_bits - 1) / block_bits)
+        samples.push_back(b);
+      total += c;
+    }
+  }
+  block_ranks[n_blocks] = total;
+  samples.push_back(n_blocks == 0 ? 0 : n_blocks - 1);
+}
+
+template <typename Bint>
+Bint BitVector<Bint>::select(Bint r) const
+{
+  assert(r < count());
+  // The last superblock with fewer than `r+1` set bits before it
+  const Bint s = r / block_bits;
+  const std::size_t b = std::upper_bound(block_ranks.begin() + samples[s],
+                                         block_ranks.begin() + samples[s + 1] + 1, r) -
+                        block_ranks.begin() - 1;
+  r -= block_ranks[b];
+  std::size_t w = 8 * b;
+  for (unsigned int c; r >= (c = __builtin_popcountll(words[w])); ++w)
+    r -= c;
+  const std::uint64_t bits = words[w];
+#if defined(__BMI2__)
+  return w * 64 + __builtin_ctzll(_pdep_u64(std::uint64_t(1) << r, bits));
+#else
+  const unsigned int low = __builtin_popcount(std::uint32_t(bits));
+  if (r < low)
+    return w * 64 + select_bit(std::uint32_t(bits), r);
+  return w * 64 + 32 + select_bit(std::uint32_t(bits >> 32), r - low);
+#endif
+}
+
+template <int n, int k, typename Bint, typename Sint, typename Tint>
+MaskedComplex<n, k, Bint, Sint, Tint>::MaskedComplex(
+  const complex_type& full, std::shared_ptr<const BitVector<Bint>> cell_mask)
+  : complex(full)
+  , cells(std::move(cell_mask))
+  , active(full.size())
+{
+  require_unreversed(full, "MaskedComplex");
+  std::array<Sint, n> dimensions;
+  std::array<bool, n> periodic;
+  for (Tint d = 0; d < n; ++d)
+  {
+    dimensions[d] = full.fiber_dimension(d);
+    periodic[d] = full.is_periodic(d);
+  }
+  const Lexicographic<n, n, Bint, Sint, Tint> n_cells(dimensions, periodic,
+                                                      full.direction_order());
+  assert(cells->size() == n_cells.size());
+  if constexpr (k == n)
+    active = *cells;
+  else
+  {
+    const CellClosure<n, Bint, Sint, Tint> closure(n_cells);
+    std::vector<unsigned int> faces;
+    for (unsigned int f = 0; f < closure.n_faces(); ++f)
+      if (closure.face_dimension(f) == k)
+        faces.push_back(f);
+
+    // Tables are filled for chunks of consecutive cells, which skips inactive ones cheaply
+    constexpr Bint chunk = 256;
+    std::vector<Bint> table(chunk * closure.n_faces());
+    for (Bint first = 0; first < n_cells.size(); first += chunk)
+    {
+      const Bint last = std::min<Bint>(first + chunk, n_cells.size());
+      if (cells->rank(last) == cells->rank(first))
+        continue;
+      closure.fill(first, last, table.data());
+      for (Bint i = first; i < last; ++i)
+        if ((*cells)[i])
+          for (unsigned int f : faces)
+            active.set(table[(i - first) * closure.n_faces() + f]);
+    }
+    active.build();
+  }
+}
+} // namespace TPCC
+
+#endif
@@ -0,0 +1,435 @@
+#ifndef TPCC_MULTI_PATCH_H
+#define TPCC_MULTI_PATCH_H
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include <tpcc/slab.h>
+
+namespace TPCC
+{
+/// A boundary face of a patch and the order of its cells, as in CutPlane
+template <int n, typename Tint = unsigned char>
+struct PatchFace
+{
+  unsigned int patch;
+  /// The face, `2d` for the lower and `2d+1` for the upper end in direction `d`
+  Tint face;
+  /// The directions of the patch in the order of the cut plane, fastest first
+  std::array<Tint, n - 1> directions;
+  /// Whether each of these directions runs backwards
+  std::array<bool, n - 1> reverse;
+};
+
+/// Two faces of patches whose cells are identified in the order of their cut planes
+template <int n, typename Tint = unsigned char>
+struct PatchInterface
+{
+  PatchFace<n, Tint> first;
+  PatchFace<n, Tint> second;
+};
+
+/**
+ * \brief The `k`-cells of several Lexicographic complexes glued along matching boundary faces,
+ * with a global numbering in which shared cells appear once.
+ *
+ * Each patch is a box with its own coordinate system. A PatchInterface identifies a PatchFace
+ * of one patch with a PatchFace of another one, and the same interfaces glue the complexes of
+ * all dimensions. Faces are numbered as facets in Element::facet(), such that
+ * face `2d` is the lower and face `2d+1` the upper boundary in direction `d`. On each side, the
+ * cells of the face are enumerated by a CutPlane with the directions and reversal given in the
+ * PatchFace, which must be chosen such that both sides enumerate the same cells in the same
+ * order, just as for exchanging data through Slab. Thus, the interface maps a cell on one side
+ * to the cell on the other side by permuting its directions and reflecting its coordinates.
+ * Along each run of the cut plane, this map is affine in the local indices, such that only
+ * the cells at the ends of runs and on the edges of a patch are followed through further
+ * interfaces.
+ *
+ * Identifications are transitive, such that cells on edges and corners where several patches
+ * meet are identified even if two of these patches share no interface. Each cell is owned by the
+ * first patch containing it, and within the patch by the one with the smallest local index. The
+ * global numbering consists of the cells owned by the first patch in their local order, then
+ * those owned by the second patch, and so on.
+ *
+ * Since shared cells only lie on the boundary of a patch, the global index of a cell owned by
+ * its patch is the offset of the patch plus the local index minus the number of shared cells
+ * before it. The shared cells of each patch are stored as runs of local indices with constant
+ * stride, each mapped to an arithmetic progression of global indices. These runs mostly stem
+ * from whole runs of the cut planes, such that their number is of the order of the number of
+ * lines in the interfaces. Both directions of the mapping search the runs by bisection and are
+ * otherwise arithmetic.
+ */
+template <int n, int k, typename Bint = unsigned int, typename Sint = unsigned short,
+          typename Tint = unsigned char>
+class MultiPatchComplex
+{
+public:
+  typedef Lexicographic<n, k, Bint, Sint, Tint> complex_type;
+  typedef typename BlockLayout<n, Bint, Sint, Tint>::difference_t difference_t;
+
+  typedef PatchFace<n, Tint> Face;
+  typedef PatchInterface<n, Tint> Interface;
+
+  /// Constructor gluing `patches` along `interfaces`
+  MultiPatchComplex(const std::vector<complex_type>& patches,
+                    const std::vector<Interface>& interfaces);
+
+  /// The number of patches
+  unsigned int n_patches() const { return patches.size(); }
+
+  /// The patch with number `p`
+  const complex_type& patch(unsigned int p) const { return patches[p]; }
+
+  /// The interfaces along which the patches are glued
+  const std::vector<Interface>& interfaces() const { return glue; }
+
+  /// The number of cells, counting shared cells once
+  Bint size() const { return offsets.back(); }
+
+  /// The number of cells owned by patch `p`, with global indices starting at offset(p)
+  Bint n_owned(unsigned int p) const { return offsets[p + 1] - offsets[p]; }
+
+  /// The global index of the first cell owned by patch `p`
+  Bint offset(unsigned int p) const { return offsets[p]; }
+
+  /// Whether the cell `local` of patch `p` is owned by this patch
+  bool is_owned(unsigned int p, Bint local) const { return find(p, local).second; }
+
+  /// The global index of the cell `local` of patch `p`
+  Bint global_index(unsigned int p, Bint local) const;
+
+  /// Write the global indices of all cells of patch `p` to `indices`
+  void global_indices(unsigned int p, Bint* indices) const;
+
+  /// The owning patch and the local index in it of the cell with global index `index`
+  std::pair<unsigned int, Bint> local_index(Bint index) const;
+
+  /// The complex of the `k-1`-cells of all patches glued along the same interfaces
+  MultiPatchComplex<n, k - 1, Bint, Sint, Tint> boundary() const
+  {
+    std::vector<Lexicographic<n, k - 1, Bint, Sint, Tint>> result;
+    for (const auto& p : patches)
+      result.push_back(p.boundary());
+    return MultiPatchComplex<n, k - 1, Bint, Sint, Tint>(result, glue);
+  }
+
+  /// The number of runs of shared cells in patch `p`
+  std::size_t n_shared_runs(unsigned int p) const { return shared[p].size(); }
+
+  /// The memory used by the mapping in bytes
+  std::size_t memory_consumption() const;
+
+private:
+  /// A run of shared cells of a patch and their global indices
+  struct Run
+  {
+    Bint first;
+    Bint count;
+    Bint stride;
+    Bint global;
+    difference_t global_stride;
+    /// The number of shared cells in the patch before this run
+    Bint before;
+
+    constexpr Bint last() const { return first + (count - 1) * stride; }
+  };
+
+  /**
+   * \brief The number of shared cells of patch `p` before `local`, and whether `local` is owned.
+   *
+   * If it is shared, the first value is the global index instead.
+   */
+  std::pair<Bint, bool> find(unsigned int p, Bint local) const;
+
+  /// Call `f(local, count, stride)` for the runs of CutPlane::for_each_run() on the interface
+  /// side `face`, where `local` is the index of the first cell of the run in its patch
+  template <class F>
+  void for_each_run(const Face& face, F f) const;
+
+  /**
+   * \brief The cell on the side `to` of an interface identified with the cell `e` on the side
+   * `from`, or `false` if `e` is not in the face of `from`.
+   *
+   * The direction `from.directions[j]` of `e` becomes the direction `to.directions[j]` of the
+   * result, and the coordinate is reflected if exactly one of the two sides is reversed. The
+   * coordinate in the normal direction of `to` is the position of its face.
+   */
+  std::pair<Element<n, k, Sint, Tint>, bool> partner(const Face& from, const Face& to,
+                                                     const Element<n, k, Sint, Tint>& e) const;
+
+  std::vector<complex_type> patches;
+  std::vector<Interface> glue;
+  /// The first global index owned by each patch, and the total number
+  std::vector<Bint> offsets;
+  /// The shared cells of each patch, sorted by their local indices
+  std::vector<std::vector<Run>> shared;
+};
+
+//----------------------------------------------------------------------//
+
+template <int n, int k, typename Bint, typename Sint, typename Tint>
+template <class F>
+void MultiPatchComplex<n, k, Bint, Sint, Tint>::for_each_run(const Face& face, F f) const
+{
+  const complex_type& mesh = patches[face.patch];
+  const Tint d = face.face / 2;
+  assert(!mesh.is_periodic(d));
+  const CutPlane<n, k, Bint, Sint, Tint> plane(mesh, face.directions, face.reverse, d,
+                                               (face.face % 2) ? mesh.fiber_dimension(d) : 0);
+  plane.for_each_run(
+    [&](Bint, Bint index, Bint count, difference_t stride) { f(index, count, stride); });
+}
+
+template <int n, int k, typename Bint, typename Sint, typename Tint>
+std::pair<Element<n, k, Sint, Tint>, bool> MultiPatchComplex<n, k, Bint, Sint, Tint>::partner(
+  const Face& from, const Face& to, const Element<n, k, Sint, Tint>& e) const
+{
+  const complex_type& source = patches[from.patch];
+  const complex_type& target = patches[to.patch];
+  std::array<bool, n> along{};
+  for (Tint i = 0; i < k; ++i)
+    along[e.along_direction(i)] = true;
+
+  const Tint d = from.face / 2;
+  if (along[d] || e[d] != ((from.face % 2) ? source.fiber_dimension(d) : 0))
+    return { e, false };
+
+  std::array<bool, n> result_along{};
+  std::array<Sint, n> coordinates{};
+  const Tint normal = to.face / 2;
+  coordinates[normal] = (to.face % 2) ? target.fiber_dimension(normal) : 0;
+  for (Tint j = 0; j < n - 1; ++j)
+  {
+    const Tint a = from.directions[j];
+    const Tint b = to.directions[j];
+    assert(source.fiber_dimension(a) == target.fiber_dimension(b));
+    result_along[b] = along[a];
+    coordinates[b] =
+      reflect_coordinate<Sint>(target.fiber_dimension(b), target.is_periodic(b),
+                               from.reverse[j] != to.reverse[j], along[a], e[a]);
+  }
+  return { Element<n, k, Sint, Tint>{ orientation_along<n, k, Tint>(result_along), coordinates },
+           true };
+}
+
+template <int n, int k, typename Bint, typename Sint, typename Tint>
+MultiPatchComplex<n, k, Bint, Sint, Tint>::MultiPatchComplex(
+  const std::vector<complex_type>& patches, const std::vector<Interface>& interfaces)
+  : patches(patches)
+  , glue(interfaces)
+  , offsets(patches.size() + 1)
+  , shared(patches.size())
+{
+  typedef std::pair<unsigned int, Bint> Cell;
+  typedef Element<n, k, Sint, Tint> element_type;
+
+  // The interface sides on each patch, with the side they are glued to
+  std::vector<std::vector<std::pair<Face, Face>>> sides(patches.size());
+  for (const Interface& interface : glue)
+  {
+    sides[interface.first.patch].emplace_back(interface.first, interface.second);
+    sides[interface.second.patch].emplace_back(interface.second, interface.first);
+  }
+
+  // Whether `e` lies in more than one boundary face of patch `p`, glued or not
+  auto on_edge = [&](unsigned int p, const element_type& e) {
+    std::array<bool, n> along{};
+    for (Tint i = 0; i < k; ++i)
+      along[e.along_direction(i)] = true;
+    unsigned int faces = 0;
+    for (Tint d = 0; d < n; ++d)
+      if (!along[d] && !patches[p].is_periodic(d) &&
+          (e[d] == 0 || e[d] == patches[p].fiber_dimension(d)))
+        ++faces;
+    return faces > 1;
+  };
+
+  // The smallest cell reached from cell `local` of patch `p` by mapping through the interfaces.
+  // Since only a few faces meet at a cell, the lists stay short.
+  std::vector<std::pair<unsigned int, element_type>> stack;
+  std::vector<Cell> visited;
+  auto owner = [&](unsigned int p, Bint local) {
+    stack.assign(1, { p, this->patches[p][local] });
+    visited.assign(1, { p, local });
+    Cell result(p, local);
+    while (!stack.empty())
+    {
+      const auto current = stack.back();
+      stack.pop_back();
+      for (const auto& side : sides[current.first])
+      {
+        const auto mapped = partner(side.first, side.second, current.second);
+        if (!mapped.second)
+          continue;
+        const unsigned int q = side.second.patch;
+        const Cell cell(q, this->patches[q].index(mapped.first));
+        if (std::find(visited.begin(), visited.end(), cell) != visited.end())
+          continue;
+        visited.push_back(cell);
+        stack.emplace_back(q, mapped.first);
+        result = std::min(result, cell);
+      }
+    }
+    return result;
+  };
+
+  // The shared cells of the current patch with their owners
+  std::vector<std::pair<Bint, Cell>> cells;
+  for (unsigned int p = 0; p < patches.size(); ++p)
+  {
+    cells.clear();
+    // The n-cells are not contained in any face
+    if constexpr (k < n)
+      for (const auto& side : sides[p])
+      {
+        const unsigned int q = side.second.patch;
+        for_each_run(side.first, [&](Bint local, Bint count, difference_t stride) {
+          auto add = [&](Bint x, const Cell& cell) {
+            if (cell != Cell(p, x))
+              cells.emplace_back(x, cell);
+          };
+          // Inside the face, a cell is only identified with its partner, which moves by a
+          // constant stride along the run. Cells at the ends of the run and on edges of the
+          // patch may be shared with further patches.
+          const Bint middle = local + (count / 2) * stride;
+          if (count < 4 || on_edge(p, this->patches[p][middle]))
+          {
+            for (Bint i = 0; i < count; ++i)
+              add(local + i * stride, owner(p, local + i * stride));
+            return;
+          }
+          add(local, owner(p, local));
+          add(local + (count - 1) * stride, owner(p, local + (count - 1) * stride));
+          auto partner_index = [&](Bint x) {
+            const auto mapped = partner(side.first, side.second, this->patches[p][x]);
+            return this->patches[q].index(mapped.first);
+          };
+          const Bint first = partner_index(local + stride);
+          const difference_t partner_stride =
+            difference_t(partner_index(local + 2 * stride)) - difference_t(first);
+          for (Bint i = 1; i + 1 < count; ++i)
+          {
+            const Bint x = local + i * stride;
+            add(x, std::min(Cell(p, x), Cell(q, first + difference_t(i - 1) * partner_stride)));
+          }
+        });
+      }
+    std::sort(cells.begin(), cells.end());
+    cells.erase(std::unique(cells.begin(), cells.end()), cells.end());
+
+    // Owners come first, so their global indices are known
+    std::vector<Run>& runs = shared[p];
+    Bint before = 0;
+    for (const auto& entry : cells)
+    {
+      const Bint local = entry.first;
+      const Bint global = global_index(entry.second.first, entry.second.second);
+      ++before;
+      if (!runs.empty())
+      {
+        Run& run = runs.back();
+        if (run.count == 1)
+        {
+          run.stride = local - run.first;
+          run.global_stride = difference_t(global) - difference_t(run.global);
+          ++run.count;
+          continue;
+        }
+        if (local == run.first + run.count * run.stride &&
+            difference_t(global) ==
+              difference_t(run.global) + difference_t(run.count) * run.global_stride)
+        {
+          ++run.count;
+          continue;
+        }
+      }
+      runs.push_back(Run{ local, 1, 1, global, 0, before - 1 });
+    }
+    offsets[p + 1] = offsets[p] + patches[p].size() - before;
+  }
+}
+
+template <int n, int k, typename Bint, typename Sint, typename Tint>
+std::pair<Bint, bool> MultiPatchComplex<n, k, Bint, Sint, Tint>::find(unsigned int p,
+                                                                      Bint local) const
+{
+  const std::vector<Run>& runs = shared[p];
+  auto it = std::upper_bound(runs.begin(), runs.end(), local,
+                             [](Bint i, const Run& run) { return i < run.first; });
+  if (it == runs.begin())
+    return { 0, true };
+  const Run& run = *--it;
+  const Bint distance = local - run.first;
+  if (local <= run.last() && distance % run.stride == 0)
+    return { Bint(difference_t(run.global) + difference_t(distance / run.stride) *
+                                                 run.global_stride),
+             false };
+  return { run.before + std::min(run.count, distance / run.stride + 1), true };
+}
+
+template <int n, int k, typename Bint, typename Sint, typename Tint>
+Bint MultiPatchComplex<n, k, Bint, Sint, Tint>::global_index(unsigned int p, Bint local) const
+{
+  const auto result = find(p, local);
+  if (!result.second)
+    return result.first;
+  return offsets[p] + local - result.first;
+}
+
+template <int n, int k, typename Bint, typename Sint, typename Tint>
+void MultiPatchComplex<n, k, Bint, Sint, Tint>::global_indices(unsigned int p,
+                                                               Bint* indices) const
+{
+  Bint global = offsets[p];
+  Bint local = 0;
+  for (const Run& run : shared[p])
+  {
+    Bint position = run.first;
+    difference_t value = run.global;
+    for (Bint i = 0; i < run.count; ++i, position += run.stride, value += run.global_stride)
+    {
+      for (; local < position; ++local)
+        indices[local] = global++;
+      indices[local++] = value;
+    }
+  }
+  for (; local < patches[p].size(); ++local)
+    indices[local] = global++;
+}
+
+template <int n, int k, typename Bint, typename Sint, typename Tint>
+std::pair<unsigned int, Bint> MultiPatchComplex<n, k, Bint, Sint, Tint>::local_index(
+  Bint index) const
+{
+  const unsigned int p =
+    std::upper_bound(offsets.begin(), offsets.end(), index) - offsets.begin() - 1;
+  const Bint rank = index - offsets[p];
+  // The last run with at most `rank` owned cells before it
+  const std::vector<Run>& runs = shared[p];
+  auto it = std::partition_point(runs.begin(), runs.end(), [&](const Run& run) {
+    return run.first - run.before <= rank;
+  });
+  if (it == runs.begin())
+    return { p, rank };
+  const Run& run = *--it;
+  // The owned cells between the cells of the run are `stride-1` at a time
+  Bint m = run.count;
+  if (run.stride > 1)
+    m = std::min(run.count, (rank + run.before - run.first) / (run.stride - 1) + 1);
+  return { p, rank + run.before + m };
+}
+
+template <int n, int k, typename Bint, typename Sint, typename Tint>
+std::size_t MultiPatchComplex<n, k, Bint, Sint, Tint>::memory_consumption() const
+{
+  std::size_t result = sizeof(*this) + patches.capacity() * sizeof(complex_type) +
+                       glue.capacity() * sizeof(Interface) + offsets.capacity() * sizeof(Bint) +
+                       shared.capacity() * sizeof(std::vector<Run>);
+  for (const auto& runs : shared)
+    result += runs.capacity() * sizeof(Run);
+  return result;
+}
+} // namespace TPCC
+
+#endif
@@ -0,0 +1,201 @@
+#ifndef TPCC_PATCHES_H
+#define TPCC_PATCHES_H
+
+#include <algorithm>
+#include <vector>
+
+#include <tpcc/lexicographic.h>
+
+namespace TPCC
+{
+/**
+ * \brief Index lists of several patches in compressed row storage.
+ */
+template <typename Bint = unsigned int>
+struct PatchList
+{
+  /// The indices of patch `i` are at positions `offsets[i]` to `offsets[i+1]-1`
+  std::vector<Bint> offsets;
+  /// The indices of all patches, concatenated
+  std::vector<Bint> indices;
+
+  /// The number of patches
+  std::size_t size() const { return offsets.size() - 1; }
+
+  /// The first index of patch `i`
+  const Bint* begin(std::size_t i) const { return indices.data() + offsets[i]; }
+
+  /// The end of the indices of patch `i`
+  const Bint* end(std::size_t i) const { return indices.data() + offsets[i + 1]; }
+};
+
+/**
+ * \brief The `k`-cells in the star of each vertex of a Lexicographic complex.
+ *
+ * The closed star of a vertex consists of the up to `2^n` cells of dimension `n` containing the
+ * vertex and all their faces. Thus, in an orientation block, a cell belongs to the closed star
+ * of the vertex `v` if its coordinate is `v[d]-1` or `v[d]` in each direction along the cell
+ * and `v[d]-1`, `v[d]` or `v[d]+1` in each direction across. The open star, which is the
+ * interior of the patch, only consists of the cells containing the vertex, with the coordinate
+ * `v[d]` across.
+ *
+ * These conditions describe a small box in each orientation block, such that the indices of
+ * the cells are computed arithmetically from the strides of the block, without decoding any
+ * cell. Vertices are numbered as in `Lexicographic<n,0>` with the same dimensions, periodic
+ * directions and direction order as the complex. The indices in each patch are in ascending
+ * order.
+ *
+ * Since the patches of neighboring vertices overlap, a smoother visiting all patches repeatedly
+ * should compute the index lists once by patches() and keep the resulting PatchList.
+ */
+template <int n, int k, typename Bint = unsigned int, typename Sint = unsigned short,
+          typename Tint = unsigned char>
+class VertexPatches
+{
+public:
+  typedef Lexicographic<n, k, Bint, Sint, Tint> complex_type;
+
+  /**
+   * \brief Constructor for the cells of `mesh`.
+   *
+   * \param closed: Whether to use the closed star, otherwise the open star.
+   */
+  VertexPatches(const complex_type& mesh, bool closed = true);
+
+  /// The number of vertices, thus of patches
+  Bint n_vertices() const { return vertex_layout.size(); }
+
+  /// The largest number of cells in a patch, attained at interior vertices
+  Bint max_patch_size() const;
+
+  /// Append the indices of the cells in the patch of `vertex` to `indices`
+  void patch(Bint vertex, std::vector<Bint>& indices) const;
+
+  /// The patches of the vertices `first` to `last-1`
+  PatchList<Bint> patches(Bint first, Bint last) const;
+
+  /// The patches of all vertices
+  PatchList<Bint> patches() const { return patches(0, n_vertices()); }
+
+private:
+  std::array<BlockLayout<n, Bint, Sint, Tint>, binomial(n, k)> layouts;
+  /// The layout of the vertices, used to decode the coordinates of a vertex
+  BlockLayout<n, Bint, Sint, Tint> vertex_layout;
+  std::array<bool, n> periodic;
+  bool closed;
+};
+
+//----------------------------------------------------------------------//
+
+template <int n, int k, typename Bint, typename Sint, typename Tint>
+VertexPatches<n, k, Bint, Sint, Tint>::VertexPatches(const complex_type& mesh, bool closed)
+  : closed(closed)
+{
+  require_unreversed(mesh, "VertexPatches");
+  std::array<Sint, n> dimensions;
+  for (Tint d = 0; d < n; ++d)
+  {
+    dimensions[d] = mesh.fiber_dimension(d);
+    periodic[d] = mesh.is_periodic(d);
+  }
+  for (Tint b = 0; b < mesh.n_blocks(); ++b)
+    layouts[b] = mesh.block_layout(b);
+  vertex_layout =
+    Lexicographic<n, 0, Bint, Sint, Tint>(dimensions, periodic, mesh.direction_order())
+      .block_layout(0);
+}
+
+template <int n, int k, typename Bint, typename Sint, typename Tint>
+Bint VertexPatches<n, k, Bint, Sint, Tint>::max_patch_size() const
+{
+  Bint result = 1;
+  for (Tint i = 0; i < k; ++i)
+    result *= 2;
+  if (closed)
+    for (Tint i = k; i < n; ++i)
+      result *= 3;
+  return result * binomial(n, k);
+}
+
+template <int n, int k, typename Bint, typename Sint, typename Tint>
+void VertexPatches<n, k, Bint, Sint, Tint>::patch(Bint vertex, std::vector<Bint>& indices) const
+{
+  std::array<Sint, n> v;
+  for (Tint i = 0; i < n; ++i)
+  {
+    const Tint d = vertex_layout.order[i];
+    v[d] = vertex % vertex_layout.extents[d];
+    vertex /= vertex_layout.extents[d];
+  }
+
+  for (const auto& layout : layouts)
+  {
+    // The admissible coordinates in each direction, in ascending order
+    std::array<std::array<Sint, 3>, n> positions;
+    std::array<Tint, n> counts{};
+    for (Tint i = 0; i < n; ++i)
+    {
+      const Tint d = layout.order[i];
+      const int extent = layout.extents[d];
+      const int last = (i < k) ? 0 : (closed ? 1 : 0);
+      for (int o = -1 + ((i < k || closed) ? 0 : 1); o <= last; ++o)
+      {
+        int x = int(v[d]) + o;
+        if (periodic[d])
+          x = (x + extent) % extent;
+        else if (x < 0 || x >= extent)
+          continue;
+        if (std::find(positions[d].begin(), positions[d].begin() + counts[d], x) ==
+            positions[d].begin() + counts[d])
+          positions[d][counts[d]++] = x;
+      }
+      if (counts[d] == 0)
+        break;
+      std::sort(positions[d].begin(), positions[d].begin() + counts[d]);
+    }
+
+    // Loop over the box, first direction fastest
+    bool empty = false;
+    for (Tint d = 0; d < n; ++d)
+      empty = empty || counts[d] == 0;
+    if (empty)
+      continue;
+    std::array<Tint, n> j{};
+    for (;;)
+    {
+      Bint index = layout.offset;
+      for (Tint d = 0; d < n; ++d)
+        index += positions[d][j[d]] * layout.strides[d];
+      indices.push_back(index);
+
+      Tint i = 0;
+      for (; i < n; ++i)
+      {
+        const Tint d = layout.order[i];
+        if (++j[d] < counts[d])
+          break;
+        j[d] = 0;
+      }
+      if (i == n)
+        break;
+    }
+  }
+}
+
+template <int n, int k, typename Bint, typename Sint, typename Tint>
+PatchList<Bint> VertexPatches<n, k, Bint, Sint, Tint>::patches(Bint first, Bint last) const
+{
+  PatchList<Bint> result;
+  result.offsets.reserve(last - first + 1);
+  result.indices.reserve((last - first) * max_patch_size());
+  result.offsets.push_back(0);
+  for (Bint vertex = first; vertex < last; ++vertex)
+  {
+    patch(vertex, result.indices);
+    result.offsets.push_back(result.indices.size());
+  }
+  return result;
+}
+} // namespace TPCC
+
+#endif
@@ -0,0 +1,270 @@
+#ifndef TPCC_PIPELINE_H
+#define TPCC_PIPELINE_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include <tpcc/lexicographic.h>
+
+namespace TPCC
+{
+/**
+ * \brief A bounded lock-free queue for multiple producers and consumers.
+ *
+ * This is the ring buffer with per-slot sequence numbers due to D. Vyukov. Each slot carries a
+ * counter telling whether it is ready for writing or for reading in the current round, such that
+ * producers and consumers only synchronize through atomic compare-and-swap on the two positions.
+ *
+ * \tparam T: The type of values, which should be cheap to copy, like an index.
+ */
+template <typename T>
+class BoundedQueue
+{
+  struct Slot
+  {
+    std::atomic<std::size_t> sequence;
+    T value;
+  };
+
+  std::vector<Slot> slots;
+  std::size_t mask;
+  alignas(64) std::atomic<std::size_t> write_position;
+  alignas(64) std::atomic<std::size_t> read_position;
+
+public:
+  /// Constructor with the capacity, which is rounded up to a power of two
+  explicit BoundedQueue(std::size_t capacity)
+    : write_position(0)
+    , read_position(0)
+  {
+    std::size_t size = 1;
+    while (size < capacity)
+      size *= 2;
+    slots = std::vector<Slot>(size);
+    mask = size - 1;
+    for (std::size_t i = 0; i < size; ++i)
+      slots[i].sequence.store(i, std::memory_order_relaxed);
+  }
+
+  /// Try to add a value. Returns `false` if the queue is full.
+  bool try_push(const T& value)
+  {
+    std::size_t pos = write_position.load(std::memory_order_relaxed);
+    for (;;)
+    {
+      Slot& slot = slots[pos & mask];
+      const std::size_t seq = slot.sequence.load(std::memory_order_acquire);
+      const std::ptrdiff_t diff = std::ptrdiff_t(seq) - std::ptrdiff_t(pos);
+      if (diff == 0)
+      {
+        if (write_position.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+        {
+          slot.value = value;
+          slot.sequence.store(pos + 1, std::memory_order_release);
+          return true;
+        }
+      }
+      else if (diff < 0)
+        return false;
+      else
+        pos = write_position.load(std::memory_order_relaxed);
+    }
+  }
+
+  /// Try to remove a value. Returns `false` if the queue is empty.
+  bool try_pop(T& value)
+  {
+    std::size_t pos = read_position.load(std::memory_order_relaxed);
+    for (;;)
+    {
+      Slot& slot = slots[pos & mask];
+      const std::size_t seq = slot.sequence.load(std::memory_order_acquire);
+      const std::ptrdiff_t diff = std::ptrdiff_t(seq) - std::ptrdiff_t(pos + 1);
+      if (diff == 0)
+      {
+        if (read_position.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+        {
+          value = slot.value;
+          slot.sequence.store(pos + mask + 1, std::memory_order_release);
+          return true;
+        }
+      }
+      else if (diff < 0)
+        return false;
+      else
+        pos = read_position.load(std::memory_order_relaxed);
+    }
+  }
+
+  /// Add a value, yielding while the queue is full
+  void push(const T& value)
+  {
+    while (!try_push(value))
+      std::this_thread::yield();
+  }
+
+  /// Remove a value, yielding while the queue is empty
+  T pop()
+  {
+    T value;
+    while (!try_pop(value))
+      std::this_thread::yield();
+    return value;
+  }
+};
+
+/**
+ * \brief A batch of consecutive elements decoded by the producer of pipeline_for_each().
+ */
+template <class MESH>
+struct ElementBatch
+{
+  typedef typename std::decay<decltype(std::declval<MESH>()[0])>::type value_type;
+  typedef decltype(std::declval<MESH>().size()) index_type;
+
+  /// The index of the first element in the batch
+  index_type first;
+  /// The decoded elements with indices `first` to `first+elements.size()-1`
+  std::vector<value_type> elements;
+  /**
+   * \brief The indices of the facets in the boundary complex, `2k` for each element.
+   *
+   * Only filled if requested and if the set of elements has a `boundary()`.
+   */
+  std::vector<index_type> facets;
+};
+
+/**
+ * \brief Parameters of pipeline_for_each().
+ */
+struct PipelineOptions
+{
+  /// The number of elements decoded into one batch
+  std::size_t batch_size = 256;
+  /// The number of worker threads, zero for the number of hardware threads minus one
+  unsigned int n_workers = 0;
+  /**
+   * \brief The number of batches in flight.
+   *
+   * If all batches are in use, the producer waits for a worker to finish one.
+   */
+  std::size_t n_batches = 0;
+  /// Compute the indices of facets in each batch
+  bool facets = false;
+};
+
+/// Detection whether a set of elements has a boundary
+template <class MESH, typename = void>
+struct has_boundary : std::false_type
+{
+};
+
+template <class MESH>
+struct has_boundary<MESH, std::void_t<decltype(std::declval<MESH>().boundary())>>
+  : std::true_type
+{
+};
+
+/// The type of the boundary of a set of elements, or `std::nullptr_t` if it has none
+template <class MESH, typename = void>
+struct boundary_type
+{
+  typedef std::nullptr_t type;
+};
+
+template <class MESH>
+struct boundary_type<MESH, std::void_t<decltype(std::declval<MESH>().boundary())>>
+{
+  typedef typename std::decay<decltype(std::declval<MESH>().boundary())>::type type;
+};
+
+/**
+ * \brief Decode the elements of `mesh` in batches and let worker threads process them.
+ *
+ * The calling thread acts as the producer: it decodes consecutive elements of `mesh` into
+ * batches of `options.batch_size` elements and hands them to `options.n_workers` worker threads
+ * through a BoundedQueue. Each worker calls `worker(batch)` with a `const ElementBatch<MESH>&`
+ * and returns the batch to the producer for reuse. Since only `options.n_batches` batches exist,
+ * the producer cannot run ahead of the workers, and the batches stay small enough to remain in
+ * cache.
+ *
+ * Batches are processed in arbitrary order and concurrently, thus `worker` must be thread safe.
+ *
+ * \param mesh: A set of elements like Lexicographic or Slab providing `size()` and `operator[]`.
+ * \param worker: A function object called for each batch.
+ * \param options: Batch size, number of threads and batches in flight.
+ */
+template <class MESH, class WORKER>
+void pipeline_for_each(const MESH& mesh, WORKER worker, PipelineOptions options = PipelineOptions())
+{
+  typedef ElementBatch<MESH> batch_type;
+  typedef typename batch_type::index_type index_type;
+
+  // hardware_concurrency() may return zero if unknown
+  if (options.n_workers == 0)
+    options.n_workers = std::max(2u, std::thread::hardware_concurrency()) - 1;
+  if (options.n_batches == 0)
+    options.n_batches = 2 * options.n_workers + 2;
+
+  std::vector<batch_type> batches(options.n_batches);
+  for (auto& batch : batches)
+    batch.elements.reserve(options.batch_size);
+
+  // Batch numbers handed out to workers and returned by them. The number -1 terminates a worker.
+  BoundedQueue<std::ptrdiff_t> full(options.n_batches + options.n_workers);
+  BoundedQueue<std::ptrdiff_t> empty(options.n_batches);
+  for (std::size_t b = 0; b < options.n_batches; ++b)
+    empty.push(b);
+
+  // The boundary complex is set up once and shared by all batches
+  constexpr bool with_facets =
+    has_boundary<MESH>::value && batch_type::value_type::n_facets() > 0;
+  typedef typename boundary_type<MESH>::type boundary_complex;
+  std::optional<typename std::conditional<with_facets, boundary_complex, std::nullptr_t>::type>
+    boundary;
+  if constexpr (with_facets)
+    if (options.facets)
+      boundary.emplace(mesh.boundary());
+
+  std::vector<std::thread> threads;
+  for (unsigned int t = 0; t < options.n_workers; ++t)
+    threads.emplace_back([&]() {
+      for (std::ptrdiff_t b = full.pop(); b >= 0; b = full.pop())
+      {
+        worker(static_cast<const batch_type&>(batches[b]));
+        empty.push(b);
+      }
+    });
+
+  const index_type size = mesh.size();
+  for (index_type first = 0; first < size; first += options.batch_size)
+  {
+    const std::ptrdiff_t b = empty.pop();
+    batch_type& batch = batches[b];
+    const index_type last = std::min<index_type>(size, first + options.batch_size);
+    batch.first = first;
+    batch.elements.clear();
+    batch.facets.clear();
+    for (index_type i = first; i < last; ++i)
+      batch.elements.push_back(mesh[i]);
+    if constexpr (with_facets)
+      if (boundary)
+        for (const auto& e : batch.elements)
+          for (unsigned int f = 0; f < e.n_facets(); ++f)
+            batch.facets.push_back(boundary->index(e.facet(f)));
+    full.push(b);
+  }
+
+  for (unsigned int t = 0; t < options.n_workers; ++t)
+    full.push(-1);
+  for (auto& thread : threads)
+    thread.join();
+}
+} // namespace TPCC
+
+#endif
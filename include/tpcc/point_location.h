@@ -0,0 +1,234 @@
+#ifndef TPCC_POINT_LOCATION_H
+#define TPCC_POINT_LOCATION_H
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <thread>
+#include <vector>
+
+#include <tpcc/cell_closure.h>
+
+namespace TPCC
+{
+/**
+ * \brief Batched location of points in the `n`-cells of a tensor product grid.
+ *
+ * The grid is given by the coordinates of its nodes in each direction, `fiber_dimension(d)+1`
+ * increasing values, or by an origin and a uniform spacing. A point belongs to the cell with
+ * coordinate `c` in direction `d` if `nodes[d][c] <= x[d] < nodes[d][c+1]`, where the last node
+ * belongs to the last cell. In periodic directions, coordinates are first shifted into the
+ * period between the first and the last node. Points outside the grid in a non-periodic
+ * direction and points with a non-finite coordinate are marked by the cell index #invalid.
+ *
+ * Besides the index of the cell in the Lexicographic numbering, locate() returns the local
+ * coordinates of the point in the reference cell `[0,1]^n` and the indices of all `3^n` faces of
+ * the cell as computed by CellClosure.
+ *
+ * Points are processed in batches, looping over the points of a batch for one direction at a
+ * time. For uniform directions, the loop body is a few arithmetic operations without branches,
+ * which the compiler vectorizes. In directions with non-uniform nodes, the cell is found by a
+ * bisection without branches, which avoids mispredictions for random points. Batches are
+ * distributed between `n_threads` threads.
+ */
+template <int n, typename Number = double, typename Bint = unsigned int,
+          typename Sint = unsigned short, typename Tint = unsigned char>
+class PointLocator
+{
+public:
+  typedef Lexicographic<n, n, Bint, Sint, Tint> complex_type;
+
+  /// The cell index of points outside the grid
+  static constexpr Bint invalid = std::numeric_limits<Bint>::max();
+
+  /// The number of points processed together in one direction
+  static constexpr std::size_t batch_size = 256;
+
+  /// Constructor for the `n`-cells `cells` with the coordinates `nodes` of the nodes
+  PointLocator(const complex_type& cells,
+               const std::array<std::vector<Number>, std::size_t(n)>& nodes);
+
+  /// Constructor for the `n`-cells `cells` with uniform spacing in each direction
+  PointLocator(const complex_type& cells, const std::array<Number, std::size_t(n)>& origin,
+               const std::array<Number, std::size_t(n)>& spacing);
+
+  /// The number of faces of each cell written by locate()
+  static constexpr unsigned int n_faces() { return CellClosure<n, Bint, Sint, Tint>::n_faces(); }
+
+  /// Whether the nodes in direction `d` are uniformly spaced
+  bool is_uniform(Tint d) const { return uniform[d]; }
+
+  /**
+   * \brief Locate `n_points` points with coordinates `points[i*n+d]`.
+   *
+   * \param cells: The index of the cell of each point, or #invalid.
+   * \param local: If not null, the local coordinates of point `i` in its cell are written to
+   * `local[i*n+d]`.
+   * \param faces: If not null, the indices of the faces of the cell of point `i` are written to
+   * `faces[i*n_faces()+f]`, numbered as in CellClosure. They are #invalid for points outside.
+   */
+  void locate(std::size_t n_points, const Number* points, Bint* cells, Number* local = nullptr,
+              Bint* faces = nullptr, unsigned int n_threads = 1) const;
+
+private:
+  /// Locate the points `first` to `last-1`
+  void locate_range(std::size_t first, std::size_t last, const Number* points, Bint* cells,
+                    Number* local, Bint* faces) const;
+
+  /// Compute the strides and the periodicity from `cells`
+  void setup(const complex_type& cells);
+
+  std::array<std::vector<Number>, n> nodes;
+  std::array<bool, n> uniform;
+  std::array<bool, n> periodic;
+  std::array<Number, n> origin;
+  std::array<Number, n> inverse_spacing;
+  std::array<Sint, n> extents;
+  std::array<Bint, n> strides;
+  CellClosure<n, Bint, Sint, Tint> closure;
+};
+
+//----------------------------------------------------------------------//
+
+template <int n, typename Number, typename Bint, typename Sint, typename Tint>
+PointLocator<n, Number, Bint, Sint, Tint>::PointLocator(
+  const complex_type& cells, const std::array<std::vector<Number>, std::size_t(n)>& nodes)
+  : nodes(nodes)
+  , uniform{}
+  , closure(cells)
+{
+  setup(cells);
+  for (Tint d = 0; d < n; ++d)
+  {
+    assert(nodes[d].size() == std::size_t(extents[d]) + 1);
+    origin[d] = nodes[d].front();
+    inverse_spacing[d] = extents[d] / (nodes[d].back() - nodes[d].front());
+  }
+}
+
+template <int n, typename Number, typename Bint, typename Sint, typename Tint>
+PointLocator<n, Number, Bint, Sint, Tint>::PointLocator(
+  const complex_type& cells, const std::array<Number, std::size_t(n)>& origin,
+  const std::array<Number, std::size_t(n)>& spacing)
+  : origin(origin)
+  , closure(cells)
+{
+  setup(cells);
+  for (Tint d = 0; d < n; ++d)
+  {
+    uniform[d] = true;
+    inverse_spacing[d] = 1 / spacing[d];
+    for (Sint i = 0; i <= extents[d]; ++i)
+      nodes[d].push_back(origin[d] + i * spacing[d]);
+  }
+}
+
+template <int n, typename Number, typename Bint, typename Sint, typename Tint>
+void PointLocator<n, Number, Bint, Sint, Tint>::setup(const complex_type& cells)
+{
+  require_unreversed(cells, "PointLocator");
+  const auto layout = cells.block_layout(0);
+  extents = layout.extents;
+  strides = layout.strides;
+  for (Tint d = 0; d < n; ++d)
+    periodic[d] = cells.is_periodic(d);
+}
+
+template <int n, typename Number, typename Bint, typename Sint, typename Tint>
+void PointLocator<n, Number, Bint, Sint, Tint>::locate(std::size_t n_points, const Number* points,
+                                                       Bint* cells, Number* local, Bint* faces,
+                                                       unsigned int n_threads) const
+{
+  n_threads = std::max(1u, n_threads);
+  if (n_threads == 1 || n_points < 2 * n_threads * batch_size)
+  {
+    locate_range(0, n_points, points, cells, local, faces);
+    return;
+  }
+  std::vector<std::thread> threads;
+  for (unsigned int t = 0; t < n_threads; ++t)
+  {
+    const std::size_t first = n_points * t / n_threads;
+    const std::size_t last = n_points * (t + 1) / n_threads;
+    threads.emplace_back([=]() { locate_range(first, last, points, cells, local, faces); });
+  }
+  for (auto& thread : threads)
+    thread.join();
+}
+
+template <int n, typename Number, typename Bint, typename Sint, typename Tint>
+void PointLocator<n, Number, Bint, Sint, Tint>::locate_range(std::size_t first, std::size_t last,
+                                                             const Number* points, Bint* cells,
+                                                             Number* local, Bint* faces) const
+{
+  Number t[batch_size];
+  Bint index[batch_size];
+  unsigned char inside[batch_size];
+
+  for (std::size_t begin = first; begin < last; begin += batch_size)
+  {
+    const std::size_t length = std::min(batch_size, last - begin);
+    const Number* p = points + begin * n;
+    std::fill(index, index + length, Bint(0));
+    std::fill(inside, inside + length, 1);
+
+    for (Tint d = 0; d < n; ++d)
+    {
+      const Number extent = extents[d];
+      const Number x0 = origin[d];
+      const Number scale = inverse_spacing[d];
+      // The position in units of the average spacing, shifted into the period
+      for (std::size_t i = 0; i < length; ++i)
+        t[i] = (p[i * n + d] - x0) * scale;
+      if (periodic[d])
+        for (std::size_t i = 0; i < length; ++i)
+          t[i] -= std::floor(t[i] / extent) * extent;
+
+      if (uniform[d])
+        for (std::size_t i = 0; i < length; ++i)
+        {
+          // False for NaN, which non-finite coordinates become in periodic directions
+          inside[i] &= (t[i] >= 0) & (t[i] <= extent);
+          // Clamp such that NaN maps to zero, since converting it to Sint is undefined
+          const Number clamped = (t[i] > 0) ? std::min(t[i], extent - 1) : Number(0);
+          const Sint c = Sint(clamped);
+          index[i] += c * strides[d];
+          t[i] -= c;
+        }
+      else
+      {
+        const std::vector<Number>& x = nodes[d];
+        for (std::size_t i = 0; i < length; ++i)
+        {
+          const Number y = periodic[d] ? x0 + t[i] / scale : p[i * n + d];
+          inside[i] &= (y >= x.front()) & (y <= x.back());
+          // Branch-free bisection for the last node not greater than `y`
+          const Number* base = x.data();
+          for (std::size_t count = extents[d] + 1; count > 1; count -= count / 2)
+            base = (base[count / 2] <= y) ? base + count / 2 : base;
+          const std::size_t c = std::min<std::size_t>(base - x.data(), extents[d] - 1);
+          index[i] += c * strides[d];
+          t[i] = (y - x[c]) / (x[c + 1] - x[c]);
+        }
+      }
+      if (local != nullptr)
+        for (std::size_t i = 0; i < length; ++i)
+          local[(begin + i) * n + d] = t[i];
+    }
+
+    for (std::size_t i = 0; i < length; ++i)
+      cells[begin + i] = inside[i] ? index[i] : invalid;
+    if (faces != nullptr)
+      for (std::size_t i = 0; i < length; ++i)
+      {
+        Bint* target = faces + (begin + i) * n_faces();
+        if (inside[i])
+          closure.fill(index[i], index[i] + 1, target);
+        else
+          std::fill(target, target + n_faces(), invalid);
+      }
+  }
+}
+} // namespace TPCC
+
+#endif
@@ -7,6 +7,125 @@
 
 namespace TPCC
 {
+/// The orientation of the `k`-cells in an `n`-complex with given directions along them
+template <int n, int k, typename Tint>
+constexpr Combination<n, k, Tint> orientation_along(const std::array<bool, n>& along)
+{
+  std::array<Tint, k> in{};
+  std::array<Tint, n - k> out{};
+  Tint a = 0, c = 0;
+  for (Tint d = 0; d < n; ++d)
+  {
+    if (along[d])
+      in[a++] = n - 1 - d;
+    else
+      out[c++] = n - 1 - d;
+  }
+  return Combination<n, k, Tint>(in, out);
+}
+
+/**
+ * \brief The coordinate of a cell in a fiber with `fdim` cells, reflected if `reverse` is set.
+ *
+ * Reflecting counts cells along the fiber backwards from the last one and positions across it
+ * from the upper end. In a periodic fiber, the upper end is identified with zero. Reflecting
+ * twice yields the original coordinate.
+ */
+template <typename Sint>
+constexpr Sint reflect_coordinate(Sint fdim, bool periodic, bool reverse, bool along, Sint c)
+{
+  if (!reverse)
+    return c;
+  if (along)
+    return fdim - c - 1;
+  if (periodic && c == 0)
+    return 0;
+  return fdim - c;
+}
+
+/**
+ * \brief Call `f(local, global, count, stride)` for runs of the cells of a hyperplane in
+ * `superset`, enumerated by the `n-1`-dimensional complex `aux`.
+ *
+ * Direction `a` of `aux` is the direction `directions[a]` of `superset`, reflected if
+ * `reverse[a]` is set. The cells of `aux` have dimension `m`, and the cells of `superset` extend
+ * in the normal direction in addition if `m<k`, as in a Slab, or not if `m==k`, as in a
+ * CutPlane. The runs follow the fastest direction of each orientation block of `aux`: the cells
+ * with indices `local` to `local+count-1` in `aux` have the indices `global`, `global+stride`,
+ * and so on in `superset`. The stride is negative in reversed directions.
+ */
+template <int n, int k, int m, typename Bint, typename Sint, typename Tint, class F>
+void for_each_hyperplane_run(const Lexicographic<n, k, Bint, Sint, Tint>& superset,
+                             const Lexicographic<n - 1, m, Bint, Sint, Tint>& aux,
+                             const std::array<Tint, n - 1>& directions,
+                             const std::array<bool, n - 1>& reverse, Tint normal_direction,
+                             Sint normal_coordinate, F f)
+{
+  static_assert(m == k || m + 1 == k, "Cells of the hyperplane have the wrong dimension");
+  typedef typename BlockLayout<n, Bint, Sint, Tint>::difference_t difference_t;
+  auto coordinate = [&](Tint a, bool along, Sint c) {
+    const Tint d = directions[a];
+    return reflect_coordinate<Sint>(superset.fiber_dimension(d), superset.is_periodic(d),
+                                    reverse[a], along, c);
+  };
+  // In a periodic normal direction, the upper end is identified with zero
+  const Sint normal =
+    (m == k && normal_coordinate == superset.across_extent(normal_direction))
+      ? 0
+      : normal_coordinate;
+  for (Tint b = 0; b < aux.n_blocks(); ++b)
+  {
+    const auto local_layout = aux.block_layout(b);
+    std::array<bool, n> along{};
+    along[normal_direction] = (m < k);
+    for (Tint i = 0; i < m; ++i)
+      along[directions[local_layout.order[i]]] = true;
+    const auto global_layout =
+      superset.block_layout(Combinations<n, k>::index(orientation_along<n, k, Tint>(along)));
+    const Bint base = global_layout.offset + normal * global_layout.strides[normal_direction];
+
+    if constexpr (n == 1)
+      f(local_layout.offset, base, 1, 0);
+    else
+    {
+      // The fastest direction of the block forms the runs, the others are counted by `y`
+      const Tint a0 = local_layout.order[0];
+      const Bint count = local_layout.extents[a0];
+      const difference_t stride = global_layout.strides[directions[a0]];
+      // A reversed periodic direction across starts with zero and then counts down
+      const bool wrap = reverse[a0] && m == 0 && superset.is_periodic(directions[a0]);
+      std::array<Sint, n - 1> y{};
+      for (Bint local = local_layout.offset; local < local_layout.offset + local_layout.size();
+           local += count)
+      {
+        Bint global = base;
+        for (Tint i = 1; i < n - 1; ++i)
+        {
+          const Tint a = local_layout.order[i];
+          global += coordinate(a, i < m, y[a]) * global_layout.strides[directions[a]];
+        }
+        if (!reverse[a0])
+          f(local, global, count, stride);
+        else if (!wrap)
+          f(local, global + (count - 1) * stride, count, -stride);
+        else
+        {
+          f(local, global, 1, stride);
+          f(local + 1, global + (count - 1) * stride, count - 1, -stride);
+        }
+
+        for (Tint i = 1; i < n - 1; ++i)
+        {
+          const Tint a = local_layout.order[i];
+          if (++y[a] < local_layout.extents[a])
+            break;
+          y[a] = 0;
+        }
+      }
+    }
+  }
+}
+
 /**
  * \brief A slab of thickness one cell cut out of a tensor product chain complex
  *
@@ -44,6 +163,16 @@ class Slab
     return result;
   }
 
+  /// Compute the periodic directions of the auxiliary object
+  static constexpr std::array<bool, n - 1> aux_periodic(
+    const Lexicographic<n, k, Bint, Sint, Tint>& from, const std::array<Tint, n - 1>& directions)
+  {
+    std::array<bool, n - 1> result{};
+    for (Tint i = 0; i < n - 1; ++i)
+      result[i] = from.is_periodic(directions[i]);
+    return result;
+  }
+
   /**
    * \brief The number of objects facing the same directions.
    */
@@ -58,9 +187,10 @@ public:
     , reverse(reverse)
     , normal_direction(normal_direction)
     , normal_coordinate(normal_coordinate)
-    , aux(aux_dimensions(from, directions))
+    , aux(aux_dimensions(from, directions), aux_periodic(from, directions))
   {
     static_assert(k >= 1, "Element dimension of slab must be at least 1");
+    require_unreversed(from, "Slab");
     // Assert that normal_direction is not in the array of directions
     assert(std::find(directions.begin(), directions.end(), normal_direction) == directions.end());
   }
@@ -92,31 +222,219 @@ public:
    * #superset. Then, the coordinate in this direction is computed using #reverse as either the same
    * as the one in #aux or the one obtained by subtracting this from the fiber dimension.
    */
-  constexpr Element<n, k, Sint, Tint> operator[](Bint index) const
+  TPCC_INSTRUMENTED_CONSTEXPR Element<n, k, Sint, Tint> operator[](Bint index) const
   {
+    TPCC_INSTRUMENT_SCOPE(slab_access, n, k);
     auto local = aux[index];
     // `local` contains a cut through the elements of the slab. Thus, copy the along directions.
+    std::array<bool, n> along{};
     std::array<Sint, n> coordinates{};
     for (Tint i = 0; i < k - 1; ++i)
     {
-      const Sint c = local.along_coordinate(i);
-      const Tint d = directions[local.along_direction(i)];
-      coordinates[d] = reverse[i] ? (superset.fiber_dimension(d) - c - 1) : (c);
+      const Tint a = local.along_direction(i);
+      along[directions[a]] = true;
+      coordinates[directions[a]] = coordinate(a, true, local.along_coordinate(i));
     }
     // By definition of a slab, the normal_direction is an along_direction of its elements
+    along[normal_direction] = true;
     coordinates[normal_direction] = normal_coordinate;
     // The remaining coordinates are just copied
     for (Tint i = 0; i < n - k; ++i)
     {
-      const Sint c = local.across_coordinate(i);
-      const Tint d = directions[local.across_direction(i)];
-      coordinates[d] = reverse[i] ? (superset.fiber_dimension(d) - c) : (c);
+      const Tint a = local.across_direction(i);
+      coordinates[directions[a]] = coordinate(a, false, local.across_coordinate(i));
     }
-    Tint new_direction = (normal_direction < k) ? k : normal_direction;
-    return Element<n, k, Sint, Tint>{ local.orientation.add_and_expand(new_direction),
-                                      coordinates };
+    return Element<n, k, Sint, Tint>{ orientation_along<n, k, Tint>(along), coordinates };
+  }
+
+  /**
+   * \brief Copy the values of a cochain on the superset at the elements of the slab into a
+   * buffer of length size(), in the order of the slab.
+   *
+   * Since the order is defined by #directions and #reverse, two slabs in different complexes
+   * describing the same cells in the same order can exchange values through pack() on one side
+   * and unpack() on the other.
+   *
+   * Instead of computing each element by operator[](), the values are copied in strided runs
+   * along the fastest direction of each orientation block of #aux.
+   */
+  template <typename Number>
+  void pack(const Number* values, Number* buffer) const
+  {
+    for_each_run([&](Bint local, Bint global, Bint count, difference_t stride) {
+      for (Bint i = 0; i < count; ++i, global += stride)
+        buffer[local + i] = values[global];
+    });
+  }
+
+  /**
+   * \brief Copy the values in a buffer of length size(), in the order of the slab, into a
+   * cochain on the superset. This is the inverse of pack().
+   */
+  template <typename Number>
+  void unpack(const Number* buffer, Number* values) const
+  {
+    for_each_run([&](Bint local, Bint global, Bint count, difference_t stride) {
+      for (Bint i = 0; i < count; ++i, global += stride)
+        values[global] = buffer[local + i];
+    });
+  }
+
+  /// Signed integer type for the strides of runs
+  typedef typename BlockLayout<n, Bint, Sint, Tint>::difference_t difference_t;
+
+  /**
+   * \brief Call `f(local, global, count, stride)` for runs of consecutive slab elements.
+   *
+   * The elements with slab indices `local` to `local+count-1` have the indices `global`,
+   * `global+stride`, and so on in the superset. The stride is negative in reversed directions.
+   */
+  template <class F>
+  void for_each_run(F f) const;
+
+private:
+  /// The coordinate in the superset for the coordinate `c` in direction `a` of #aux, see
+  /// reflect_coordinate()
+  constexpr Sint coordinate(Tint a, bool along, Sint c) const
+  {
+    const Tint d = directions[a];
+    return reflect_coordinate<Sint>(superset.fiber_dimension(d), superset.is_periodic(d),
+                                    reverse[a], along, c);
   }
 };
+
+//----------------------------------------------------------------------//
+
+template <int n, int k, typename Bint, typename Sint, typename Tint>
+template <class F>
+void Slab<n, k, Bint, Sint, Tint>::for_each_run(F f) const
+{
+  for_each_hyperplane_run(superset, aux, directions, reverse, normal_direction,
+                          normal_coordinate, f);
+}
+
+/**
+ * \brief The `k`-cells of a tensor product chain complex in a hyperplane orthogonal to one
+ * coordinate direction
+ *
+ * A cut plane consists of the elements of dimension `k<n` which do not extend in the
+ * #normal_direction and have the coordinate #normal_coordinate in this direction. For the
+ * coordinates zero and `fiber_dimension(normal_direction)`, these are the faces of the complex
+ * on its lower and upper boundary.
+ *
+ * As in a Slab, the elements are enumerated lexicographically in the local coordinates given
+ * by #directions and #reverse. Thus, two cut planes in different complexes which describe the
+ * same interface in the same order match element by element, which is used to glue complexes
+ * along their boundaries.
+ */
+template <int n, int k, typename Bint = unsigned int, typename Sint = unsigned short,
+          typename Tint = unsigned char>
+class CutPlane
+{
+  const Lexicographic<n, k, Bint, Sint, Tint>& superset;
+  const std::array<Tint, n - 1> directions;
+  const std::array<bool, n - 1> reverse;
+  const Tint normal_direction;
+  const Sint normal_coordinate;
+  const Lexicographic<n - 1, k, Bint, Sint, Tint> aux;
+
+  /// The auxiliary complex with the dimensions and periodicity of #directions
+  static constexpr Lexicographic<n - 1, k, Bint, Sint, Tint> aux_complex(
+    const Lexicographic<n, k, Bint, Sint, Tint>& from, const std::array<Tint, n - 1>& directions)
+  {
+    std::array<Sint, n - 1> dimensions{};
+    std::array<bool, n - 1> periodic{};
+    for (Tint i = 0; i < n - 1; ++i)
+    {
+      dimensions[i] = from.fiber_dimension(directions[i]);
+      periodic[i] = from.is_periodic(directions[i]);
+    }
+    return Lexicographic<n - 1, k, Bint, Sint, Tint>(dimensions, periodic);
+  }
+
+public:
+  /// Signed integer type for the strides of runs
+  typedef typename BlockLayout<n, Bint, Sint, Tint>::difference_t difference_t;
+
+  constexpr CutPlane(const Lexicographic<n, k, Bint, Sint, Tint>& from,
+                     const std::array<Tint, n - 1> directions,
+                     const std::array<bool, n - 1>& reverse, Tint normal_direction,
+                     Sint normal_coordinate)
+    : superset(from)
+    , directions(directions)
+    , reverse(reverse)
+    , normal_direction(normal_direction)
+    , normal_coordinate(normal_coordinate)
+    , aux(aux_complex(from, directions))
+  {
+    static_assert(k < n, "Elements of a cut plane cannot extend in all directions");
+    require_unreversed(from, "CutPlane");
+    assert(std::find(directions.begin(), directions.end(), normal_direction) == directions.end());
+    assert(normal_coordinate <= from.fiber_dimension(normal_direction));
+  }
+
+  constexpr Bint size() const { return aux.size(); }
+
+  /**
+   * \brief The number of elements in one direction
+   */
+  constexpr Bint block_size(Tint block) const { return aux.block_size(block); }
+
+  /**
+   * \brief The element at position index, in the coordinates of the whole chain complex.
+   *
+   * The element of #aux with this index is mapped to the superset as in Slab::operator[](),
+   * except that the #normal_direction is added as a direction across the element.
+   */
+  Element<n, k, Sint, Tint> operator[](Bint index) const
+  {
+    const auto local = aux[index];
+    std::array<bool, n> along{};
+    std::array<Sint, n> coordinates{};
+    for (Tint i = 0; i < k; ++i)
+    {
+      const Tint a = local.along_direction(i);
+      along[directions[a]] = true;
+      coordinates[directions[a]] = coordinate(a, true, local.along_coordinate(i));
+    }
+    for (Tint i = 0; i < n - 1 - k; ++i)
+    {
+      const Tint a = local.across_direction(i);
+      coordinates[directions[a]] = coordinate(a, false, local.across_coordinate(i));
+    }
+    coordinates[normal_direction] = normal_coordinate;
+    return Element<n, k, Sint, Tint>{ orientation_along<n, k, Tint>(along), coordinates };
+  }
+
+  /**
+   * \brief Call `f(local, global, count, stride)` for runs of consecutive elements.
+   *
+   * The elements with indices `local` to `local+count-1` in the cut plane have the indices
+   * `global`, `global+stride`, and so on in the superset, as in Slab::for_each_run().
+   */
+  template <class F>
+  void for_each_run(F f) const;
+
+private:
+  /// The coordinate in the superset for the coordinate `c` in direction `a` of #aux, see
+  /// reflect_coordinate()
+  constexpr Sint coordinate(Tint a, bool along, Sint c) const
+  {
+    const Tint d = directions[a];
+    return reflect_coordinate<Sint>(superset.fiber_dimension(d), superset.is_periodic(d),
+                                    reverse[a], along, c);
+  }
+};
+
+//----------------------------------------------------------------------//
+
+template <int n, int k, typename Bint, typename Sint, typename Tint>
+template <class F>
+void CutPlane<n, k, Bint, Sint, Tint>::for_each_run(F f) const
+{
+  for_each_hyperplane_run(superset, aux, directions, reverse, normal_direction,
+                          normal_coordinate, f);
+}
 } // namespace TPCC
 
 #endif // TPCC_SLAB_H
@@ -0,0 +1,295 @@
+#ifndef TPCC_TABLE_CACHE_H
+#define TPCC_TABLE_CACHE_H
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <tpcc/lexicographic.h>
+
+namespace TPCC
+{
+/**
+ * \brief Compute the table of facet indices of all elements of `mesh`.
+ *
+ * The result contains for each element of `mesh` the indices of its `2k` facets in
+ * `mesh.boundary()`, ordered as by Element::facet().
+ */
+template <int n, int k, typename Bint, typename Sint, typename Tint>
+std::vector<Bint> facet_table(const Lexicographic<n, k, Bint, Sint, Tint>& mesh)
+{
+  auto boundary = mesh.boundary();
+  std::vector<Bint> result;
+  result.reserve(mesh.size() * 2 * k);
+  for (Bint i = 0; i < mesh.size(); ++i)
+  {
+    auto element = mesh[i];
+    for (Tint f = 0; f < element.n_facets(); ++f)
+      result.push_back(boundary.index(element.facet(f)));
+  }
+  return result;
+}
+
+/**
+ * \brief Read-only access to an array in memory owned by someone else.
+ */
+template <typename T>
+class ArrayView
+{
+  const T* first;
+  std::size_t length;
+
+public:
+  constexpr ArrayView(const T* data = nullptr, std::size_t size = 0)
+    : first(data)
+    , length(size)
+  {
+  }
+  constexpr const T* data() const { return first; }
+  constexpr std::size_t size() const { return length; }
+  constexpr const T* begin() const { return first; }
+  constexpr const T* end() const { return first + length; }
+  constexpr const T& operator[](std::size_t i) const { return first[i]; }
+};
+
+/**
+ * \brief A file of derived index tables of a Lexicographic complex, loaded with `mmap`.
+ *
+ * Tables derived from the enumeration, for instance by facet_table(), can be stored with write()
+ * and are afterwards accessed through table() without copying or recomputing them.
+ *
+ * The file starts with a header of 64-bit words containing a magic number, the format #version,
+ * the key `(n, k, sizeof(Bint), sizeof(Sint), sizeof(Tint))`, the number of tables, a checksum
+ * and the `n` fiber dimensions followed by `n` flags for periodicity, the direction order and
+ * `n` flags for reversed directions.
+ * It is followed by a directory with a name, an offset and a length for each table, and finally
+ * by the tables themselves, each aligned to 8 bytes.
+ * The checksum is a 64-bit FNV-1a hash over directory and tables.
+ *
+ * A file is only accepted by open() if the key and the dimensions match the mesh and the
+ * checksum is correct. Otherwise, the tables have to be recomputed.
+ *
+ * \note This class uses POSIX functions for mapping files.
+ */
+template <int n, int k, typename Bint = unsigned int, typename Sint = unsigned short,
+          typename Tint = unsigned char>
+class MappedTables
+{
+public:
+  /// The version of the file format, to be increased with every incompatible change
+  static constexpr std::uint64_t version = 4;
+  /// The maximal length of table names including the terminating zero
+  static constexpr std::size_t name_length = 24;
+
+  typedef Lexicographic<n, k, Bint, Sint, Tint> complex_type;
+
+  MappedTables() = default;
+  MappedTables(const MappedTables&) = delete;
+  MappedTables& operator=(const MappedTables&) = delete;
+  ~MappedTables() { close(); }
+
+  /**
+   * \brief Write named tables for `mesh` into a file.
+   *
+   * \return `false` if the file could not be written.
+   */
+  static bool write(const std::string& filename, const complex_type& mesh,
+                    const std::vector<std::pair<std::string, std::vector<Bint>>>& tables);
+
+  /**
+   * \brief Map a file written by write() into memory.
+   *
+   * \return `false` if the file does not exist, was written for a different mesh or index
+   * types, or if it is corrupted. In this case, no tables are available.
+   */
+  bool open(const std::string& filename, const complex_type& mesh);
+
+  /// Unmap the file
+  void close();
+
+  /// The number of tables in the file
+  std::size_t n_tables() const { return directory.size(); }
+
+  /**
+   * \brief The table stored under `name`.
+   *
+   * The view is empty if there is no such table. It refers to the mapped file and is invalidated
+   * by close().
+   */
+  ArrayView<Bint> table(const std::string& name) const;
+
+private:
+  /// An entry in the table directory
+  struct Entry
+  {
+    char name[name_length];
+    std::uint64_t offset;
+    std::uint64_t length;
+  };
+
+  /// The number of words in the header
+  static constexpr std::size_t header_words = 9 + 4 * n;
+
+  /// The fixed part of the header, which is checked when opening
+  static std::array<std::uint64_t, header_words> header(const complex_type& mesh);
+
+  /// FNV-1a hash of a sequence of bytes
+  static std::uint64_t checksum(const char* data, std::size_t size);
+
+  /// The address of the mapped file
+  void* address = nullptr;
+  /// The size of the mapped file
+  std::size_t mapped_size = 0;
+  /// The directory of tables, pointing into the mapped file
+  ArrayView<Entry> directory;
+};
+
+//----------------------------------------------------------------------//
+
+template <int n, int k, typename Bint, typename Sint, typename Tint>
+std::array<std::uint64_t, MappedTables<n, k, Bint, Sint, Tint>::header_words>
+MappedTables<n, k, Bint, Sint, Tint>::header(const complex_type& mesh)
+{
+  std::array<std::uint64_t, header_words> result{};
+  std::memcpy(result.data(), "TPCCTBL", 8);
+  result[1] = version;
+  result[2] = n;
+  result[3] = k;
+  result[4] = sizeof(Bint);
+  result[5] = sizeof(Sint);
+  result[6] = sizeof(Tint);
+  // result[7] is the number of tables and result[8] the checksum
+  for (Tint i = 0; i < n; ++i)
+  {
+    result[9 + i] = mesh.fiber_dimension(i);
+    result[9 + n + i] = mesh.is_periodic(i);
+    result[9 + 2 * n + i] = mesh.direction_order()[i];
+    result[9 + 3 * n + i] = mesh.is_reversed(i);
+  }
+  return result;
+}
+
+template <int n, int k, typename Bint, typename Sint, typename Tint>
+std::uint64_t MappedTables<n, k, Bint, Sint, Tint>::checksum(const char* data, std::size_t size)
+{
+  std::uint64_t hash = 14695981039346656037ull;
+  for (std::size_t i = 0; i < size; ++i)
+  {
+    hash ^= static_cast<unsigned char>(data[i]);
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+template <int n, int k, typename Bint, typename Sint, typename Tint>
+bool MappedTables<n, k, Bint, Sint, Tint>::write(
+  const std::string& filename, const complex_type& mesh,
+  const std::vector<std::pair<std::string, std::vector<Bint>>>& tables)
+{
+  static_assert(sizeof(Entry) % 8 == 0, "Directory entries must be aligned");
+  auto head = header(mesh);
+  head[7] = tables.size();
+
+  // Assemble directory and tables in memory to compute the checksum
+  std::vector<char> body(tables.size() * sizeof(Entry));
+  for (std::size_t t = 0; t < tables.size(); ++t)
+  {
+    if (tables[t].first.size() >= name_length)
+      return false;
+    Entry entry{};
+    std::strncpy(entry.name, tables[t].first.c_str(), name_length - 1);
+    entry.offset = sizeof(head) + body.size();
+    entry.length = tables[t].second.size();
+    std::memcpy(body.data() + t * sizeof(Entry), &entry, sizeof(Entry));
+
+    const char* data = reinterpret_cast<const char*>(tables[t].second.data());
+    body.insert(body.end(), data, data + entry.length * sizeof(Bint));
+    body.resize((body.size() + 7) / 8 * 8, 0);
+  }
+  head[8] = checksum(body.data(), body.size());
+
+  std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+  out.write(reinterpret_cast<const char*>(head.data()), sizeof(head));
+  out.write(body.data(), body.size());
+  return static_cast<bool>(out);
+}
+
+template <int n, int k, typename Bint, typename Sint, typename Tint>
+bool MappedTables<n, k, Bint, Sint, Tint>::open(const std::string& filename,
+                                                const complex_type& mesh)
+{
+  close();
+  const int fd = ::open(filename.c_str(), O_RDONLY);
+  if (fd < 0)
+    return false;
+  struct stat info;
+  if (fstat(fd, &info) != 0 || static_cast<std::size_t>(info.st_size) < 8 * header_words)
+  {
+    ::close(fd);
+    return false;
+  }
+  mapped_size = info.st_size;
+  address = mmap(nullptr, mapped_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (address == MAP_FAILED)
+  {
+    address = nullptr;
+    mapped_size = 0;
+    return false;
+  }
+
+  const char* bytes = static_cast<const char*>(address);
+  std::array<std::uint64_t, header_words> head;
+  std::memcpy(head.data(), bytes, sizeof(head));
+  auto expected = header(mesh);
+  expected[7] = head[7];
+  expected[8] = head[8];
+  const std::size_t directory_end = sizeof(head) + head[7] * sizeof(Entry);
+  if (head != expected || directory_end > mapped_size ||
+      checksum(bytes + sizeof(head), mapped_size - sizeof(head)) != head[8])
+  {
+    close();
+    return false;
+  }
+
+  directory = ArrayView<Entry>(reinterpret_cast<const Entry*>(bytes + sizeof(head)), head[7]);
+  for (const Entry& entry : directory)
+    if (entry.offset + entry.length * sizeof(Bint) > mapped_size || entry.offset % 8 != 0)
+    {
+      close();
+      return false;
+    }
+  return true;
+}
+
+template <int n, int k, typename Bint, typename Sint, typename Tint>
+void MappedTables<n, k, Bint, Sint, Tint>::close()
+{
+  if (address != nullptr)
+    munmap(address, mapped_size);
+  address = nullptr;
+  mapped_size = 0;
+  directory = ArrayView<Entry>();
+}
+
+template <int n, int k, typename Bint, typename Sint, typename Tint>
+ArrayView<Bint> MappedTables<n, k, Bint, Sint, Tint>::table(const std::string& name) const
+{
+  for (const Entry& entry : directory)
+    if (name == entry.name)
+      return ArrayView<Bint>(
+        reinterpret_cast<const Bint*>(static_cast<const char*>(address) + entry.offset),
+        entry.length);
+  return ArrayView<Bint>();
+}
+} // namespace TPCC
+
+#endif
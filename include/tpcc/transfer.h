@@ -0,0 +1,398 @@
+#ifndef TPCC_TRANSFER_H
+#define TPCC_TRANSFER_H
+
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <tpcc/lexicographic.h>
+
+namespace TPCC
+{
+/**
+ * \brief A sparse matrix in compressed row storage.
+ */
+template <typename Bint = unsigned int, typename Number = double>
+struct CSRMatrix
+{
+  /// The entries of row `i` are at positions `row_offsets[i]` to `row_offsets[i+1]-1`
+  std::vector<Bint> row_offsets;
+  /// The column index of each entry
+  std::vector<Bint> columns;
+  /// The value of each entry
+  std::vector<Number> values;
+
+  /// Compute `y = A x`
+  void vmult(Number* y, const Number* x) const
+  {
+    for (Bint i = 0; i + 1 < row_offsets.size(); ++i)
+    {
+      Number sum = 0;
+      for (Bint j = row_offsets[i]; j < row_offsets[i + 1]; ++j)
+        sum += values[j] * x[columns[j]];
+      y[i] = sum;
+    }
+  }
+};
+
+/**
+ * \brief Transfer of cochains between a Lexicographic complex and its uniform refinement.
+ *
+ * The fine complex has twice the number of cells in each direction and the same periodic
+ * directions, direction order and reversed directions. A coarse `k`-cell with
+ * coordinates `x` is subdivided into the `2^k` fine `k`-cells with coordinates `2x+c`, where
+ * `c` is 0 or 1 in the directions along the cell and zero in the directions across. Fine cells
+ * with an odd coordinate across lie inside coarse cells of higher dimension and do not belong
+ * to any coarse `k`-cell.
+ *
+ * Since cochain values are integrals over cells, restrict_values() sums the values of the
+ * children. prolongate() interpolates with the tensor product Whitney forms: along the cells,
+ * a coarse value is distributed equally to the two halves, and across, the fine planes between
+ * two coarse ones get the mean of their neighbors. Thus, the children of a coarse cell receive
+ * its value with weight `2^-k`, and a fine cell with `m` odd coordinates across the mean of
+ * `2^m` such values. For `k=0`, this is linear interpolation at the new vertices. Restricting a
+ * prolongated cochain reproduces it.
+ *
+ * Both operations are matrix-free. They loop over each orientation block of the coarse complex,
+ * which is a dense array in both complexes, with the fine index advancing by twice the fine
+ * stride. The interpolation across runs along lines of the fine blocks, one direction after the
+ * other. The loops are split between `n_threads` threads.
+ */
+template <int n, int k, typename Bint = unsigned int, typename Sint = unsigned short,
+          typename Tint = unsigned char>
+class Transfer
+{
+public:
+  typedef Lexicographic<n, k, Bint, Sint, Tint> complex_type;
+
+  /// Constructor for the coarse complex, the fine one is computed
+  Transfer(const complex_type& coarse)
+    : coarse_mesh(coarse)
+    , fine_mesh(refined_dimensions(coarse), periodic_directions(coarse),
+                coarse.direction_order(), coarse.reversed_directions())
+    , all_offsets{}
+  {
+    // Reversed, the children of the coarse position `p` are at the fine positions `2p` and
+    // `2p+1`, except across periodic directions, where the parity changes
+    for (Tint d = 0; d < n; ++d)
+      if (coarse.is_reversed(d) && coarse.is_periodic(d))
+        throw std::invalid_argument("Transfer does not support reversed periodic directions");
+    for (Tint b = 0; b < fine_mesh.n_blocks(); ++b)
+    {
+      const auto layout = fine_mesh.block_layout(b);
+      for (unsigned int c = 0; c < n_children(); ++c)
+        for (Tint i = 0; i < k; ++i)
+          if ((c >> i) & 1)
+            all_offsets[b][c] += layout.strides[layout.order[i]];
+    }
+  }
+
+  /// The coarse complex
+  const complex_type& coarse() const { return coarse_mesh; }
+
+  /// The fine complex
+  const complex_type& fine() const { return fine_mesh; }
+
+  /// The number of fine cells subdividing each coarse cell
+  static constexpr unsigned int n_children() { return 1 << k; }
+
+  /**
+   * \brief Compute `fine = P coarse`.
+   *
+   * Fine cells without a coarse parent are interpolated from the children of their neighbors
+   * across.
+   */
+  template <typename Number>
+  void prolongate(const Number* coarse, Number* fine, unsigned int n_threads = 1) const;
+
+  /**
+   * \brief Compute `coarse = R fine`, the sum over the children of each coarse cell.
+   */
+  template <typename Number>
+  void restrict_values(const Number* fine, Number* coarse, unsigned int n_threads = 1) const;
+
+  /**
+   * \brief The global indices of the children of the coarse cell with index `index`.
+   */
+  std::array<Bint, (1 << k)> children(Bint index) const;
+
+  /// The restriction matrix, a row for each coarse cell with its children
+  template <typename Number = double>
+  CSRMatrix<Bint, Number> restriction_matrix() const;
+
+  /// The prolongation matrix, a row for each fine cell with up to `2^(n-k)` entries
+  template <typename Number = double>
+  CSRMatrix<Bint, Number> prolongation_matrix() const;
+
+  /**
+   * \brief Call `f(block, coarse_index, fine_index)` for every coarse cell, its orientation block
+   * and the index of its first child, the one with `c=0`.
+   *
+   * The coarse cells of each block are split into `n_threads` ranges processed concurrently.
+   */
+  template <class F>
+  void for_each_parent(F f, unsigned int n_threads = 1) const;
+
+  /**
+   * \brief The differences between the index of each child and the one of the first child in
+   * the orientation block `block`.
+   */
+  const std::array<Bint, (1 << k)>& child_offsets(Tint block) const { return all_offsets[block]; }
+
+private:
+  /// Call `kernel(first, last)` for `n_threads` ranges splitting `0` to `size-1`
+  template <class F>
+  static void parallel(F kernel, Bint size, unsigned int n_threads);
+
+  /// Interpolate the fine cells with odd coordinate in the direction `d` across block `block`
+  template <typename Number>
+  void interpolate_across(Number* fine, Tint block, Tint d, unsigned int n_threads) const;
+
+  static std::array<Sint, n> refined_dimensions(const complex_type& coarse)
+  {
+    std::array<Sint, n> result{};
+    for (Tint d = 0; d < n; ++d)
+      result[d] = 2 * coarse.fiber_dimension(d);
+    return result;
+  }
+
+  static std::array<bool, n> periodic_directions(const complex_type& coarse)
+  {
+    std::array<bool, n> result{};
+    for (Tint d = 0; d < n; ++d)
+      result[d] = coarse.is_periodic(d);
+    return result;
+  }
+
+  complex_type coarse_mesh;
+  complex_type fine_mesh;
+  /// The result of child_offsets() for each block
+  std::array<std::array<Bint, (1 << k)>, binomial(n, k)> all_offsets;
+};
+
+//----------------------------------------------------------------------//
+
+template <int n, int k, typename Bint, typename Sint, typename Tint>
+template <class F>
+void Transfer<n, k, Bint, Sint, Tint>::for_each_parent(F f, unsigned int n_threads) const
+{
+  for (Tint b = 0; b < coarse_mesh.n_blocks(); ++b)
+  {
+    const auto cl = coarse_mesh.block_layout(b);
+    const auto fl = fine_mesh.block_layout(b);
+    const Bint size = cl.size();
+
+    auto kernel = [&](Bint first, Bint last) {
+      // Decode the coordinates of the first cell, then step through the block
+      std::array<Sint, n> x{};
+      Bint rest = first;
+      for (Tint i = 0; i < n; ++i)
+      {
+        const Tint d = cl.order[i];
+        x[d] = rest % cl.extents[d];
+        rest /= cl.extents[d];
+      }
+      Bint fine_index = fl.offset;
+      for (Tint d = 0; d < n; ++d)
+        fine_index += 2 * x[d] * fl.strides[d];
+
+      for (Bint i = first; i < last; ++i)
+      {
+        f(b, cl.offset + i, fine_index);
+        for (Tint j = 0; j < n; ++j)
+        {
+          const Tint d = cl.order[j];
+          fine_index += 2 * fl.strides[d];
+          if (++x[d] < cl.extents[d])
+            break;
+          fine_index -= 2 * x[d] * fl.strides[d];
+          x[d] = 0;
+        }
+      }
+    };
+
+    parallel(kernel, size, n_threads);
+  }
+}
+
+template <int n, int k, typename Bint, typename Sint, typename Tint>
+template <class F>
+void Transfer<n, k, Bint, Sint, Tint>::parallel(F kernel, Bint size, unsigned int n_threads)
+{
+  n_threads = std::max(1u, n_threads);
+  if (n_threads == 1 || size < 2 * n_threads)
+    kernel(0, size);
+  else
+  {
+    std::vector<std::thread> threads;
+    for (unsigned int t = 0; t < n_threads; ++t)
+      threads.emplace_back(kernel, size * t / n_threads, size * (t + 1) / n_threads);
+    for (auto& thread : threads)
+      thread.join();
+  }
+}
+
+template <int n, int k, typename Bint, typename Sint, typename Tint>
+template <typename Number>
+void Transfer<n, k, Bint, Sint, Tint>::interpolate_across(Number* fine, Tint block, Tint d,
+                                                          unsigned int n_threads) const
+{
+  const auto layout = fine_mesh.block_layout(block);
+  const Bint extent = layout.extents[d];
+  const Bint stride = layout.strides[d];
+  parallel(
+    [&](Bint first, Bint last) {
+      for (Bint line = first; line < last; ++line)
+      {
+        // The first cell of the line, from the coordinates in the other directions
+        Bint base = layout.offset;
+        Bint rest = line;
+        for (Tint i = 0; i < n; ++i)
+        {
+          const Tint e = layout.order[i];
+          if (e == d)
+            continue;
+          base += (rest % layout.extents[e]) * layout.strides[e];
+          rest /= layout.extents[e];
+        }
+        // In a periodic direction, the extent is even and the last cell wraps around
+        for (Bint y = 1; y < extent; y += 2)
+          fine[base + y * stride] = (fine[base + (y - 1) * stride] +
+                                     fine[base + (y + 1 == extent ? 0 : y + 1) * stride]) /
+                                    Number(2);
+      }
+    },
+    layout.size() / extent, n_threads);
+}
+
+template <int n, int k, typename Bint, typename Sint, typename Tint>
+template <typename Number>
+void Transfer<n, k, Bint, Sint, Tint>::prolongate(const Number* coarse, Number* fine,
+                                                  unsigned int n_threads) const
+{
+  std::fill(fine, fine + fine_mesh.size(), Number(0));
+  const Number weight = Number(1) / n_children();
+  for_each_parent(
+    [&](Tint block, Bint ci, Bint fi) {
+      const auto& offsets = all_offsets[block];
+      const Number value = weight * coarse[ci];
+      for (unsigned int c = 0; c < n_children(); ++c)
+        fine[fi + offsets[c]] = value;
+    },
+    n_threads);
+  // After the pass in direction `d`, all cells with odd coordinates only in the directions
+  // treated so far have their values
+  for (Tint b = 0; b < fine_mesh.n_blocks(); ++b)
+  {
+    const auto order = fine_mesh.block_layout(b).order;
+    for (Tint i = k; i < n; ++i)
+      interpolate_across(fine, b, order[i], n_threads);
+  }
+}
+
+template <int n, int k, typename Bint, typename Sint, typename Tint>
+template <typename Number>
+void Transfer<n, k, Bint, Sint, Tint>::restrict_values(const Number* fine, Number* coarse,
+                                                       unsigned int n_threads) const
+{
+  for_each_parent(
+    [&](Tint block, Bint ci, Bint fi) {
+      const auto& offsets = all_offsets[block];
+      Number sum = 0;
+      for (unsigned int c = 0; c < n_children(); ++c)
+        sum += fine[fi + offsets[c]];
+      coarse[ci] = sum;
+    },
+    n_threads);
+}
+
+template <int n, int k, typename Bint, typename Sint, typename Tint>
+std::array<Bint, (1 << k)> Transfer<n, k, Bint, Sint, Tint>::children(Bint index) const
+{
+  const auto e = coarse_mesh[index];
+  const Tint block = e.direction_index();
+  const auto coarse_layout = coarse_mesh.block_layout(block);
+  const auto layout = fine_mesh.block_layout(block);
+  Bint first = layout.offset;
+  for (Tint d = 0; d < n; ++d)
+    first += 2 * coarse_layout.position(d, e[d]) * layout.strides[d];
+  std::array<Bint, (1 << k)> result = all_offsets[block];
+  for (auto& i : result)
+    i += first;
+  return result;
+}
+
+template <int n, int k, typename Bint, typename Sint, typename Tint>
+template <typename Number>
+CSRMatrix<Bint, Number> Transfer<n, k, Bint, Sint, Tint>::restriction_matrix() const
+{
+  CSRMatrix<Bint, Number> result;
+  result.row_offsets.resize(coarse_mesh.size() + 1);
+  result.columns.resize(coarse_mesh.size() * n_children());
+  result.values.assign(coarse_mesh.size() * n_children(), Number(1));
+  for_each_parent([&](Tint block, Bint ci, Bint fi) {
+    result.row_offsets[ci] = ci * n_children();
+    for (unsigned int c = 0; c < n_children(); ++c)
+      result.columns[ci * n_children() + c] = fi + all_offsets[block][c];
+  });
+  result.row_offsets[coarse_mesh.size()] = coarse_mesh.size() * n_children();
+  return result;
+}
+
+template <int n, int k, typename Bint, typename Sint, typename Tint>
+template <typename Number>
+CSRMatrix<Bint, Number> Transfer<n, k, Bint, Sint, Tint>::prolongation_matrix() const
+{
+  CSRMatrix<Bint, Number> result;
+  result.row_offsets.reserve(fine_mesh.size() + 1);
+  result.row_offsets.push_back(0);
+  const Number weight = Number(1) / n_children();
+  // The fine blocks are traversed in the order of their indices
+  for (Tint b = 0; b < fine_mesh.n_blocks(); ++b)
+  {
+    const auto cl = coarse_mesh.block_layout(b);
+    const auto fl = fine_mesh.block_layout(b);
+    std::array<Sint, n> y{};
+    for (Bint i = 0; i < fl.size(); ++i)
+    {
+      // The coarse cell with the lower coordinates and the directions to its other neighbors
+      Bint first = cl.offset;
+      std::array<Tint, n - k> odd{};
+      unsigned int n_odd = 0;
+      for (Tint j = 0; j < n; ++j)
+      {
+        const Tint d = fl.order[j];
+        first += (y[d] / 2) * cl.strides[d];
+        if (j >= k && y[d] % 2 == 1)
+          odd[n_odd++] = d;
+      }
+      for (unsigned int c = 0; c < (1u << n_odd); ++c)
+      {
+        Bint column = first;
+        for (unsigned int j = 0; j < n_odd; ++j)
+          if ((c >> j) & 1)
+          {
+            const Tint d = odd[j];
+            column += (y[d] / 2 + 1 == cl.extents[d]) ? -(y[d] / 2) * cl.strides[d]
+                                                       : cl.strides[d];
+          }
+        result.columns.push_back(column);
+        result.values.push_back(weight / (1u << n_odd));
+      }
+      result.row_offsets.push_back(result.columns.size());
+
+      for (Tint j = 0; j < n; ++j)
+      {
+        const Tint d = fl.order[j];
+        if (++y[d] < fl.extents[d])
+          break;
+        y[d] = 0;
+      }
+    }
+  }
+  return result;
+}
+} // namespace TPCC
+
+#endif
@@ -0,0 +1,162 @@
+#ifndef TPCC_VTK_H
+#define TPCC_VTK_H
+
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <tpcc/element.h>
+
+namespace TPCC
+{
+/**
+ * \brief Buffer for binary output in big endian byte order as required by legacy VTK files.
+ *
+ * Values are collected in a buffer of fixed size, which is written to the stream whenever it is
+ * full. Thus, the memory used does not depend on the amount of data written.
+ */
+class BigEndianBuffer
+{
+  std::ostream& os;
+  std::vector<char> buffer;
+  std::size_t capacity;
+
+public:
+  BigEndianBuffer(std::ostream& os, std::size_t capacity)
+    : os(os)
+    , capacity(capacity)
+  {
+    buffer.reserve(capacity + 8);
+  }
+
+  ~BigEndianBuffer() { flush(); }
+
+  /// Append a single value to the buffer, swapping bytes if necessary
+  template <typename T>
+  void put(T value)
+  {
+    char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+    for (std::size_t i = sizeof(T); i > 0; --i)
+      buffer.push_back(bytes[i - 1]);
+#else
+    buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+#endif
+    if (buffer.size() >= capacity)
+      flush();
+  }
+
+  /// Write the content of the buffer to the stream
+  void flush()
+  {
+    os.write(buffer.data(), buffer.size());
+    buffer.clear();
+  }
+};
+
+/**
+ * \brief Implementation of write_vtk() with the dimensions deduced from the element type.
+ */
+template <class CELLS, int n, int k, typename Sint, typename Tint>
+void write_vtk_cells(std::ostream& os, const CELLS& cells,
+                     const std::vector<std::pair<std::string, const double*>>& cochains,
+                     double shrink, std::size_t chunk_size, Element<n, k, Sint, Tint>*)
+{
+  static_assert(n <= 3, "VTK output only for dimensions up to three");
+  constexpr unsigned int vertices = 1 << k;
+  constexpr int cell_types[] = { 1, 3, 8, 11 };
+  const std::size_t n_cells = cells.size();
+  const std::size_t buffer_size = chunk_size * vertices * 3 * sizeof(float);
+
+  os << "# vtk DataFile Version 3.0\n"
+     << "TPCC cells of dimension " << k << " in dimension " << n << "\n"
+     << "BINARY\n"
+     << "DATASET UNSTRUCTURED_GRID\n"
+     << "POINTS " << n_cells * vertices << " float\n";
+  {
+    BigEndianBuffer out(os, buffer_size);
+    for (std::size_t c = 0; c < n_cells; ++c)
+    {
+      const auto e = cells[c];
+      for (unsigned int v = 0; v < vertices; ++v)
+      {
+        // Start with the center of the cell and move towards vertex `v`
+        std::array<float, 3> x{};
+        for (Tint d = 0; d < n; ++d)
+          x[d] = e[d];
+        for (Tint i = 0; i < k; ++i)
+        {
+          const float offset = ((v >> i) & 1) ? 0.5 : -0.5;
+          x[e.along_direction(i)] += 0.5 + shrink * offset;
+        }
+        for (unsigned int d = 0; d < 3; ++d)
+          out.put(x[d]);
+      }
+    }
+  }
+
+  os << "\nCELLS " << n_cells << ' ' << n_cells * (vertices + 1) << "\n";
+  {
+    BigEndianBuffer out(os, buffer_size);
+    std::int32_t point = 0;
+    for (std::size_t c = 0; c < n_cells; ++c)
+    {
+      out.put(std::int32_t(vertices));
+      for (unsigned int v = 0; v < vertices; ++v)
+        out.put(point++);
+    }
+  }
+
+  os << "\nCELL_TYPES " << n_cells << "\n";
+  {
+    BigEndianBuffer out(os, buffer_size);
+    for (std::size_t c = 0; c < n_cells; ++c)
+      out.put(std::int32_t(cell_types[k]));
+  }
+
+  if (cochains.size() > 0)
+    os << "\nCELL_DATA " << n_cells;
+  for (const auto& cochain : cochains)
+  {
+    os << "\nSCALARS " << cochain.first << " double 1\nLOOKUP_TABLE default\n";
+    BigEndianBuffer out(os, buffer_size);
+    for (std::size_t c = 0; c < n_cells; ++c)
+      out.put(cochain.second[c]);
+  }
+  os << "\n";
+}
+
+/**
+ * \brief Write the cells of `cells` as an unstructured grid in binary legacy VTK format.
+ *
+ * Each `k`-cell is shrunk around its center by the factor `shrink`, such that the cells are
+ * visible separately as in the images of the documentation. Thus, each cell has its own `2^k`
+ * points. Cells of dimension 0, 1, 2, 3 are written as VTK vertices, lines, pixels and voxels,
+ * respectively. Vertices are located at the integer coordinates of the complex.
+ *
+ * Points, connectivity and cell types are generated on the fly from the enumeration in chunks of
+ * `chunk_size` cells, such that the memory used does not depend on the size of the mesh.
+ *
+ * \param os: The output stream, which should be opened in binary mode.
+ * \param cells: A set of cells like Lexicographic or Slab, providing `size()` and `operator[]`.
+ * \param cochains: Pairs of a name and a pointer to an array of length `cells.size()` with
+ * values attached to the cells, written as cell data.
+ * \param shrink: The factor by which cells are shrunk around their centers.
+ * \param chunk_size: The number of cells processed in one chunk.
+ */
+template <class CELLS>
+void write_vtk(std::ostream& os, const CELLS& cells,
+               const std::vector<std::pair<std::string, const double*>>& cochains = {},
+               double shrink = 0.8, std::size_t chunk_size = 4096)
+{
+  typedef typename std::decay<decltype(cells[0])>::type element_type;
+  write_vtk_cells(os, cells, cochains, shrink, chunk_size, static_cast<element_type*>(nullptr));
+}
+} // namespace TPCC
+
+#endif
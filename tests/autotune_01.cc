@@ -0,0 +1,169 @@
+// Unit test:
+// Traversals of a Lexicographic complex and their autotuning with a cache file
+
+// For several direction orders, tile and batch sizes, Traversal::for_each_batch() must visit
+// each element exactly once, with the decoded elements matching their indices. Then autotune()
+// must run the kernel when the cache file has no entry, and return the stored configuration
+// without running it afterwards. Entries for other dimensions are kept, and a file with a wrong
+// version or an entry whose order is not a permutation is replaced. Tiles must also cover a fiber
+// close to the largest coordinate of the integer type.
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <tpcc/autotune.h>
+
+template <int n, int k>
+void test_traversal(const std::array<unsigned short, n>& dim, const std::array<bool, n>& periodic)
+{
+  unsigned int n_configurations = 0;
+  for (const auto& order : TPCC::direction_orders<n, unsigned short>(dim))
+    for (unsigned int tile : { 0, 1, 3, 5 })
+      for (std::size_t batch_size : { 1, 7, 64 })
+      {
+        TPCC::TraversalConfiguration<n> config;
+        config.order = order;
+        config.tile = tile;
+        config.batch_size = batch_size;
+        const TPCC::Traversal<n, k> traversal(dim, periodic, config);
+        const auto& mesh = traversal.mesh();
+        if (mesh.direction_order() != order)
+          throw std::logic_error("Wrong direction order");
+        std::vector<unsigned int> visits(mesh.size());
+        traversal.for_each_batch([&](const TPCC::ElementBlock<n, k>& elements,
+                                     const std::vector<unsigned int>& indices) {
+          if (elements.size() != indices.size() || indices.size() > batch_size ||
+              indices.empty())
+            throw std::logic_error("Wrong batch size");
+          for (unsigned int i = 0; i < indices.size(); ++i)
+          {
+            ++visits[indices[i]];
+            if (mesh.index(elements[i]) != indices[i])
+              throw std::logic_error("Element differs from index");
+          }
+        });
+        for (unsigned int v : visits)
+          if (v != 1)
+            throw std::logic_error("Element not visited once");
+        ++n_configurations;
+      }
+  std::cout << "n=" << n << " k=" << k << " checked " << n_configurations << " configurations"
+            << std::endl;
+}
+
+/// Count the lines of `filename`
+unsigned int count_lines(const std::string& filename)
+{
+  std::ifstream in(filename);
+  std::string line;
+  unsigned int result = 0;
+  while (std::getline(in, line))
+    ++result;
+  return result;
+}
+
+/// A fiber of 65535 cells, where the corner of the last tile exceeds unsigned short
+void test_large_fiber()
+{
+  TPCC::TraversalConfiguration<1> config;
+  config.order = { { 0 } };
+  config.tile = 7;
+  config.batch_size = 1000;
+  const TPCC::Traversal<1, 1> traversal({ { 65535 } }, { { false } }, config);
+  std::vector<unsigned int> visits(traversal.mesh().size());
+  traversal.for_each_batch(
+    [&](const TPCC::ElementBlock<1, 1>& elements, const std::vector<unsigned int>& indices) {
+      for (unsigned int i = 0; i < indices.size(); ++i)
+      {
+        ++visits[indices[i]];
+        if (traversal.mesh().index(elements[i]) != indices[i])
+          throw std::logic_error("Element differs from index");
+      }
+    });
+  for (unsigned int v : visits)
+    if (v != 1)
+      throw std::logic_error("Element in large fiber not visited once");
+}
+
+void test_autotune()
+{
+  TPCC::AutotuneOptions options;
+  options.cache_file = "autotune_01.cache";
+  options.kernel_name = "facet sum";
+  options.repetitions = 2;
+  std::remove(options.cache_file.c_str());
+
+  unsigned int calls = 0;
+  double checksum = 0.;
+  auto kernel = [&](const TPCC::Traversal<2, 1>& traversal) {
+    ++calls;
+    const auto boundary = traversal.mesh().boundary();
+    std::vector<double> values(boundary.size(), 1.);
+    traversal.for_each_batch(
+      [&](const TPCC::ElementBlock<2, 1>& elements, const std::vector<unsigned int>&) {
+        for (unsigned int i = 0; i < elements.size(); ++i)
+          checksum += values[boundary.index(elements[i].facet(0))];
+      });
+  };
+
+  const std::array<unsigned short, 2> dim{ { 40, 20 } };
+  const std::array<bool, 2> periodic{ { false, true } };
+  const auto tuned = TPCC::autotune<2, 1>(dim, periodic, kernel, options);
+  const unsigned int tuning_calls = calls;
+  if (tuning_calls == 0 || count_lines(options.cache_file) != 2)
+    throw std::logic_error("Tuning not run or not stored");
+
+  const auto cached = TPCC::autotune<2, 1>(dim, periodic, kernel, options);
+  if (calls != tuning_calls)
+    throw std::logic_error("Kernel run despite cache entry");
+  if (!(cached.configuration() == tuned.configuration()))
+    throw std::logic_error("Cached configuration differs");
+
+  TPCC::autotune<2, 1>(std::array<unsigned short, 2>{ { 8, 8 } }, periodic, kernel, options);
+  if (calls == tuning_calls || count_lines(options.cache_file) != 3)
+    throw std::logic_error("Second entry not stored");
+  calls = 0;
+  TPCC::autotune<2, 1>(dim, periodic, kernel, options);
+  if (calls != 0)
+    throw std::logic_error("First entry lost");
+
+  options.force = true;
+  TPCC::autotune<2, 1>(dim, periodic, kernel, options);
+  if (calls == 0 || count_lines(options.cache_file) != 3)
+    throw std::logic_error("Forced tuning not replacing the entry");
+  options.force = false;
+
+  std::ofstream(options.cache_file) << "tpcc-autotune 0\n";
+  calls = 0;
+  TPCC::autotune<2, 1>(dim, periodic, kernel, options);
+  if (calls == 0 || count_lines(options.cache_file) != 2)
+    throw std::logic_error("File with wrong version not replaced");
+
+  const std::string key = TPCC::autotune_key<2, 1, unsigned int, unsigned short, unsigned char>(
+    options.kernel_name, dim, periodic);
+  std::ofstream(options.cache_file) << "tpcc-autotune " << TPCC::autotune_version << '\n'
+                                    << key << " 1 1 0 256 1\n";
+  calls = 0;
+  TPCC::autotune<2, 1>(dim, periodic, kernel, options);
+  if (calls == 0 || count_lines(options.cache_file) != 2)
+    throw std::logic_error("Entry with invalid order not replaced");
+  std::remove(options.cache_file.c_str());
+
+  std::cout << "autotune tried " << tuning_calls / options.repetitions << " configurations"
+            << std::endl;
+}
+
+int main()
+{
+  test_traversal<1, 1>({ { 11 } }, { { false } });
+  test_traversal<2, 1>({ { 7, 5 } }, { { false, true } });
+  test_traversal<3, 1>({ { 4, 6, 3 } }, { { false, false, true } });
+  test_traversal<3, 2>({ { 4, 6, 3 } }, { { false, false, false } });
+  test_traversal<4, 2>({ { 3, 2, 4, 3 } }, { { false, false, false, false } });
+  test_large_fiber();
+  test_autotune();
+}
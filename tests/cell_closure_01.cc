@@ -0,0 +1,86 @@
+// Unit test:
+// Tables of the faces in the closure of each n-cell
+
+// Compare each entry with the index of the face constructed explicitly, and the parallel bulk
+// mode with the serial one.
+
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <tpcc/cell_closure.h>
+
+/// Check the entries for faces of dimension `k`
+template <int n, int k>
+void check(const TPCC::Lexicographic<n, n>& cells, const std::vector<unsigned int>& table)
+{
+  typedef TPCC::CellClosure<n> closure;
+  std::array<unsigned short, n> dim;
+  std::array<bool, n> periodic;
+  for (unsigned int d = 0; d < n; ++d)
+  {
+    dim[d] = cells.fiber_dimension(d);
+    periodic[d] = cells.is_periodic(d);
+  }
+  const TPCC::Lexicographic<n, k> faces(dim, periodic, cells.direction_order());
+  unsigned int count = 0;
+  for (unsigned int i = 0; i < cells.size(); ++i)
+  {
+    const auto cell = cells[i];
+    for (unsigned int f = 0; f < closure::n_faces(); ++f)
+    {
+      if (closure::face_dimension(f) != k)
+        continue;
+      std::array<unsigned int, k> in{};
+      std::array<unsigned int, n - k> out{};
+      std::array<unsigned short, n> x;
+      unsigned int a = 0, c = 0, code = f;
+      for (unsigned int d = 0; d < n; ++d, code /= 3)
+      {
+        if (code % 3 == 1)
+          in[a++] = n - 1 - d;
+        else
+          out[c++] = n - 1 - d;
+        x[d] = cell[d] + ((code % 3 == 2) ? 1 : 0);
+      }
+      const TPCC::Element<n, k> face{ TPCC::Combination<n, k>(in, out), x };
+      if (table[i * closure::n_faces() + f] != faces.index(face))
+        throw std::logic_error("Face index differs");
+      ++count;
+    }
+  }
+  std::cout << "  k=" << k << " faces checked " << count << std::endl;
+}
+
+template <int n, int... k>
+void test(const std::array<unsigned short, n>& dim, const std::array<bool, n>& periodic,
+          const std::array<unsigned char, n>& order, std::integer_sequence<int, k...>)
+{
+  TPCC::Lexicographic<n, n> cells(dim, periodic, order);
+  TPCC::CellClosure<n> closure(cells);
+  std::cout << "Mesh-Dim: " << n << " cells " << closure.size() << std::endl;
+  const std::vector<unsigned int> table = closure.table(0, closure.size());
+  (check<n, k>(cells, table), ...);
+
+  std::vector<unsigned int> parallel(closure.size() * closure.n_faces());
+  closure.fill(parallel.data(), 3);
+  if (parallel != table)
+    throw std::logic_error("Parallel table differs");
+  const auto part = closure.table(3, closure.size() - 2);
+  if (!std::equal(part.begin(), part.end(), table.begin() + 3 * closure.n_faces()))
+    throw std::logic_error("Partial table differs");
+}
+
+int main()
+{
+  test<2>({ { 3, 4 } }, { { false, false } }, { { 0, 1 } }, std::make_integer_sequence<int, 3>());
+  test<2>({ { 3, 4 } }, { { true, false } }, { { 1, 0 } }, std::make_integer_sequence<int, 3>());
+  test<3>({ { 2, 3, 4 } }, { { false, false, false } }, { { 0, 1, 2 } },
+          std::make_integer_sequence<int, 4>());
+  test<3>({ { 2, 3, 4 } }, { { true, false, true } }, { { 2, 0, 1 } },
+          std::make_integer_sequence<int, 4>());
+  test<3>({ { 1, 3, 2 } }, { { true, true, false } }, { { 0, 1, 2 } },
+          std::make_integer_sequence<int, 4>());
+  return 0;
+}
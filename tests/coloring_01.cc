@@ -0,0 +1,112 @@
+// Unit test:
+// Coloring of the cells of a Lexicographic complex
+
+// Check that each cell has exactly one color, that color() agrees with the layouts and that no
+// two cells of the same color share a vertex. Then scatter to facets in parallel.
+
+#include <iostream>
+#include <set>
+#include <stdexcept>
+#include <vector>
+
+#include <tpcc/coloring.h>
+
+template <int n, int k>
+void test(const std::array<unsigned short, n>& dim, const std::array<bool, n>& periodic)
+{
+  TPCC::Lexicographic<n, k> mesh(dim, periodic);
+  TPCC::Coloring<n, k> coloring(mesh);
+  std::cout << "Mesh-Dim: " << n << " Element-Dim: " << k << " periodic";
+  for (unsigned int d = 0; d < n; ++d)
+    std::cout << ' ' << periodic[d];
+  std::cout << " colors " << coloring.n_colors() << " sizes";
+
+  std::vector<unsigned int> colors(mesh.size(), coloring.n_colors());
+  for (unsigned int c = 0; c < coloring.n_colors(); ++c)
+  {
+    const auto& layout = coloring.color_layout(c);
+    std::cout << ' ' << layout.size();
+    std::set<std::array<unsigned short, n>> vertices;
+    std::array<unsigned short, n> x{};
+    for (unsigned int i = 0; i < layout.size(); ++i)
+    {
+      // Decode the coordinates inside the color, first fastest in layout order
+      unsigned int rest = i;
+      for (unsigned int j = 0; j < n; ++j)
+      {
+        const unsigned int d = layout.order[j];
+        x[d] = rest % layout.extents[d];
+        rest /= layout.extents[d];
+      }
+      const unsigned int index = layout.index(x);
+      if (colors[index] != coloring.n_colors())
+        throw std::logic_error("Cell with two colors");
+      colors[index] = c;
+      const auto e = mesh[index];
+      if (coloring.color(e) != c || e.direction_index() != coloring.block(c))
+        throw std::logic_error("Color of cell wrong");
+
+      for (unsigned int v = 0; v < (1u << k); ++v)
+      {
+        std::array<unsigned short, n> vertex;
+        for (unsigned int d = 0; d < n; ++d)
+          vertex[d] = e[d];
+        for (unsigned int j = 0; j < k; ++j)
+          if ((v >> j) & 1)
+            ++vertex[e.along_direction(j)];
+        for (unsigned int d = 0; d < n; ++d)
+          if (periodic[d] && vertex[d] == dim[d])
+            vertex[d] = 0;
+        if (!vertices.insert(vertex).second)
+          throw std::logic_error("Cells of the same color share a vertex");
+      }
+    }
+  }
+  std::cout << std::endl;
+  for (unsigned int i = 0; i < mesh.size(); ++i)
+    if (colors[i] == coloring.n_colors())
+      throw std::logic_error("Cell without color");
+
+  if constexpr (k > 0)
+  {
+    // Scatter to the facets without atomics, compared to a sequential loop
+    const auto boundary = mesh.boundary();
+    std::vector<unsigned int> serial(boundary.size(), 0), parallel(boundary.size(), 0);
+    for (unsigned int i = 0; i < mesh.size(); ++i)
+      for (unsigned int f = 0; f < 2 * k; ++f)
+        serial[boundary.index(mesh[i].facet(f))] += i;
+    coloring.for_each(
+      [&](unsigned int i) {
+        for (unsigned int f = 0; f < 2 * k; ++f)
+          parallel[boundary.index(mesh[i].facet(f))] += i;
+      },
+      3);
+    if (serial != parallel)
+      throw std::logic_error("Parallel scatter differs");
+  }
+}
+
+int main()
+{
+  const std::array<unsigned short, 2> dim2{ { 4, 5 } };
+  const std::array<bool, 2> open2{};
+  test<2, 0>(dim2, open2);
+  test<2, 1>(dim2, open2);
+  test<2, 2>(dim2, open2);
+  const std::array<bool, 2> torus{ { true, true } };
+  test<2, 1>(dim2, torus);
+  test<2, 2>(dim2, torus);
+
+  const std::array<unsigned short, 3> dim3{ { 3, 4, 5 } };
+  const std::array<bool, 3> open3{};
+  test<3, 1>(dim3, open3);
+  test<3, 2>(dim3, open3);
+  test<3, 3>(dim3, open3);
+  const std::array<bool, 3> p3{ { true, false, true } };
+  test<3, 2>(dim3, p3);
+  test<3, 3>(dim3, p3);
+
+  const std::array<unsigned short, 3> thin{ { 1, 2, 3 } };
+  test<3, 3>(thin, open3);
+  return 0;
+}
@@ -0,0 +1,71 @@
+/**
+ * \file
+ * BitCombination compared to Combination
+ */
+
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+#include <tpcc/combinations.h>
+
+template <class C>
+std::string to_string(const C& c)
+{
+  std::stringstream os;
+  c.print_debug(os);
+  return os.str();
+}
+
+template <int n, int k>
+void test()
+{
+  std::cout << "Testing n=" << n << " k=" << k << std::endl;
+  TPCC::Combinations<n, k> combinations;
+  for (unsigned int i = 0; i < combinations.size(); ++i)
+  {
+    TPCC::Combination<n, k> c = combinations[i];
+    TPCC::BitCombination<n, k> b(c);
+    std::cout << std::setw(4) << b.bits() << ' ' << to_string(b);
+
+    if (to_string(b) != to_string(c))
+      throw std::logic_error("Combination differs");
+    if (to_string(b.combination()) != to_string(c))
+      throw std::logic_error("Conversion differs");
+    if (combinations.index(b) != i)
+      throw std::logic_error("Index differs");
+    if (to_string(b.complement()) != to_string(c.complement()))
+      throw std::logic_error("Complement differs");
+
+    if constexpr (k > 0)
+      for (unsigned int j = 0; j < k; ++j)
+      {
+        std::cout << "  " << to_string(b.eliminate(j));
+        if (to_string(b.eliminate(j)) != to_string(c.eliminate(j)))
+          throw std::logic_error("Eliminated combination differs");
+      }
+    if constexpr (k < n)
+    {
+      for (unsigned int j = 0; j < n - k; ++j)
+        if (to_string(b.add(b.out(j))) != to_string(c.add(c.out(j))))
+          throw std::logic_error("Added combination differs");
+      if (to_string(b.add_and_expand(n)) != to_string(c.add_and_expand(n)))
+        throw std::logic_error("Expanded combination differs");
+    }
+    std::cout << std::endl;
+  }
+  std::cout << std::endl;
+}
+
+int main()
+{
+  test<5, 0>();
+  test<5, 1>();
+  test<5, 2>();
+  test<5, 3>();
+  test<5, 4>();
+  test<5, 5>();
+  test<10, 4>();
+  return 0;
+}
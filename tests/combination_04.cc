@@ -0,0 +1,108 @@
+/**
+ * \file
+ * CombinationIterator in lexicographic and revolving door order
+ */
+
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#include <tpcc/combinations.h>
+
+template <class C>
+std::string to_string(const C& c)
+{
+  std::stringstream os;
+  c.print_debug(os);
+  return os.str();
+}
+
+template <int n, int k>
+void test(bool print)
+{
+  std::cout << "Testing n=" << n << " k=" << k << std::endl;
+  TPCC::Combinations<n, k> combinations;
+
+  unsigned int count = 0;
+  for (TPCC::CombinationIterator<n, k> it; !it.at_end(); ++it, ++count)
+  {
+    if (it.rank() != count || it.index() != count)
+      throw std::logic_error("Lexicographic rank wrong");
+    if (to_string(it.combination()) != to_string(combinations[count]))
+      throw std::logic_error("Lexicographic combination differs");
+  }
+  if (count != combinations.size())
+    throw std::logic_error("Lexicographic walk incomplete");
+
+  std::vector<bool> visited(combinations.size(), false);
+  TPCC::CombinationIterator<n, k> it(TPCC::CombinationOrder::revolving_door);
+  std::string previous;
+  for (count = 0; !it.at_end(); ++it, ++count)
+  {
+    const auto c = it.template combination<unsigned char>();
+    const std::string current = to_string(c);
+    if (print)
+      std::cout << "  " << current;
+    if (it.rank() != count)
+      throw std::logic_error("Revolving door rank wrong");
+    if (it.index() != combinations.index(c))
+      throw std::logic_error("Revolving door index wrong");
+    if (visited[it.index()])
+      throw std::logic_error("Combination visited twice");
+    visited[it.index()] = true;
+    for (unsigned int i = 0; i < k; ++i)
+      if (it.in(i) != c.in(i))
+        throw std::logic_error("Members differ");
+
+    if (count > 0)
+    {
+      // Exactly one member exchanged, as reported by added() and removed()
+      if (print)
+        std::cout << " -" << it.removed() << " +" << it.added();
+      auto expected = combinations[combinations.index(c)];
+      unsigned int changes = 0;
+      for (unsigned int i = 0; i < k; ++i)
+      {
+        if (previous.find(char('0' + expected.in(i))) >= k)
+          ++changes;
+        if (expected.in(i) == it.removed())
+          throw std::logic_error("Removed element still there");
+      }
+      if (previous.find(char('0' + it.removed())) >= k)
+        throw std::logic_error("Removed element was not there");
+      if (changes != 1 || previous.find(char('0' + it.added())) < k)
+        throw std::logic_error("Not a single exchange");
+    }
+    if (print)
+      std::cout << std::endl;
+    previous = current;
+  }
+  if (count != combinations.size())
+    throw std::logic_error("Revolving door walk incomplete");
+}
+
+int main()
+{
+  test<5, 0>(true);
+  test<5, 1>(true);
+  test<5, 2>(true);
+  test<5, 3>(true);
+  test<5, 4>(true);
+  test<5, 5>(true);
+  test<6, 3>(true);
+  test<8, 4>(false);
+  test<10, 5>(false);
+  test<10, 6>(false);
+
+  // The iterator may be used in constant expressions
+  constexpr auto last = [] {
+    TPCC::CombinationIterator<6, 3> it(TPCC::CombinationOrder::revolving_door);
+    unsigned int index = 0;
+    for (; !it.at_end(); ++it)
+      index = it.index();
+    return index;
+  }();
+  std::cout << "Last index in revolving door order for n=6, k=3: " << last << std::endl;
+  return 0;
+}
@@ -0,0 +1,128 @@
+// Unit test:
+// Maps from primal cells to their duals in the dual grid
+
+// For all k, the dual of each primal cell must have the complementary orientation and the same
+// center, with the dual nodes at the centers of primal cells. Compare dual_index() with the
+// dual element, dual_indices() and the runs with dual_index(), and primal_index() with the
+// inverse. Check vmult() and Tvmult() of a diagonal entry by entry.
+
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <tpcc/dual.h>
+
+/// Twice the coordinates of the center of `e`, shifted by `shift` in each direction
+template <int n, class E>
+std::array<int, n> center(const E& e, int shift, const std::array<unsigned short, n>& period)
+{
+  std::array<int, n> result;
+  for (unsigned int d = 0; d < n; ++d)
+    result[d] = 2 * e[d] + shift;
+  for (unsigned int i = 0; i < e.n_facets() / 2; ++i)
+    ++result[e.along_direction(i)];
+  for (unsigned int d = 0; d < n; ++d)
+    if (period[d] > 0)
+      result[d] = (result[d] + 2 * period[d]) % (2 * period[d]);
+  return result;
+}
+
+template <int n, int k>
+void test_dimension(const std::array<unsigned short, n>& dim, const std::array<bool, n>& periodic)
+{
+  const TPCC::Lexicographic<n, k> primal(dim, periodic);
+  const TPCC::DualMap<n, k> map(primal);
+  const auto& dual = map.dual();
+  std::array<unsigned short, n> period;
+  for (unsigned int d = 0; d < n; ++d)
+  {
+    period[d] = periodic[d] ? dim[d] : 0;
+    if (dual.fiber_dimension(d) != dim[d] + (periodic[d] ? 0 : 1))
+      throw std::logic_error("Wrong dual dimension");
+  }
+
+  std::vector<unsigned int> indices(primal.size());
+  map.dual_indices(0, primal.size(), indices.data());
+  std::vector<unsigned int> from_runs(primal.size(), primal.size());
+  map.for_each_run([&](unsigned int p, unsigned int d, unsigned int count, int stride) {
+    for (unsigned int i = 0; i < count; ++i, d += stride)
+      from_runs[p + i] = d;
+  });
+  std::vector<unsigned int> back(dual.size(), map.invalid);
+  for (unsigned int i = 0; i < primal.size(); ++i)
+  {
+    const auto e = primal[i];
+    const auto f = map.dual_element(e);
+    const unsigned int j = map.dual_index(i);
+    if (dual.index(f) != j || indices[i] != j || from_runs[i] != j)
+      throw std::logic_error("Dual index differs");
+    // Dual nodes are half a primal cell lower
+    if (center<n>(e, 0, period) != center<n>(dual[j], -1, period))
+      throw std::logic_error("Dual centered elsewhere");
+    for (unsigned int a = 0; a < n - k; ++a)
+      for (unsigned int b = 0; b < k; ++b)
+        if (f.along_direction(a) == e.along_direction(b))
+          throw std::logic_error("Orientations not complementary");
+    if (back[j] != map.invalid)
+      throw std::logic_error("Dual index not unique");
+    back[j] = i;
+  }
+  for (unsigned int j = 0; j < dual.size(); ++j)
+    if (map.primal_index(j) != back[j])
+      throw std::logic_error("Wrong primal index");
+
+  std::vector<unsigned int> part(3);
+  if (primal.size() > 5)
+  {
+    map.dual_indices(2, 5, part.data());
+    for (unsigned int i = 0; i < 3; ++i)
+      if (part[i] != indices[2 + i])
+        throw std::logic_error("Partial dual indices differ");
+  }
+
+  std::vector<double> diagonal(primal.size()), x(primal.size()), y(dual.size(), -1.),
+    z(primal.size());
+  for (unsigned int i = 0; i < primal.size(); ++i)
+  {
+    diagonal[i] = 1. + i % 7;
+    x[i] = 3. - i;
+  }
+  map.vmult(y.data(), x.data(), diagonal.data());
+  map.Tvmult(z.data(), y.data(), diagonal.data());
+  for (unsigned int j = 0; j < dual.size(); ++j)
+  {
+    const unsigned int i = back[j];
+    if (i == map.invalid ? y[j] != -1. : y[j] != diagonal[i] * x[i])
+      throw std::logic_error("Wrong vmult");
+  }
+  for (unsigned int i = 0; i < primal.size(); ++i)
+    if (z[i] != diagonal[i] * diagonal[i] * x[i])
+      throw std::logic_error("Wrong Tvmult");
+
+  std::cout << "  k=" << k << " primal " << primal.size() << " dual " << dual.size()
+            << std::endl;
+}
+
+template <int n, int... k>
+void test(const std::array<unsigned short, n>& dim, const std::array<bool, n>& periodic,
+          std::integer_sequence<int, k...>)
+{
+  std::cout << "n=" << n << " periodic";
+  for (unsigned int d = 0; d < n; ++d)
+    std::cout << ' ' << periodic[d];
+  std::cout << std::endl;
+  (test_dimension<n, k>(dim, periodic), ...);
+}
+
+int main()
+{
+  test<1>({ { 5 } }, { { false } }, std::make_integer_sequence<int, 2>());
+  test<1>({ { 5 } }, { { true } }, std::make_integer_sequence<int, 2>());
+  test<2>({ { 4, 3 } }, { { false, false } }, std::make_integer_sequence<int, 3>());
+  test<2>({ { 4, 3 } }, { { true, false } }, std::make_integer_sequence<int, 3>());
+  test<3>({ { 3, 4, 5 } }, { { false, false, false } }, std::make_integer_sequence<int, 4>());
+  test<3>({ { 3, 4, 5 } }, { { false, true, true } }, std::make_integer_sequence<int, 4>());
+  test<4>({ { 2, 3, 2, 3 } }, { { false, false, true, false } },
+          std::make_integer_sequence<int, 5>());
+}
@@ -0,0 +1,89 @@
+// Unit test:
+// Memory layout of Element and Combination with small integer types
+// Element::facet() with Combination<n,k,Tint>
+
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+#include <tpcc/lexicographic.h>
+
+static_assert(sizeof(TPCC::Combination<4, 2, unsigned char>) == 4,
+              "Combination must store exactly n values");
+static_assert(sizeof(TPCC::Element<1, 1>) <= 8, "Element<1,1> too large");
+static_assert(sizeof(TPCC::Element<2, 2>) <= 8, "Element<2,2> too large");
+static_assert(sizeof(TPCC::Element<3, 2>) <= 16, "Element<3,2> too large");
+static_assert(sizeof(TPCC::Element<4, 0>) <= 16, "Element<4,0> too large");
+static_assert(sizeof(TPCC::Element<4, 4>) <= 16, "Element<4,4> too large");
+
+template <int n, int k>
+void test_combination()
+{
+  TPCC::Combinations<n, k> combinations;
+  for (unsigned int i = 0; i < combinations.size(); ++i)
+  {
+    TPCC::Combination<n, k> c = combinations[i];
+    TPCC::Combination<n, k, unsigned char> cc(c);
+    if (combinations.index(cc) != i)
+      throw std::logic_error("Index of compact combination differs");
+    if constexpr (k > 0)
+      for (unsigned int j = 0; j < k; ++j)
+      {
+        std::stringstream os1, os2;
+        c.eliminate(j).print_debug(os1);
+        cc.eliminate(j).print_debug(os2);
+        if (os1.str() != os2.str())
+          throw std::logic_error("Compact eliminate() differs");
+      }
+    if constexpr (k < n)
+      for (unsigned int j = 0; j < n - k; ++j)
+      {
+        std::stringstream os1, os2;
+        c.add(c.out(j)).print_debug(os1);
+        cc.add(cc.out(j)).print_debug(os2);
+        if (os1.str() != os2.str())
+          throw std::logic_error("Compact add() differs");
+      }
+  }
+}
+
+template <class MESH>
+void test_mesh(const MESH& mesh)
+{
+  std::cout << "Mesh-Dim: " << (unsigned int)mesh.order()
+            << " Element-Dim: " << (unsigned int)mesh.cell_dimension()
+            << " sizeof(Element): " << sizeof(typename MESH::value_type) << std::endl;
+  auto boundary = mesh.boundary();
+  for (unsigned int i = 0; i < mesh.size(); ++i)
+  {
+    auto element = mesh[i];
+    if (mesh.index(element) != i)
+      throw std::logic_error("Index of element differs");
+    for (unsigned int f = 0; f < element.n_facets(); ++f)
+    {
+      auto facet = element.facet(f);
+      std::stringstream os1, os2;
+      facet.print_debug(os1);
+      boundary[boundary.index(facet)].print_debug(os2);
+      if (os1.str() != os2.str())
+        throw std::logic_error("Facet not found in boundary");
+    }
+  }
+}
+
+int main()
+{
+  test_combination<4, 0>();
+  test_combination<4, 1>();
+  test_combination<4, 2>();
+  test_combination<4, 3>();
+  test_combination<4, 4>();
+
+  constexpr std::array<unsigned short, 4> dim4{ { 1, 2, 3, 4 } };
+  test_mesh(TPCC::Lexicographic<4, 4>(dim4));
+  test_mesh(TPCC::Lexicographic<4, 3>(dim4));
+  test_mesh(TPCC::Lexicographic<4, 2>(dim4));
+  test_mesh(TPCC::Lexicographic<4, 1>(dim4));
+  return 0;
+}
@@ -0,0 +1,85 @@
+// Unit test:
+// ElementBlock::fill()
+// ElementBlock::index()
+// ElementBlock::transform()
+
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+#include <tpcc/element_block.h>
+
+constexpr std::array<unsigned short, 2> dim2{ { 2, 3 } };
+constexpr std::array<unsigned short, 3> dim3{ { 2, 3, 4 } };
+constexpr std::array<unsigned short, 4> dim4{ { 1, 2, 3, 4 } };
+
+template <class E>
+std::string to_string(const E& e)
+{
+  std::stringstream os;
+  e.print_debug(os);
+  return os.str();
+}
+
+template <int n, int k>
+void test(const std::array<unsigned short, n>& dim)
+{
+  typedef TPCC::Lexicographic<n, k> Mesh;
+  Mesh mesh(dim);
+  std::cout << "Mesh-Dim: " << n << " Element-Dim: " << k << " Size: " << mesh.size()
+            << std::endl;
+
+  // Fill with the whole mesh in two ranges splitting a block
+  TPCC::ElementBlock<n, k> block;
+  const unsigned int split = mesh.size() / 3 + 1;
+  block.fill(mesh, 0, split);
+  block.fill(mesh, split, mesh.size());
+  if (block.size() != mesh.size())
+    throw std::logic_error("Wrong size of block");
+  for (unsigned int i = 0; i < mesh.size(); ++i)
+    if (to_string(block[i]) != to_string(mesh[i]))
+      throw std::logic_error("Element in block differs");
+  auto indices = block.index(mesh);
+  for (unsigned int i = 0; i < mesh.size(); ++i)
+    if (indices[i] != i)
+      throw std::logic_error("Index from block differs");
+
+  // Fill with every third element in reverse order
+  std::vector<unsigned int> list;
+  for (unsigned int i = mesh.size(); i > 0; i -= std::min(i, 3u))
+    list.push_back(i - 1);
+  TPCC::ElementBlock<n, k> sparse;
+  sparse.fill(mesh, list);
+  if (sparse.index(mesh) != list)
+    throw std::logic_error("Index of sparse block differs");
+
+  // Shift all coordinates in direction 0 by one and compare to shifted element
+  for (unsigned int i = 0; i < sparse.size(); ++i)
+    if (sparse.coordinate(0)[i] != mesh[list[i]][0])
+      throw std::logic_error("Coordinate column differs");
+  sparse.transform(0, [](unsigned short c) { return c + 1; });
+  for (unsigned int i = 0; i < sparse.size(); ++i)
+    if (sparse.coordinate(0)[i] != mesh[list[i]][0] + 1)
+      throw std::logic_error("Transformed coordinate differs");
+
+  for (unsigned int i = 0; i < std::min<unsigned int>(block.size(), 6); ++i)
+  {
+    std::cout << std::setw(4) << i << " orientation " << (unsigned int)block.orientation()[i];
+    block[i].print_debug(std::cout);
+    std::cout << std::endl;
+  }
+}
+
+int main()
+{
+  test<2, 0>(dim2);
+  test<2, 1>(dim2);
+  test<2, 2>(dim2);
+  test<3, 0>(dim3);
+  test<3, 1>(dim3);
+  test<3, 2>(dim3);
+  test<3, 3>(dim3);
+  test<4, 2>(dim4);
+  return 0;
+}
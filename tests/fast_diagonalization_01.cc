@@ -0,0 +1,116 @@
+// Unit test:
+// Fast diagonalization of the Laplacian on a Lexicographic complex
+
+// Solve with the inverse and apply the Kronecker operator to the solution. For the singular
+// Laplacian on vertices, check that the pseudo-inverse reproduces the right hand side up to its
+// mean value. Threaded and serial solves must agree, also with fewer fibers than threads in the
+// first direction. Long fibers check the convergence of the eigensolver, and operators which are
+// not separable by blocks must be rejected.
+
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+#include <tpcc/fast_diagonalization.h>
+
+template <int n, int k>
+void test(const std::array<unsigned short, n>& dim, const std::array<bool, n>& periodic,
+          double shift, unsigned int n_threads = 3)
+{
+  TPCC::Lexicographic<n, k> mesh(dim, periodic);
+  auto op = TPCC::laplacian_operator(mesh);
+  TPCC::FastDiagonalization<n> inverse(op, shift);
+
+  // Apply the operator with the same shift
+  if (shift != 0.)
+    for (unsigned char b = 0; b < mesh.n_blocks(); ++b)
+    {
+      const auto layout = op.domain_layout(b);
+      std::array<unsigned int, n> factors;
+      for (unsigned int d = 0; d < n; ++d)
+        factors[d] = op.identity_factor(layout.extents[d]);
+      op.add_term(b, b, shift, factors);
+    }
+
+  const unsigned int N = mesh.size();
+  std::vector<double> b(N), x(N), y(N), z(N);
+  double mean = 0.;
+  for (unsigned int i = 0; i < N; ++i)
+  {
+    b[i] = std::cos(0.3 + 1.7 * i);
+    mean += b[i] / N;
+  }
+  inverse.vmult(x.data(), b.data());
+  op.vmult(y.data(), x.data());
+
+  // Only the vertex Laplacian without shift has a kernel, the constants
+  const bool singular = (k == 0 && shift == 0.);
+  double error = 0.;
+  for (unsigned int i = 0; i < N; ++i)
+    error = std::max(error, std::fabs(y[i] - b[i] + (singular ? mean : 0.)));
+
+  inverse.vmult(z.data(), b.data(), n_threads);
+  double difference = 0.;
+  for (unsigned int i = 0; i < N; ++i)
+    difference = std::max(difference, std::fabs(z[i] - x[i]));
+
+  std::cout << "n=" << n << " k=" << k << " shift " << shift << " cells " << N
+            << " eigensystems " << inverse.n_eigensystems() << std::endl;
+  if (error > 1.e-10)
+  {
+    std::cout << "Residual " << error << std::endl;
+    throw std::logic_error("Wrong solution");
+  }
+  if (difference > 1.e-12)
+    throw std::logic_error("Threaded solution differs");
+}
+
+template <int n>
+void test_invalid(const std::array<unsigned short, n>& dim)
+{
+  TPCC::Lexicographic<n, 0> mesh(dim);
+  auto op = TPCC::laplacian_operator(mesh);
+
+  // A term coupling all directions at once
+  std::array<unsigned int, n> factors;
+  for (unsigned int d = 0; d < n; ++d)
+  {
+    const std::vector<double> diagonal(dim[d] + 1, 2.);
+    factors[d] = op.add_factor(TPCC::FiberMatrix<double>::diagonal(diagonal));
+  }
+  op.add_term(0, 0, 1., factors);
+
+  bool thrown = false;
+  try
+  {
+    TPCC::FastDiagonalization<n> inverse(op);
+  }
+  catch (const std::invalid_argument&)
+  {
+    thrown = true;
+  }
+  if (!thrown)
+    throw std::logic_error("Non-separable operator accepted");
+}
+
+int main()
+{
+  test<1, 0>({ { 7 } }, { { false } }, 0.);
+  test<1, 1>({ { 7 } }, { { false } }, 0.);
+  test<2, 0>({ { 5, 8 } }, { { false, false } }, 0.);
+  test<2, 0>({ { 5, 8 } }, { { false, true } }, 0.5);
+  test<2, 1>({ { 5, 8 } }, { { false, false } }, 0.);
+  test<2, 1>({ { 6, 6 } }, { { false, false } }, 0.);
+  test<2, 2>({ { 5, 8 } }, { { true, false } }, 1.);
+  test<3, 1>({ { 4, 5, 6 } }, { { false, false, false } }, 0.);
+  test<3, 2>({ { 4, 5, 6 } }, { { false, false, false } }, 0.);
+  test<3, 2>({ { 9, 9, 9 } }, { { false, false, false } }, 0.);
+  test<3, 3>({ { 4, 5, 6 } }, { { false, false, false } }, 0.);
+  test<1, 0>({ { 400 } }, { { false } }, 0.25);
+  test<1, 1>({ { 400 } }, { { true } }, 0.25);
+  test<2, 1>({ { 3, 300 } }, { { false, true } }, 0.5);
+  // Fewer fibers than threads in the first direction, which cannot be split
+  test<2, 2>({ { 700, 7 } }, { { false, false } }, 0.5, 8);
+  test_invalid<2>({ { 3, 4 } });
+}
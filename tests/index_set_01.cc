@@ -0,0 +1,187 @@
+// Unit test:
+// Index sets stored as strided runs
+
+// Compare set operations, rank and select with sorted vectors of indices, and the sets of
+// blocks, windows and slabs with the indices obtained by enumerating the elements.
+
+#include <algorithm>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <tpcc/index_set.h>
+
+typedef TPCC::IndexSet<unsigned int> Set;
+
+std::vector<unsigned int> to_vector(const Set& set)
+{
+  return std::vector<unsigned int>(set.begin(), set.end());
+}
+
+Set from_vector(const std::vector<unsigned int>& v)
+{
+  Set result;
+  for (unsigned int i : v)
+    result.push_back(i);
+  return result;
+}
+
+void check(const Set& set, const std::vector<unsigned int>& expected, const char* what)
+{
+  if (to_vector(set) != expected || set.size() != expected.size())
+  {
+    std::cout << what << ":";
+    for (unsigned int i : set)
+      std::cout << ' ' << i;
+    std::cout << "\nexpected:";
+    for (unsigned int i : expected)
+      std::cout << ' ' << i;
+    std::cout << std::endl;
+    throw std::logic_error("Wrong index set");
+  }
+}
+
+void check_queries(const Set& set, const std::vector<unsigned int>& v, unsigned int bound)
+{
+  for (unsigned int i = 0; i < v.size(); ++i)
+    if (set.select(i) != v[i])
+      throw std::logic_error("Wrong select");
+  for (unsigned int x = 0; x < bound; ++x)
+  {
+    const unsigned int rank = std::lower_bound(v.begin(), v.end(), x) - v.begin();
+    if (set.rank(x) != rank)
+      throw std::logic_error("Wrong rank");
+    if (set.contains(x) != std::binary_search(v.begin(), v.end(), x))
+      throw std::logic_error("Wrong contains");
+  }
+}
+
+/// Random unions of strided runs
+std::vector<unsigned int> random_set(std::mt19937& gen, unsigned int bound)
+{
+  std::vector<unsigned int> result;
+  std::uniform_int_distribution<unsigned int> position(0, bound - 1), stride(1, 4), count(1, 8);
+  for (unsigned int r = 0; r < 5; ++r)
+  {
+    const unsigned int first = position(gen), s = stride(gen), c = count(gen);
+    for (unsigned int i = 0; i < c && first + i * s < bound; ++i)
+      result.push_back(first + i * s);
+  }
+  std::sort(result.begin(), result.end());
+  result.erase(std::unique(result.begin(), result.end()), result.end());
+  return result;
+}
+
+void test_operations()
+{
+  Set strided;
+  strided.push_back(3, 5, 2);
+  strided.push_back(13, 2, 2);
+  strided.push_back(20);
+  strided.push_back(22);
+  check(strided, { 3, 5, 7, 9, 11, 13, 15, 20, 22 }, "push_back");
+  std::cout << "push_back: " << strided.n_runs() << " runs" << std::endl;
+  if (strided.n_runs() != 2)
+    throw std::logic_error("Runs not merged");
+
+  std::mt19937 gen(42);
+  const unsigned int bound = 60;
+  for (unsigned int t = 0; t < 500; ++t)
+  {
+    const auto a = random_set(gen, bound);
+    const auto b = random_set(gen, bound);
+    const Set sa = from_vector(a), sb = from_vector(b);
+    check(sa, a, "from_vector");
+    check_queries(sa, a, bound + 2);
+
+    std::vector<unsigned int> u, i, d;
+    std::set_union(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(u));
+    std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(i));
+    std::set_difference(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(d));
+    const Set su = sa | sb, si = sa & sb, sd = sa - sb;
+    check(su, u, "union");
+    check(si, i, "intersection");
+    check(sd, d, "difference");
+    check_queries(su, u, bound + 2);
+    check_queries(sd, d, bound + 2);
+    if ((su - si) != ((sa - sb) | (sb - sa)))
+      throw std::logic_error("Symmetric difference");
+  }
+  std::cout << "Operations ok" << std::endl;
+}
+
+template <int n, int k>
+void test_mesh(const std::array<unsigned short, n>& dim, const std::array<bool, n>& periodic)
+{
+  TPCC::Lexicographic<n, k> mesh(dim, periodic);
+  Set all;
+  for (unsigned char b = 0; b < mesh.n_blocks(); ++b)
+  {
+    const Set block = TPCC::block_index_set(mesh, b);
+    if (block.n_runs() != 1 || block.size() != mesh.block_size(b))
+      throw std::logic_error("Wrong block set");
+    all = all | block;
+  }
+  if (all != Set::interval(0, mesh.size()) || all.n_runs() != 1)
+    throw std::logic_error("Blocks do not cover the mesh");
+
+  // A window touching the lower boundary in some directions and the upper in direction 0
+  std::array<unsigned short, n> lower, upper;
+  for (unsigned int d = 0; d < n; ++d)
+  {
+    lower[d] = (d == 1) ? 1 : 0;
+    upper[d] = (d == 0) ? dim[d] + 1 : dim[d] - 1;
+  }
+  const Set window = TPCC::window_index_set(mesh, lower, upper);
+  std::vector<unsigned int> expected;
+  for (unsigned int i = 0; i < mesh.size(); ++i)
+  {
+    const auto e = mesh[i];
+    bool inside = true;
+    for (unsigned int d = 0; d < n; ++d)
+      inside = inside && e[d] >= lower[d] && e[d] < upper[d];
+    if (inside)
+      expected.push_back(i);
+  }
+  check(window, expected, "window");
+  std::cout << "n=" << n << " k=" << k << " window " << window.size() << " cells in "
+            << window.n_runs() << " runs" << std::endl;
+
+  // Slabs in all normal directions
+  if constexpr (k >= 1)
+    for (unsigned char normal = 0; normal < n; ++normal)
+    {
+      std::array<unsigned char, n - 1> directions;
+      std::array<bool, n - 1> reverse;
+      for (unsigned int d = 0, i = 0; d < n; ++d)
+        if (d != normal)
+        {
+          directions[n - 2 - i] = d;
+          reverse[n - 2 - i] = (i % 2 == 1);
+          ++i;
+        }
+      TPCC::Slab<n, k> slab(mesh, directions, reverse, normal, dim[normal] / 2);
+      const Set set = TPCC::slab_index_set(slab);
+      std::vector<unsigned int> indices;
+      for (unsigned int i = 0; i < slab.size(); ++i)
+        indices.push_back(mesh.index(slab[i]));
+      std::sort(indices.begin(), indices.end());
+      check(set, indices, "slab");
+      std::cout << "n=" << n << " k=" << k << " slab normal " << int(normal) << ' ' << set.size()
+                << " cells in " << set.n_runs() << " runs" << std::endl;
+    }
+}
+
+int main()
+{
+  test_operations();
+  test_mesh<2, 0>({ { 4, 3 } }, { { false, false } });
+  test_mesh<2, 1>({ { 4, 3 } }, { { false, true } });
+  test_mesh<2, 2>({ { 4, 3 } }, { { false, false } });
+  test_mesh<3, 1>({ { 3, 4, 5 } }, { { false, false, false } });
+  test_mesh<3, 2>({ { 3, 4, 5 } }, { { true, false, false } });
+  test_mesh<3, 3>({ { 3, 4, 5 } }, { { false, false, true } });
+  test_mesh<4, 2>({ { 2, 3, 2, 3 } }, { { false, false, false, false } });
+}
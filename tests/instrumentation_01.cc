@@ -0,0 +1,76 @@
+// Unit test:
+// Counting calls with TPCC_INSTRUMENT
+
+// Enumerate a complex and its facets in the main thread and in a second thread, and check the
+// merged counters. Scopes of orders beyond max_order must only count in the overflow counter.
+// Times are not printed, since they vary.
+
+#ifndef TPCC_INSTRUMENT
+#define TPCC_INSTRUMENT
+#endif
+
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+
+#include <tpcc/lexicographic.h>
+#include <tpcc/slab.h>
+
+using namespace TPCC::Instrumentation;
+
+template <int n, int k>
+void enumerate(const std::array<unsigned short, n>& dim)
+{
+  TPCC::Lexicographic<n, k> mesh(dim);
+  auto boundary = mesh.boundary();
+  for (unsigned int i = 0; i < mesh.size(); ++i)
+  {
+    const auto e = mesh[i];
+    for (unsigned int f = 0; f < e.n_facets(); ++f)
+      boundary.index(e.facet(f));
+  }
+}
+
+template <int n, int k>
+void check(Function f, std::uint64_t expected)
+{
+  const std::uint64_t calls = counter(f, n, k).calls;
+  std::cout << "n=" << n << " k=" << k << ' ' << function_name(f) << ' ' << calls << std::endl;
+  if (calls != expected)
+    throw std::logic_error("Wrong number of calls");
+}
+
+int main()
+{
+  reset();
+  const std::array<unsigned short, 2> dim2{ { 3, 4 } };
+  enumerate<2, 1>(dim2);
+  std::thread thread(enumerate<2, 1>, dim2);
+  thread.join();
+
+  // Twice the 31 edges, each with two facets
+  check<2, 1>(lexicographic_access, 62);
+  check<2, 1>(element_facet, 124);
+  check<2, 0>(lexicographic_index, 124);
+  check<2, 0>(combinations_index, 124);
+  check<2, 1>(combinations_index, 0);
+
+  const std::array<unsigned short, 3> dim3{ { 2, 2, 2 } };
+  TPCC::Lexicographic<3, 2> mesh(dim3);
+  TPCC::Slab<3, 2> slab(mesh, { { 1, 2 } }, { { false, false } }, 0, 1);
+  for (unsigned int i = 0; i < slab.size(); ++i)
+    slab[i];
+  check<3, 2>(slab_access, slab.size());
+  check<3, 2>(lexicographic_access, 0);
+
+  for (unsigned int i = 0; i < 3; ++i)
+  {
+    Scope large(lexicographic_access, max_order + i, max_order);
+  }
+  check<max_order + 1, 0>(lexicographic_access, 3);
+  check<max_order - 1, 0>(lexicographic_access, 0);
+  check<0, 0>(lexicographic_access, 0);
+
+  report(std::cerr);
+  return 0;
+}
@@ -0,0 +1,200 @@
+// Unit test:
+// Kronecker-factored boundary, diagonal and Laplace operators
+
+// Compare the application of the operators with dense matrices assembled element by element
+// through Element::facet() and Lexicographic::index(). On a long fiber, the factors of the
+// Laplacian must stay tridiagonal, and vmult_add() with a workspace must agree with vmult().
+
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+#include <tpcc/kronecker.h>
+
+/// A dense matrix stored row by row
+struct Dense
+{
+  unsigned int rows, cols;
+  std::vector<double> values;
+
+  Dense(unsigned int rows, unsigned int cols)
+    : rows(rows)
+    , cols(cols)
+    , values(rows * cols)
+  {
+  }
+  double& operator()(unsigned int i, unsigned int j) { return values[i * cols + j]; }
+  double operator()(unsigned int i, unsigned int j) const { return values[i * cols + j]; }
+
+  std::vector<double> vmult(const std::vector<double>& x) const
+  {
+    std::vector<double> y(rows);
+    for (unsigned int i = 0; i < rows; ++i)
+      for (unsigned int j = 0; j < cols; ++j)
+        y[i] += (*this)(i, j) * x[j];
+    return y;
+  }
+};
+
+/// The boundary matrix of the `k`-cells, assembled from the facets of each cell
+template <int n, int k>
+Dense boundary_matrix(const TPCC::Lexicographic<n, k>& mesh)
+{
+  const auto facets = mesh.boundary();
+  Dense result(facets.size(), mesh.size());
+  for (unsigned int i = 0; i < mesh.size(); ++i)
+  {
+    const auto e = mesh[i];
+    for (unsigned int f = 0; f < e.n_facets(); ++f)
+    {
+      const double sign = ((f / 2) % 2 == 0) ? 1. : -1.;
+      result(facets.index(e.facet(f)), i) += (f % 2 == 1) ? sign : -sign;
+    }
+  }
+  return result;
+}
+
+template <int n, int k>
+Dense laplacian_matrix(const std::array<unsigned short, n>& dim,
+                       const std::array<bool, n>& periodic,
+                       const std::array<unsigned char, n>& order)
+{
+  TPCC::Lexicographic<n, k> mesh(dim, periodic, order);
+  Dense result(mesh.size(), mesh.size());
+  if constexpr (k > 0)
+  {
+    const Dense B = boundary_matrix(mesh);
+    for (unsigned int i = 0; i < B.cols; ++i)
+      for (unsigned int j = 0; j < B.cols; ++j)
+        for (unsigned int l = 0; l < B.rows; ++l)
+          result(i, j) += B(l, i) * B(l, j);
+  }
+  if constexpr (k < n)
+  {
+    TPCC::Lexicographic<n, k + 1> up(dim, periodic, order);
+    const Dense B = boundary_matrix(up);
+    for (unsigned int i = 0; i < B.rows; ++i)
+      for (unsigned int j = 0; j < B.rows; ++j)
+        for (unsigned int l = 0; l < B.cols; ++l)
+          result(i, j) += B(i, l) * B(j, l);
+  }
+  return result;
+}
+
+template <class OP>
+void compare(const OP& op, const Dense& A, const char* name)
+{
+  if (op.n_rows() != A.rows || op.n_cols() != A.cols)
+    throw std::logic_error("Wrong operator size");
+  std::vector<double> x(A.cols), y(A.rows);
+  for (unsigned int j = 0; j < x.size(); ++j)
+    x[j] = std::sin(1. + 0.7 * j);
+  op.vmult(y.data(), x.data());
+  const auto expected = A.vmult(x);
+  double error = 0.;
+  for (unsigned int i = 0; i < y.size(); ++i)
+    error = std::max(error, std::fabs(y[i] - expected[i]));
+  if (error > 1.e-12)
+  {
+    std::cout << name << " error " << error << std::endl;
+    throw std::logic_error("Operators differ");
+  }
+}
+
+template <int n, int k>
+void test(const std::array<unsigned short, n>& dim, const std::array<bool, n>& periodic,
+          const std::array<unsigned char, n>& order)
+{
+  TPCC::Lexicographic<n, k> mesh(dim, periodic, order);
+  unsigned int terms = 0;
+  if constexpr (k > 0)
+  {
+    const auto boundary = TPCC::boundary_operator(mesh);
+    compare(boundary, boundary_matrix(mesh), "boundary");
+    terms += boundary.n_terms();
+  }
+
+  const auto laplacian = TPCC::laplacian_operator(mesh);
+  compare(laplacian, laplacian_matrix<n, k>(dim, periodic, order), "laplacian");
+  terms += laplacian.n_terms();
+
+  std::array<std::vector<double>, n> along, across;
+  for (unsigned int d = 0; d < n; ++d)
+  {
+    for (unsigned int x = 0; x < mesh.fiber_dimension(d); ++x)
+      along[d].push_back(1. + d + 0.1 * x);
+    for (unsigned int x = 0; x < mesh.across_extent(d); ++x)
+      across[d].push_back(2. - 0.01 * (d + x));
+  }
+  const auto diagonal = TPCC::diagonal_operator(mesh, along, across);
+  Dense D(mesh.size(), mesh.size());
+  for (unsigned int i = 0; i < mesh.size(); ++i)
+  {
+    const auto e = mesh[i];
+    D(i, i) = 1.;
+    for (unsigned int j = 0; j < k; ++j)
+      D(i, i) *= along[e.along_direction(j)][e.along_coordinate(j)];
+    for (unsigned int j = 0; j < n - k; ++j)
+      D(i, i) *= across[e.across_direction(j)][e.across_coordinate(j)];
+  }
+  compare(diagonal, D, "diagonal");
+  terms += diagonal.n_terms();
+
+  std::cout << "n=" << n << " k=" << k << " cells " << mesh.size() << " terms " << terms
+            << std::endl;
+}
+
+template <int n>
+void test_all(const std::array<unsigned short, n>& dim, const std::array<bool, n>& periodic,
+              const std::array<unsigned char, n>& order)
+{
+  test<n, 0>(dim, periodic, order);
+  test<n, 1>(dim, periodic, order);
+  if constexpr (n >= 2)
+    test<n, 2>(dim, periodic, order);
+  if constexpr (n >= 3)
+    test<n, 3>(dim, periodic, order);
+}
+
+void test_long_fiber()
+{
+  const unsigned short m = 60000;
+  TPCC::Lexicographic<2, 1> mesh({ { m, 3 } }, { { true, false } });
+  const auto laplacian = TPCC::laplacian_operator(mesh);
+  std::size_t entries = 0, size = 0;
+  for (unsigned int t = 0; t < laplacian.n_terms(); ++t)
+    for (unsigned int d = 0; d < 2; ++d)
+    {
+      const auto& A = laplacian.factor(laplacian.term(t).factors[d]);
+      if (!A.is_identity && A.rows >= m)
+      {
+        entries = std::max(entries, A.n_nonzero_elements());
+        size = std::max<std::size_t>(size, A.rows);
+      }
+    }
+  std::cout << "Long fiber " << size << " entries " << entries << std::endl;
+  if (entries > 3 * size)
+    throw std::logic_error("Fiber Laplacian not sparse");
+
+  std::vector<double> x(mesh.size()), y(mesh.size()), z(mesh.size());
+  for (unsigned int j = 0; j < x.size(); ++j)
+    x[j] = std::cos(0.3 * j);
+  laplacian.vmult(y.data(), x.data());
+  std::vector<double> workspace(laplacian.workspace_size());
+  laplacian.vmult_add(z.data(), x.data(), workspace.data());
+  if (y != z)
+    throw std::logic_error("Workspace variant differs");
+}
+
+int main()
+{
+  test_long_fiber();
+  test_all<1>({ { 5 } }, { { false } }, { { 0 } });
+  test_all<1>({ { 5 } }, { { true } }, { { 0 } });
+  test_all<2>({ { 3, 4 } }, { { false, false } }, { { 0, 1 } });
+  test_all<2>({ { 3, 4 } }, { { true, false } }, { { 1, 0 } });
+  test_all<3>({ { 2, 3, 4 } }, { { false, false, false } }, { { 0, 1, 2 } });
+  test_all<3>({ { 2, 3, 4 } }, { { false, true, false } }, { { 2, 0, 1 } });
+  test_all<3>({ { 3, 1, 2 } }, { { true, true, false } }, { { 1, 2, 0 } });
+}
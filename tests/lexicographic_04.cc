@@ -0,0 +1,90 @@
+// Unit test:
+// Lexicographic::block_offset()
+// Lexicographic::block_layout()
+// BlockLayout::neighbor_offsets()
+
+// Loop over each block with nested loops and compare to Lexicographic::index(). Compare
+// neighbor offsets with the indices of shifted elements.
+
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+
+#include <tpcc/lexicographic.h>
+
+constexpr std::array<unsigned short, 2> dim2{ { 2, 3 } };
+constexpr std::array<unsigned short, 3> dim3{ { 2, 3, 4 } };
+constexpr std::array<unsigned short, 4> dim4{ { 3, 2, 4, 3 } };
+
+template <int n, int k>
+void test(const std::array<unsigned short, n>& dim)
+{
+  TPCC::Lexicographic<n, k> mesh(dim);
+  std::cout << "Mesh-Dim: " << n << " Element-Dim: " << k << std::endl;
+  for (unsigned int b = 0; b < mesh.n_blocks(); ++b)
+  {
+    const auto layout = mesh.block_layout(b);
+    std::cout << "  Block " << b << " offset " << std::setw(4) << layout.offset << " extents";
+    for (unsigned int d = 0; d < n; ++d)
+      std::cout << ' ' << layout.extents[d];
+    std::cout << " strides";
+    for (unsigned int d = 0; d < n; ++d)
+      std::cout << ' ' << layout.strides[d];
+    std::cout << std::endl;
+
+    if (layout.size() != mesh.block_size(b) || layout.offset != mesh.block_offset(b))
+      throw std::logic_error("Block size or offset wrong");
+
+    // Run through the block with an odometer in the order given by the layout
+    std::array<unsigned short, n> x{};
+    for (unsigned int i = 0; i < layout.size(); ++i)
+    {
+      const auto e = mesh[layout.offset + i];
+      for (unsigned int d = 0; d < n; ++d)
+        if (e[d] != x[d])
+          throw std::logic_error("Coordinates differ");
+      if (layout.index(x) != layout.offset + i)
+        throw std::logic_error("Index differs");
+      for (unsigned int j = 0; j < n; ++j)
+      {
+        if (++x[layout.order[j]] < layout.extents[layout.order[j]])
+          break;
+        x[layout.order[j]] = 0;
+      }
+    }
+
+    // Neighbors of an element in the interior, if there is one
+    bool interior = true;
+    for (unsigned int d = 0; d < n; ++d)
+    {
+      x[d] = 1;
+      interior = interior && layout.extents[d] > 2;
+    }
+    if (interior)
+    {
+      const auto offsets = layout.neighbor_offsets();
+      for (unsigned int i = 0; i < offsets.size(); ++i)
+      {
+        std::array<unsigned short, n> y = x;
+        for (unsigned int d = 0, code = i; d < n; ++d, code /= 3)
+          y[d] += code % 3 - 1;
+        if (layout.index(y) != layout.index(x) + offsets[i])
+          throw std::logic_error("Neighbor offset wrong");
+      }
+    }
+  }
+}
+
+int main()
+{
+  test<2, 0>(dim2);
+  test<2, 1>(dim2);
+  test<2, 2>(dim2);
+  test<3, 0>(dim3);
+  test<3, 1>(dim3);
+  test<3, 2>(dim3);
+  test<3, 3>(dim3);
+  test<4, 2>(dim4);
+  test<4, 3>(dim4);
+  return 0;
+}
@@ -0,0 +1,82 @@
+// Unit test:
+// Lexicographic with periodic directions
+
+// Check sizes, index() and operator[], and that facets in periodic directions wrap around.
+// For a complex periodic in all directions, the Euler characteristic vanishes.
+
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+
+#include <tpcc/lexicographic.h>
+
+constexpr std::array<unsigned short, 2> dim2{ { 2, 3 } };
+constexpr std::array<unsigned short, 3> dim3{ { 2, 3, 4 } };
+
+template <int n, int k>
+int test(const std::array<unsigned short, n>& dim, const std::array<bool, n>& periodic)
+{
+  TPCC::Lexicographic<n, k> mesh(dim, periodic);
+  std::cout << "Mesh-Dim: " << n << " Element-Dim: " << k << " periodic";
+  for (unsigned int d = 0; d < n; ++d)
+    std::cout << ' ' << periodic[d];
+  std::cout << " size " << mesh.size() << std::endl;
+
+  for (unsigned int i = 0; i < mesh.size(); ++i)
+  {
+    const auto e = mesh[i];
+    if (mesh.index(e) != i)
+      throw std::logic_error("Index differs");
+    for (unsigned int d = 0; d < n; ++d)
+      if (periodic[d] && e[d] >= dim[d])
+        throw std::logic_error("Duplicate coordinate in periodic direction");
+  }
+
+  if constexpr (k > 0)
+  {
+    auto boundary = mesh.boundary();
+    for (unsigned int i = 0; i < mesh.size(); ++i)
+    {
+      const auto e = mesh[i];
+      for (unsigned int f = 0; f < e.n_facets(); ++f)
+      {
+        const auto facet = e.facet(f);
+        const unsigned int fi = boundary.index(facet);
+        if (fi >= boundary.size())
+          throw std::logic_error("Facet index out of range");
+        const auto g = boundary[fi];
+        for (unsigned int d = 0; d < n; ++d)
+          if (g[d] != facet[d] && !(periodic[d] && facet[d] == dim[d] && g[d] == 0))
+            throw std::logic_error("Facet coordinates differ");
+      }
+    }
+  }
+  return (k % 2 == 0) ? mesh.size() : -int(mesh.size());
+}
+
+int main()
+{
+  const std::array<bool, 2> p2{ { true, false } };
+  test<2, 0>(dim2, p2);
+  test<2, 1>(dim2, p2);
+  test<2, 2>(dim2, p2);
+
+  const std::array<bool, 2> t2{ { true, true } };
+  int euler = test<2, 0>(dim2, t2) + test<2, 1>(dim2, t2) + test<2, 2>(dim2, t2);
+  std::cout << "Euler characteristic of the torus: " << euler << std::endl;
+  if (euler != 0)
+    throw std::logic_error("Euler characteristic of torus wrong");
+
+  const std::array<bool, 3> p3{ { false, true, false } };
+  test<3, 1>(dim3, p3);
+  test<3, 2>(dim3, p3);
+  test<3, 3>(dim3, p3);
+
+  const std::array<bool, 3> t3{ { true, true, true } };
+  euler = test<3, 0>(dim3, t3) + test<3, 1>(dim3, t3);
+  euler += test<3, 2>(dim3, t3) + test<3, 3>(dim3, t3);
+  std::cout << "Euler characteristic of the 3-torus: " << euler << std::endl;
+  if (euler != 0)
+    throw std::logic_error("Euler characteristic of torus wrong");
+  return 0;
+}
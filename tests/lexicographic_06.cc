@@ -0,0 +1,87 @@
+// Unit test:
+// Lexicographic with a permutation of directions
+
+// The fastest running coordinate in each block must follow the direction order. Check index(),
+// operator[] and that facets are found in the boundary with the same order.
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#include <tpcc/lexicographic.h>
+
+constexpr std::array<unsigned short, 3> dim3{ { 2, 3, 4 } };
+
+template <class E>
+std::string to_string(const E& e)
+{
+  std::stringstream os;
+  e.print_debug(os);
+  return os.str();
+}
+
+template <int k>
+void test(const std::array<unsigned char, 3>& order)
+{
+  TPCC::Lexicographic<3, k> mesh(dim3, {}, order);
+  TPCC::Lexicographic<3, k> standard(dim3);
+  std::cout << "Element-Dim: " << k << " order " << (int)order[0] << (int)order[1]
+            << (int)order[2] << std::endl;
+  if (mesh.size() != standard.size())
+    throw std::logic_error("Size depends on order");
+
+  for (unsigned int b = 0; b < mesh.n_blocks(); ++b)
+  {
+    const auto layout = mesh.block_layout(b);
+    // Along directions first, each group in the given order
+    for (unsigned int i = 0; i + 1 < 3; ++i)
+    {
+      const auto p0 = std::find(order.begin(), order.end(), layout.order[i]);
+      const auto p1 = std::find(order.begin(), order.end(), layout.order[i + 1]);
+      if (i + 1 != k && p0 > p1)
+        throw std::logic_error("Block order does not follow direction order");
+    }
+    // Consecutive elements differ in the fastest direction
+    const auto e0 = mesh[layout.offset];
+    const auto e1 = mesh[layout.offset + 1];
+    const unsigned int fast = layout.order[0];
+    std::cout << "  Block " << b << " fastest direction " << fast << std::endl;
+    if (e1[fast] != e0[fast] + 1)
+      throw std::logic_error("Fastest direction wrong");
+  }
+
+  std::vector<bool> found(mesh.size());
+  for (unsigned int i = 0; i < mesh.size(); ++i)
+  {
+    const auto e = mesh[i];
+    if (mesh.index(e) != i)
+      throw std::logic_error("Index differs");
+    // Each element is also in the standard enumeration
+    found[standard.index(e)] = true;
+    if constexpr (k > 0)
+    {
+      const auto boundary = mesh.boundary();
+      for (unsigned int f = 0; f < e.n_facets(); ++f)
+        if (to_string(boundary[boundary.index(e.facet(f))]) != to_string(e.facet(f)))
+          throw std::logic_error("Facet not found");
+    }
+  }
+  if (std::find(found.begin(), found.end(), false) != found.end())
+    throw std::logic_error("Not a permutation of the standard enumeration");
+}
+
+int main()
+{
+  std::array<unsigned char, 3> order{ { 0, 1, 2 } };
+  do
+  {
+    test<0>(order);
+    test<1>(order);
+    test<2>(order);
+    test<3>(order);
+  } while (std::next_permutation(order.begin(), order.end()));
+  return 0;
+}
@@ -0,0 +1,106 @@
+// Unit test:
+// Lexicographic for high tensor orders n=4..10
+
+// For all dimensions k, compare the size with the sum over all orientations computed from
+// bitmasks, and check operator[], index() and facets for a sample of elements, including the
+// first and last element of each orientation block. Combinations::operator[] and index() must
+// be inverse to each other and agree with CombinationIterator.
+
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+
+#include <tpcc/lexicographic.h>
+
+template <int n, int k>
+void test_combinations()
+{
+  TPCC::Combinations<n, k> combinations;
+  TPCC::CombinationIterator<n, k> it;
+  for (unsigned int i = 0; i < combinations.size(); ++i, ++it)
+  {
+    const auto c = combinations[i];
+    if (TPCC::Combinations<n, k>::index(c) != i || it.index() != i)
+      throw std::logic_error("Combination index differs");
+    for (unsigned int j = 0; j < k; ++j)
+      if (c.in(j) != it.in(j))
+        throw std::logic_error("Combination differs from iterator");
+  }
+  if (!it.at_end())
+    throw std::logic_error("Iterator not finished");
+}
+
+template <int n, int k>
+void test_mesh(unsigned int& checked)
+{
+  test_combinations<n, k>();
+
+  std::array<unsigned short, n> dim;
+  std::array<bool, n> periodic;
+  for (unsigned int d = 0; d < n; ++d)
+  {
+    dim[d] = 1 + d % 3;
+    periodic[d] = (d % 4 == 3);
+  }
+  TPCC::Lexicographic<n, k> mesh(dim, periodic);
+
+  unsigned int expected = 0;
+  for (unsigned int mask = 0; mask < (1u << n); ++mask)
+    if (__builtin_popcount(mask) == k)
+    {
+      unsigned int p = 1;
+      for (unsigned int d = 0; d < n; ++d)
+        p *= ((mask >> d) & 1) ? dim[d] : mesh.across_extent(d);
+      expected += p;
+    }
+  if (mesh.size() != expected)
+    throw std::logic_error("Wrong size");
+
+  auto check = [&](unsigned int i) {
+    const auto e = mesh[i];
+    if (mesh.index(e) != i)
+      throw std::logic_error("Index differs");
+    if constexpr (k > 0)
+    {
+      const auto boundary = mesh.boundary();
+      for (unsigned int f = 0; f < e.n_facets(); ++f)
+      {
+        const auto facet = e.facet(f);
+        const auto g = boundary[boundary.index(facet)];
+        for (unsigned int d = 0; d < n; ++d)
+          if (g[d] != facet[d] && !(periodic[d] && facet[d] == dim[d] && g[d] == 0))
+            throw std::logic_error("Facet differs");
+      }
+    }
+    ++checked;
+  };
+
+  for (unsigned char b = 0; b < mesh.n_blocks(); ++b)
+    if (mesh.block_size(b) > 0)
+    {
+      check(mesh.block_offset(b));
+      check(mesh.block_offset(b) + mesh.block_size(b) - 1);
+    }
+  const unsigned int step = mesh.size() / 500 + 1;
+  for (unsigned int i = 0; i < mesh.size(); i += step)
+    check(i);
+}
+
+template <int n, int... k>
+void test(std::integer_sequence<int, k...>)
+{
+  unsigned int checked = 0;
+  (test_mesh<n, k>(checked), ...);
+  std::cout << "n=" << n << " checked " << checked << " elements" << std::endl;
+}
+
+int main()
+{
+  test<4>(std::make_integer_sequence<int, 5>());
+  test<5>(std::make_integer_sequence<int, 6>());
+  test<6>(std::make_integer_sequence<int, 7>());
+  test<7>(std::make_integer_sequence<int, 8>());
+  test<8>(std::make_integer_sequence<int, 9>());
+  test<9>(std::make_integer_sequence<int, 10>());
+  test<10>(std::make_integer_sequence<int, 11>());
+}
@@ -0,0 +1,147 @@
+// Unit test:
+// Lexicographic with directions numbered in reverse
+
+// In a reversed direction, the coordinates in each block run backwards. Check operator[] and
+// index() against the unreversed numbering, the block layouts and their neighbor offsets,
+// ElementBlock, the children of Transfer, and that invalid direction orders are rejected.
+
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+#include <tpcc/element_block.h>
+#include <tpcc/transfer.h>
+
+constexpr std::array<unsigned short, 3> dim3{ { 2, 3, 4 } };
+
+template <int k>
+void test(const std::array<bool, 3>& periodic, const std::array<unsigned char, 3>& order,
+          const std::array<bool, 3>& reverse)
+{
+  const TPCC::Lexicographic<3, k> mesh(dim3, periodic, order, reverse);
+  const TPCC::Lexicographic<3, k> forward(dim3, periodic, order);
+  std::cout << "Element-Dim: " << k << " reverse " << reverse[0] << reverse[1] << reverse[2]
+            << " periodic " << periodic[0] << periodic[1] << periodic[2] << std::endl;
+
+  for (unsigned int b = 0; b < mesh.n_blocks(); ++b)
+  {
+    const auto layout = mesh.block_layout(b);
+    const auto forward_layout = forward.block_layout(b);
+    const auto offsets = layout.neighbor_offsets();
+    for (unsigned int i = 0; i < layout.size(); ++i)
+    {
+      // The element at position `i` of the block has mirrored coordinates in reversed directions
+      const auto e = mesh[layout.offset + i];
+      const auto f = forward[layout.offset + i];
+      std::array<unsigned short, 3> x;
+      for (unsigned int d = 0; d < 3; ++d)
+      {
+        x[d] = e[d];
+        const unsigned int mirrored = reverse[d] ? layout.extents[d] - 1 - f[d] : f[d];
+        if (e[d] != mirrored)
+          throw std::logic_error("Reversed coordinate wrong");
+      }
+      if (mesh.index(e) != layout.offset + i || layout.index(x) != layout.offset + i)
+        throw std::logic_error("Index differs");
+      if (forward_layout.index(x) != forward.index(e))
+        throw std::logic_error("Forward layout differs");
+
+      // The upper neighbor in each direction, where it exists
+      for (unsigned int d = 0; d < 3; ++d)
+      {
+        if (x[d] + 1 >= layout.extents[d])
+          continue;
+        auto y = x;
+        ++y[d];
+        unsigned int code = 13;
+        for (unsigned int j = 0, p = 1; j < 3; ++j, p *= 3)
+          if (j == d)
+            code += p;
+        if (layout.index(y) != layout.offset + i + offsets[code])
+          throw std::logic_error("Neighbor offset wrong");
+      }
+    }
+  }
+
+  TPCC::ElementBlock<3, k> block;
+  block.fill(mesh, 1, mesh.size());
+  const auto indices = block.index(mesh);
+  for (unsigned int i = 0; i < block.size(); ++i)
+    if (indices[i] != i + 1 || mesh.index(block[i]) != i + 1)
+      throw std::logic_error("ElementBlock differs");
+
+  if constexpr (k > 0)
+  {
+    const auto boundary = mesh.boundary();
+    for (unsigned int i = 0; i < mesh.size(); ++i)
+    {
+      const auto e = mesh[i];
+      for (unsigned int f = 0; f < e.n_facets(); ++f)
+        if (boundary.index(boundary[boundary.index(e.facet(f))]) !=
+            boundary.index(e.facet(f)))
+          throw std::logic_error("Facet not found");
+    }
+  }
+}
+
+template <int k>
+void test_transfer(const std::array<bool, 3>& reverse)
+{
+  const TPCC::Lexicographic<3, k> coarse(dim3, {}, { { 2, 0, 1 } }, reverse);
+  const TPCC::Transfer<3, k> transfer(coarse);
+  const auto& fine = transfer.fine();
+  for (unsigned int i = 0; i < coarse.size(); ++i)
+  {
+    const auto e = coarse[i];
+    for (const auto c : transfer.children(i))
+    {
+      const auto child = fine[c];
+      for (unsigned int d = 0; d < 3; ++d)
+        if (child[d] != 2 * e[d] && child[d] != 2 * e[d] + 1)
+          throw std::logic_error("Child not inside parent");
+      for (unsigned int j = 0; j < 3 - k; ++j)
+        if (child.across_coordinate(j) != 2 * e.across_coordinate(j))
+          throw std::logic_error("Child not in plane of parent");
+    }
+  }
+}
+
+template <int k>
+void test_all()
+{
+  const std::vector<std::array<bool, 3>> flags{ { { false, false, false } },
+                                                { { true, false, false } },
+                                                { { false, true, true } },
+                                                { { true, true, true } } };
+  for (const auto& reverse : flags)
+  {
+    test<k>({}, { { 0, 1, 2 } }, reverse);
+    test<k>({ { true, false, true } }, { { 1, 2, 0 } }, reverse);
+    test_transfer<k>(reverse);
+  }
+}
+
+int main()
+{
+  test_all<0>();
+  test_all<1>();
+  test_all<2>();
+  test_all<3>();
+
+  for (const auto& order : { std::array<unsigned char, 3>{ { 0, 1, 1 } },
+                             std::array<unsigned char, 3>{ { 0, 1, 3 } } })
+  {
+    bool thrown = false;
+    try
+    {
+      TPCC::Lexicographic<3, 1> mesh(dim3, {}, order);
+    }
+    catch (const std::invalid_argument&)
+    {
+      thrown = true;
+    }
+    if (!thrown)
+      throw std::logic_error("Invalid direction order accepted");
+  }
+  return 0;
+}
@@ -0,0 +1,167 @@
+// Unit test:
+// Masked complexes with holes and their compressed numbering
+
+// Compare rank() and select() of BitVector with counting for random bit patterns of different
+// densities. For boxes with holes cut out, a k-cell must be active exactly if one of the
+// n-cells adjacent to it is active. The compressed numbering must be ascending, invertible and
+// consistent with the facets in boundary(), and compress() and expand() must be inverse on
+// the active cells.
+
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <tpcc/masked_complex.h>
+
+void test_bits(unsigned int size, double density)
+{
+  std::mt19937 gen(size);
+  std::bernoulli_distribution dist(density);
+  std::vector<bool> bits(size);
+  for (unsigned int i = 0; i < size; ++i)
+    bits[i] = dist(gen);
+  TPCC::BitVector<> vector(bits);
+
+  unsigned int count = 0;
+  for (unsigned int i = 0; i <= size; ++i)
+  {
+    if (vector.rank(i) != count)
+      throw std::logic_error("Wrong rank");
+    if (i < size && bits[i])
+    {
+      if (vector.select(count) != i)
+        throw std::logic_error("Wrong select");
+      ++count;
+    }
+    if (i < size && vector[i] != bits[i])
+      throw std::logic_error("Wrong bit");
+  }
+  if (vector.count() != count)
+    throw std::logic_error("Wrong count");
+  std::cout << "bits " << size << " set " << count << std::endl;
+}
+
+template <int n, int k>
+void test_faces(const TPCC::MaskedComplex<n, k>& masked,
+                const TPCC::Lexicographic<n, n>& cells, const std::vector<bool>& cell_mask)
+{
+  const auto& full = masked.full();
+  const auto cell_layout = cells.block_layout(0);
+  unsigned int count = 0;
+  for (unsigned int i = 0; i < full.size(); ++i)
+  {
+    const auto e = full[i];
+    // Visit all n-cells adjacent to e, with coordinate x[d] or x[d]-1 across
+    bool expected = false;
+    for (unsigned int s = 0; s < (1u << (n - k)); ++s)
+    {
+      std::array<unsigned short, n> x;
+      bool exists = true;
+      for (unsigned int d = 0; d < n; ++d)
+        x[d] = e[d];
+      for (unsigned int j = 0; j < n - k; ++j)
+        if ((s >> j) & 1)
+        {
+          const unsigned int d = e.across_direction(j);
+          if (x[d] > 0)
+            --x[d];
+          else if (cells.is_periodic(d))
+            x[d] = cells.fiber_dimension(d) - 1;
+          else
+            exists = false;
+        }
+      for (unsigned int d = 0; d < n; ++d)
+        if (x[d] == cells.fiber_dimension(d))
+          exists = false;
+      if (exists && cell_mask[cell_layout.index(x)])
+        expected = true;
+    }
+    if (masked.is_active(i) != expected)
+      throw std::logic_error("Wrong active cell");
+    if (!expected)
+    {
+      if (masked.compressed_index(i) != masked.invalid || masked.index(e) != masked.invalid)
+        throw std::logic_error("Inactive cell has an index");
+      continue;
+    }
+    if (masked.compressed_index(i) != count || masked.full_index(count) != i)
+      throw std::logic_error("Compressed numbering not ascending");
+    if (masked.index(masked[count]) != count)
+      throw std::logic_error("Index differs");
+    ++count;
+  }
+  if (masked.size() != count)
+    throw std::logic_error("Wrong size");
+
+  if constexpr (k > 0)
+  {
+    const auto boundary = masked.boundary();
+    for (unsigned int i = 0; i < masked.size(); ++i)
+    {
+      const auto e = masked[i];
+      for (unsigned int f = 0; f < e.n_facets(); ++f)
+      {
+        const unsigned int j = boundary.index(e.facet(f));
+        if (j == boundary.invalid)
+          throw std::logic_error("Facet inactive");
+        if (boundary.full_index(j) != boundary.full().index(e.facet(f)))
+          throw std::logic_error("Facet index differs");
+      }
+    }
+    test_faces(boundary, cells, cell_mask);
+  }
+
+  std::vector<double> full_values(full.size()), values(masked.size()), result(full.size());
+  for (unsigned int i = 0; i < full.size(); ++i)
+    full_values[i] = 1. + i;
+  masked.compress(full_values.data(), values.data());
+  masked.expand(values.data(), result.data(), -1.);
+  for (unsigned int i = 0; i < full.size(); ++i)
+    if (result[i] != (masked.is_active(i) ? full_values[i] : -1.))
+      throw std::logic_error("Compress and expand differ");
+
+  std::cout << "  k=" << k << " active " << masked.size() << " of " << full.size()
+            << std::endl;
+}
+
+template <int n>
+void test(const std::array<unsigned short, n>& dim, const std::array<bool, n>& periodic)
+{
+  const TPCC::Lexicographic<n, n> cells(dim, periodic);
+  // A ball removed from the center and an irregular pattern at the first face
+  std::vector<bool> mask(cells.size());
+  for (unsigned int i = 0; i < cells.size(); ++i)
+  {
+    const auto e = cells[i];
+    double r2 = 0.;
+    for (unsigned int d = 0; d < n; ++d)
+    {
+      const double x = (e[d] + 0.5) / dim[d] - 0.5;
+      r2 += x * x;
+    }
+    mask[i] = r2 > 0.09 && !(e[0] == 0 && i % 3 == 1);
+  }
+  std::cout << "n=" << n << " dimensions";
+  for (unsigned int d = 0; d < n; ++d)
+    std::cout << ' ' << dim[d] << (periodic[d] ? "p" : "");
+  std::cout << std::endl;
+
+  const TPCC::MaskedComplex<n, n> masked(cells, mask);
+  test_faces(masked, cells, mask);
+}
+
+int main()
+{
+  test_bits(0, 0.5);
+  test_bits(1, 1.);
+  test_bits(64, 1.);
+  test_bits(1000, 0.5);
+  test_bits(5000, 0.003);
+  test_bits(20000, 0.9);
+  test<1>({ { 13 } }, { { false } });
+  test<2>({ { 10, 7 } }, { { false, false } });
+  test<2>({ { 10, 7 } }, { { true, false } });
+  test<3>({ { 9, 8, 7 } }, { { false, false, false } });
+  test<3>({ { 9, 8, 7 } }, { { false, true, true } });
+}
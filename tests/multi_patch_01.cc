@@ -0,0 +1,185 @@
+// Unit test:
+// Global numbering of multi-patch complexes glued along faces
+
+// Each patch is placed in a global grid by a shift and a signed permutation of its directions.
+// The interfaces are derived from these placements. Then the cells of all patches with the
+// same center in the global grid must have the same global index, and different ones
+// different indices. The test also checks local_index(), global_indices() and ownership, and
+// recurses through boundary() down to the vertices. The geometries are an L-shape, four patches
+// around a vertex glued in a cycle, and a bent channel in three dimensions, where two patches
+// only share an edge.
+
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <vector>
+
+#include <tpcc/multi_patch.h>
+
+template <int n>
+struct Placement
+{
+  /// The global direction of each local direction
+  std::array<unsigned int, n> direction;
+  /// Whether the local direction runs backwards in the global grid
+  std::array<bool, n> flip;
+  /// The global position of the lower corner of the patch
+  std::array<int, n> shift;
+  /// The global size of the patch
+  std::array<unsigned short, n> size;
+
+  std::array<unsigned short, n> dimensions() const
+  {
+    std::array<unsigned short, n> result;
+    for (unsigned int d = 0; d < n; ++d)
+      result[d] = size[direction[d]];
+    return result;
+  }
+
+  /// Twice the global coordinates of the center of `e`
+  template <class E>
+  std::array<int, n> center(const E& e) const
+  {
+    std::array<int, n> local;
+    for (unsigned int d = 0; d < n; ++d)
+      local[d] = 2 * e[d];
+    for (unsigned int i = 0; i < e.n_facets() / 2; ++i)
+      ++local[e.along_direction(i)];
+    std::array<int, n> result;
+    for (unsigned int d = 0; d < n; ++d)
+    {
+      const unsigned int g = direction[d];
+      result[g] = 2 * shift[g] + (flip[d] ? 2 * size[g] - local[d] : local[d]);
+    }
+    return result;
+  }
+};
+
+/// The interface between the upper end of `a` and the lower end of `b` in global direction `g`
+template <int n>
+TPCC::PatchInterface<n> glue(const std::vector<Placement<n>>& placements, unsigned int a,
+                             unsigned int b, unsigned int g)
+{
+  TPCC::PatchInterface<n> result;
+  auto face = [&](unsigned int p, bool upper) {
+    const Placement<n>& place = placements[p];
+    unsigned int d = 0;
+    while (place.direction[d] != g)
+      ++d;
+    return (unsigned char)(2 * d + (upper != place.flip[d] ? 1 : 0));
+  };
+  result.first = { a, face(a, true), {}, {} };
+  result.second = { b, face(b, false), {}, {} };
+  // The directions of `a` in ascending order, matched to `b` through the global directions
+  unsigned int i = 0;
+  for (unsigned int d = 0; d < n; ++d)
+  {
+    const unsigned int h = placements[a].direction[d];
+    if (h == g)
+      continue;
+    unsigned int e = 0;
+    while (placements[b].direction[e] != h)
+      ++e;
+    result.first.directions[i] = d;
+    result.first.reverse[i] = false;
+    result.second.directions[i] = e;
+    result.second.reverse[i] = placements[a].flip[d] != placements[b].flip[e];
+    ++i;
+  }
+  return result;
+}
+
+template <int n, int k>
+void check(const TPCC::MultiPatchComplex<n, k>& complex,
+           const std::vector<Placement<n>>& placements)
+{
+  std::map<std::array<int, n>, unsigned int> numbers;
+  std::vector<bool> seen(complex.size());
+  unsigned int n_shared_runs = 0;
+  for (unsigned int p = 0; p < complex.n_patches(); ++p)
+  {
+    const auto& patch = complex.patch(p);
+    std::vector<unsigned int> indices(patch.size());
+    complex.global_indices(p, indices.data());
+    unsigned int owned = 0;
+    for (unsigned int i = 0; i < patch.size(); ++i)
+    {
+      const auto x = placements[p].center(patch[i]);
+      const unsigned int g = complex.global_index(p, i);
+      if (g != indices[i])
+        throw std::logic_error("global_indices() differs");
+      if (g >= complex.size())
+        throw std::logic_error("Global index too large");
+      auto it = numbers.find(x);
+      if (it == numbers.end())
+      {
+        if (seen[g])
+          throw std::logic_error("Different cells with the same index");
+        seen[g] = true;
+        numbers[x] = g;
+        if (!complex.is_owned(p, i))
+          throw std::logic_error("First occurence not owned");
+      }
+      else if (it->second != g)
+        throw std::logic_error("Same cell with different indices");
+      else if (complex.is_owned(p, i))
+        throw std::logic_error("Shared cell owned twice");
+      if (complex.is_owned(p, i))
+      {
+        if (g != complex.offset(p) + owned++)
+          throw std::logic_error("Owned cells not consecutive");
+        const auto local = complex.local_index(g);
+        if (local.first != p || local.second != i)
+          throw std::logic_error("Wrong local index");
+      }
+    }
+    if (owned != complex.n_owned(p))
+      throw std::logic_error("Wrong number of owned cells");
+    n_shared_runs += complex.n_shared_runs(p);
+  }
+  if (numbers.size() != complex.size())
+    throw std::logic_error("Wrong size");
+  std::cout << "  k=" << k << " cells " << complex.size() << " shared runs " << n_shared_runs
+            << std::endl;
+  if constexpr (k > 0)
+    check(complex.boundary(), placements);
+}
+
+template <int n>
+void test(const char* name, const std::vector<Placement<n>>& placements,
+          const std::vector<std::array<unsigned int, 3>>& interfaces)
+{
+  std::cout << name << std::endl;
+  std::vector<TPCC::Lexicographic<n, n>> patches;
+  for (const auto& p : placements)
+    patches.emplace_back(p.dimensions());
+  std::vector<TPCC::PatchInterface<n>> glued;
+  for (const auto& i : interfaces)
+    glued.push_back(glue(placements, i[0], i[1], i[2]));
+  check(TPCC::MultiPatchComplex<n, n>(patches, glued), placements);
+}
+
+int main()
+{
+  test<1>("Interval", { { { { 0 } }, { { false } }, { { 0 } }, { { 3 } } },
+                        { { { 0 } }, { { true } }, { { 3 } }, { { 4 } } } },
+          { { { 0, 1, 0 } } });
+
+  test<2>("L-shape", { { { { 0, 1 } }, { { false, false } }, { { 0, 0 } }, { { 3, 4 } } },
+                       { { { 1, 0 } }, { { false, true } }, { { 3, 0 } }, { { 5, 4 } } },
+                       { { { 0, 1 } }, { { false, true } }, { { 0, 4 } }, { { 3, 2 } } } },
+          { { { 0, 1, 0 } }, { { 0, 2, 1 } } });
+
+  test<2>("Four patches around a vertex",
+          { { { { 0, 1 } }, { { false, false } }, { { 0, 0 } }, { { 2, 3 } } },
+            { { { 1, 0 } }, { { true, false } }, { { 2, 0 } }, { { 4, 3 } } },
+            { { { 0, 1 } }, { { true, true } }, { { 0, 3 } }, { { 2, 2 } } },
+            { { { 1, 0 } }, { { false, true } }, { { 2, 3 } }, { { 4, 2 } } } },
+          { { { 0, 1, 0 } }, { { 0, 2, 1 } }, { { 1, 3, 1 } }, { { 2, 3, 0 } } });
+
+  test<3>("Bent channel",
+          { { { { 0, 1, 2 } }, { { false, false, false } }, { { 0, 0, 0 } }, { { 3, 4, 5 } } },
+            { { { 0, 2, 1 } }, { { false, false, true } }, { { 3, 0, 0 } }, { { 4, 4, 5 } } },
+            { { { 0, 1, 2 } }, { { true, false, false } }, { { 0, 4, 0 } }, { { 3, 2, 5 } } } },
+          { { { 0, 1, 0 } }, { { 0, 2, 1 } } });
+}
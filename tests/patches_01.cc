@@ -0,0 +1,128 @@
+// Unit test:
+// Vertex patches of a Lexicographic complex
+
+// Compare the open stars of all vertices with the cells having the vertex as a corner, the
+// closed stars with the faces of the n-cells in the open star, and the batched lists with the
+// single ones.
+
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+#include <tpcc/patches.h>
+
+/// The coordinates of a cell, which are those of its lowest vertex
+template <int n, int k>
+std::array<unsigned short, n> lower_corner(const TPCC::Element<n, k>& e)
+{
+  std::array<unsigned short, n> result;
+  for (unsigned int d = 0; d < n; ++d)
+    result[d] = e[d];
+  return result;
+}
+
+/// Whether `v` is one of the vertices of `e`, where vertices may wrap around periodically
+template <int n, int k, class A, class P>
+bool is_vertex(const TPCC::Element<n, k>& e, const TPCC::Element<n, 0>& v, const A& dim,
+               const P& periodic)
+{
+  for (unsigned int c = 0; c < (1u << k); ++c)
+  {
+    bool equal = true;
+    for (unsigned int d = 0; d < n; ++d)
+    {
+      unsigned int x = e[d];
+      for (unsigned int j = 0; j < k; ++j)
+        if (e.along_direction(j) == d && ((c >> j) & 1))
+          ++x;
+      equal = equal && (x == v[d] || (periodic[d] && x == v[d] + dim[d]));
+    }
+    if (equal)
+      return true;
+  }
+  return false;
+}
+
+template <int n, int k>
+void test(const std::array<unsigned short, n>& dim, const std::array<bool, n>& periodic,
+          bool closed)
+{
+  TPCC::Lexicographic<n, k> mesh(dim, periodic);
+  TPCC::Lexicographic<n, 0> vertices(dim, periodic);
+  TPCC::Lexicographic<n, n> cells(dim, periodic);
+  TPCC::VertexPatches<n, k> patches(mesh, closed);
+  std::cout << "Mesh-Dim: " << n << " Element-Dim: " << k << (closed ? " closed" : " open")
+            << " vertices " << patches.n_vertices() << " max " << patches.max_patch_size();
+  if (patches.n_vertices() != vertices.size())
+    throw std::logic_error("Wrong number of vertices");
+
+  const auto all = patches.patches();
+  const auto batch = patches.patches(2, patches.n_vertices() - 1);
+  for (unsigned int i = 0; i < batch.size(); ++i)
+    if (!std::equal(batch.begin(i), batch.end(i), all.begin(i + 2), all.end(i + 2)))
+      throw std::logic_error("Batch differs");
+
+  unsigned int total = 0;
+  for (unsigned int vi = 0; vi < vertices.size(); ++vi)
+  {
+    const auto v = vertices[vi];
+    // The open star contains the cells with `v` as a vertex, the closed star all faces of the
+    // `n`-cells in the open star
+    std::vector<unsigned int> expected;
+    std::vector<std::array<unsigned short, n>> stars;
+    for (unsigned int i = 0; i < cells.size(); ++i)
+      if (is_vertex(cells[i], v, dim, periodic))
+        stars.push_back(lower_corner(cells[i]));
+    for (unsigned int i = 0; i < mesh.size(); ++i)
+    {
+      const auto e = mesh[i];
+      bool found = false;
+      if (!closed)
+        found = is_vertex(e, v, dim, periodic);
+      else
+        for (const auto& star : stars)
+        {
+          bool face = true;
+          for (unsigned int d = 0; d < n; ++d)
+          {
+            bool along = false;
+            for (unsigned int j = 0; j < k; ++j)
+              along = along || e.along_direction(j) == d;
+            const unsigned int upper = (star[d] + 1 == dim[d] && periodic[d]) ? 0 : star[d] + 1;
+            face = face && (e[d] == star[d] || (!along && e[d] == upper));
+          }
+          found = found || face;
+        }
+      if (found)
+        expected.push_back(i);
+    }
+    if (!std::equal(expected.begin(), expected.end(), all.begin(vi), all.end(vi)))
+      throw std::logic_error("Patch differs");
+    if (expected.size() > patches.max_patch_size())
+      throw std::logic_error("Patch too large");
+    total += expected.size();
+  }
+  std::cout << " total " << total << std::endl;
+}
+
+template <int n>
+void test_all(const std::array<unsigned short, n>& dim, const std::array<bool, n>& periodic)
+{
+  for (bool closed : { true, false })
+  {
+    test<n, 0>(dim, periodic, closed);
+    test<n, 1>(dim, periodic, closed);
+    test<n, n - 1>(dim, periodic, closed);
+    test<n, n>(dim, periodic, closed);
+  }
+}
+
+int main()
+{
+  test_all<2>({ { 3, 4 } }, { { false, false } });
+  test_all<2>({ { 3, 2 } }, { { true, true } });
+  test_all<3>({ { 2, 3, 4 } }, { { false, false, false } });
+  test_all<3>({ { 2, 3, 4 } }, { { false, true, true } });
+  return 0;
+}
@@ -0,0 +1,87 @@
+// Unit test:
+// BoundedQueue
+// pipeline_for_each()
+
+// Check that each element is processed exactly once with the correct element and facets.
+
+#include <atomic>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+#include <tpcc/pipeline.h>
+#include <tpcc/slab.h>
+
+constexpr std::array<unsigned short, 3> dim3{ { 5, 6, 7 } };
+
+template <class E>
+std::string to_string(const E& e)
+{
+  std::stringstream os;
+  e.print_debug(os);
+  return os.str();
+}
+
+template <bool facets, class MESH>
+void test(const MESH& mesh, std::size_t batch_size, unsigned int n_workers)
+{
+  std::vector<std::atomic<unsigned int>> visits(mesh.size());
+  std::atomic<bool> correct(true);
+  TPCC::PipelineOptions options;
+  options.batch_size = batch_size;
+  options.n_workers = n_workers;
+  options.facets = facets;
+
+  TPCC::pipeline_for_each(
+    mesh,
+    [&](const TPCC::ElementBatch<MESH>& batch) {
+      for (std::size_t i = 0; i < batch.elements.size(); ++i)
+      {
+        ++visits[batch.first + i];
+        if (to_string(batch.elements[i]) != to_string(mesh[batch.first + i]))
+          correct = false;
+      }
+      if constexpr (facets)
+      {
+        const auto boundary = mesh.boundary();
+        const std::size_t nf = batch.elements[0].n_facets();
+        if (batch.facets.size() != nf * batch.elements.size())
+          correct = false;
+        for (std::size_t i = 0; i < batch.elements.size(); ++i)
+          for (std::size_t f = 0; f < nf; ++f)
+            if (batch.facets[nf * i + f] != boundary.index(batch.elements[i].facet(f)))
+              correct = false;
+      }
+    },
+    options);
+
+  for (const auto& v : visits)
+    if (v != 1)
+      throw std::logic_error("Element not visited exactly once");
+  if (!correct)
+    throw std::logic_error("Batch content wrong");
+  std::cout << "Size " << mesh.size() << " batch size " << batch_size << " workers " << n_workers
+            << " ok" << std::endl;
+}
+
+int main()
+{
+  TPCC::BoundedQueue<int> queue(3);
+  for (int i = 0; i < 4; ++i)
+    if (!queue.try_push(i))
+      throw std::logic_error("Queue full too early");
+  if (queue.try_push(4))
+    throw std::logic_error("Queue not bounded");
+  for (int i = 0; i < 4; ++i)
+    if (queue.pop() != i)
+      throw std::logic_error("Queue order wrong");
+
+  TPCC::Lexicographic<3, 2> mesh(dim3);
+  test<true>(mesh, 1, 1);
+  test<true>(mesh, 16, 3);
+  test<false>(mesh, 1000, 2);
+  test<false>(TPCC::Lexicographic<3, 0>(dim3), 7, 2);
+  TPCC::Slab<3, 2> slab(mesh, { 0, 1 }, { false, false }, 2, 3);
+  test<false>(slab, 5, 2);
+  return 0;
+}
@@ -0,0 +1,164 @@
+// Unit test:
+// Batched point location on uniform and graded tensor product grids
+
+// Compare cell indices and local coordinates with a linear search through the nodes and the
+// element returned by Lexicographic::operator[], the faces with CellClosure, and the threaded
+// results with the serial ones. Points outside non-periodic directions and points with
+// non-finite coordinates must be invalid.
+
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <tpcc/point_location.h>
+
+template <int n>
+void test(const std::array<unsigned short, n>& dim, const std::array<bool, n>& periodic,
+          bool graded)
+{
+  TPCC::Lexicographic<n, n> cells(dim, periodic);
+  std::array<std::vector<double>, n> nodes;
+  std::array<double, n> origin, spacing;
+  for (unsigned int d = 0; d < n; ++d)
+  {
+    origin[d] = -1. + d;
+    spacing[d] = 0.5 + 0.25 * d;
+    for (unsigned int i = 0; i <= dim[d]; ++i)
+    {
+      const double s = double(i) / dim[d];
+      nodes[d].push_back(origin[d] + dim[d] * spacing[d] * (graded ? s * s : s));
+    }
+  }
+  const auto locator = graded ? TPCC::PointLocator<n>(cells, nodes)
+                              : TPCC::PointLocator<n>(cells, origin, spacing);
+
+  // Points in a box larger than the grid
+  const unsigned int n_points = 3000;
+  std::mt19937 gen(7);
+  std::vector<double> points(n_points * n);
+  for (unsigned int i = 0; i < n_points; ++i)
+    for (unsigned int d = 0; d < n; ++d)
+    {
+      const double length = nodes[d].back() - nodes[d].front();
+      std::uniform_real_distribution<double> dist(nodes[d].front() - 0.2 * length,
+                                                  nodes[d].back() + 0.2 * length);
+      points[i * n + d] = dist(gen);
+    }
+
+  std::vector<unsigned int> index(n_points), faces(n_points * locator.n_faces());
+  std::vector<double> local(n_points * n);
+  locator.locate(n_points, points.data(), index.data(), local.data(), faces.data());
+
+  TPCC::CellClosure<n> closure(cells);
+  unsigned int n_inside = 0;
+  for (unsigned int i = 0; i < n_points; ++i)
+  {
+    bool inside = true;
+    std::array<double, n> expected_local;
+    std::array<unsigned int, n> c;
+    for (unsigned int d = 0; d < n; ++d)
+    {
+      double x = points[i * n + d];
+      const double length = nodes[d].back() - nodes[d].front();
+      if (periodic[d])
+        x -= std::floor((x - nodes[d].front()) / length) * length;
+      inside = inside && x >= nodes[d].front() && x <= nodes[d].back();
+      c[d] = 0;
+      while (c[d] + 1 < dim[d] && x >= nodes[d][c[d] + 1])
+        ++c[d];
+      expected_local[d] = (x - nodes[d][c[d]]) / (nodes[d][c[d] + 1] - nodes[d][c[d]]);
+    }
+    if (!inside)
+    {
+      if (index[i] != locator.invalid)
+        throw std::logic_error("Point outside not detected");
+      continue;
+    }
+    ++n_inside;
+    if (index[i] >= cells.size())
+      throw std::logic_error("Point inside not found");
+    const auto e = cells[index[i]];
+    for (unsigned int d = 0; d < n; ++d)
+    {
+      if (e[d] != c[d])
+        throw std::logic_error("Wrong cell");
+      if (std::fabs(local[i * n + d] - expected_local[d]) > 1.e-10)
+        throw std::logic_error("Wrong local coordinate");
+    }
+    const auto table = closure.table(index[i], index[i] + 1);
+    for (unsigned int f = 0; f < locator.n_faces(); ++f)
+      if (faces[i * locator.n_faces() + f] != table[f])
+        throw std::logic_error("Wrong face");
+  }
+
+  std::vector<unsigned int> threaded(n_points);
+  locator.locate(n_points, points.data(), threaded.data(), nullptr, nullptr, 3);
+  if (threaded != index)
+    throw std::logic_error("Threaded location differs");
+
+  std::cout << "n=" << n << (graded ? " graded" : " uniform") << " periodic";
+  for (unsigned int d = 0; d < n; ++d)
+    std::cout << ' ' << periodic[d];
+  std::cout << " inside " << n_inside << " of " << n_points << std::endl;
+}
+
+template <int n>
+void test_non_finite(const std::array<bool, n>& periodic, bool graded)
+{
+  std::array<unsigned short, n> dim;
+  std::array<std::vector<double>, n> nodes;
+  std::array<double, n> origin, spacing;
+  for (unsigned int d = 0; d < n; ++d)
+  {
+    dim[d] = 4;
+    origin[d] = 0.;
+    spacing[d] = 1.;
+    for (unsigned int i = 0; i <= dim[d]; ++i)
+      nodes[d].push_back(graded ? 0.25 * i * i : i);
+  }
+  TPCC::Lexicographic<n, n> cells(dim, periodic);
+  const auto locator = graded ? TPCC::PointLocator<n>(cells, nodes)
+                              : TPCC::PointLocator<n>(cells, origin, spacing);
+
+  // Each point has one non-finite coordinate, the others are inside
+  const double values[3] = { std::numeric_limits<double>::quiet_NaN(),
+                             std::numeric_limits<double>::infinity(),
+                             -std::numeric_limits<double>::infinity() };
+  const unsigned int n_points = 3 * n;
+  std::vector<double> points(n_points * n, 1.5);
+  for (unsigned int d = 0; d < n; ++d)
+    for (unsigned int v = 0; v < 3; ++v)
+      points[(3 * d + v) * n + d] = values[v];
+
+  std::vector<unsigned int> index(n_points), faces(n_points * locator.n_faces());
+  std::vector<double> local(n_points * n);
+  locator.locate(n_points, points.data(), index.data(), local.data(), faces.data());
+  for (unsigned int i = 0; i < n_points; ++i)
+  {
+    if (index[i] != locator.invalid)
+      throw std::logic_error("Non-finite point located");
+    for (unsigned int f = 0; f < locator.n_faces(); ++f)
+      if (faces[i * locator.n_faces() + f] != locator.invalid)
+        throw std::logic_error("Faces of non-finite point");
+  }
+}
+
+int main()
+{
+  test<1>({ { 7 } }, { { false } }, false);
+  test<1>({ { 7 } }, { { true } }, true);
+  test<2>({ { 5, 3 } }, { { false, false } }, false);
+  test<2>({ { 5, 3 } }, { { false, true } }, true);
+  test<3>({ { 4, 3, 5 } }, { { false, false, false } }, false);
+  test<3>({ { 4, 3, 5 } }, { { true, false, false } }, false);
+  test<3>({ { 4, 3, 5 } }, { { false, false, true } }, true);
+  for (const bool graded : { false, true })
+  {
+    test_non_finite<1>({ { false } }, graded);
+    test_non_finite<1>({ { true } }, graded);
+    test_non_finite<3>({ { false, true, false } }, graded);
+  }
+}
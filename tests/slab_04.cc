@@ -0,0 +1,113 @@
+// Unit test:
+// Exchange of cochain values between two complexes through Slab::pack() and Slab::unpack()
+
+// Two "ranks" own the boxes A and B, which overlap in one layer of cells in direction 0.
+// The coordinate system of B is rotated with respect to A: its direction 1 is the direction 2 of
+// A and its direction 2 is the direction 1 of A reflected. The slabs on both sides are set up
+// with #directions and #reverse such that they enumerate the same cells in the same order.
+
+#include <atomic>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <tpcc/slab.h>
+
+constexpr std::array<unsigned short, 3> dimA{ { 3, 4, 5 } };
+constexpr std::array<unsigned short, 3> dimB{ { 3, 5, 4 } };
+
+/// Twice the coordinates of the center of a cell
+template <class E>
+std::array<int, 3> center(const E& e)
+{
+  std::array<int, 3> result;
+  for (unsigned int d = 0; d < 3; ++d)
+    result[d] = 2 * e[d];
+  for (unsigned int i = 0; i < e.n_facets() / 2; ++i)
+    ++result[e.along_direction(i)];
+  return result;
+}
+
+/// Map the center of a cell in B to the coordinates of A
+std::array<int, 3> b_to_a(const std::array<int, 3>& x, bool periodic)
+{
+  const int length = 2 * dimA[1];
+  int x1 = length - x[2];
+  if (periodic)
+    x1 %= length;
+  return { { x[0] + 2 * (dimA[0] - 1), x1, x[1] } };
+}
+
+double f(const std::array<int, 3>& x)
+{
+  return 10000. * x[0] + 100. * x[1] + x[2];
+}
+
+template <int k>
+void test(bool periodic)
+{
+  TPCC::Lexicographic<3, k> meshA(dimA, { { false, periodic, false } });
+  TPCC::Lexicographic<3, k> meshB(dimB, { { false, false, periodic } });
+  TPCC::Slab<3, k> slabA(meshA, { { 1, 2 } }, { { false, false } }, 0, dimA[0] - 1);
+  TPCC::Slab<3, k> slabB(meshB, { { 2, 1 } }, { { true, false } }, 0, 0);
+  std::cout << "k=" << k << " periodic " << periodic << " slab size " << slabA.size()
+            << std::endl;
+  if (slabA.size() != slabB.size())
+    throw std::logic_error("Slab sizes differ");
+
+  for (unsigned int i = 0; i < slabA.size(); ++i)
+    if (center(slabA[i]) != b_to_a(center(slabB[i]), periodic))
+      throw std::logic_error("Slabs enumerate different cells");
+
+  std::vector<double> valuesA(meshA.size());
+  for (unsigned int i = 0; i < meshA.size(); ++i)
+    valuesA[i] = f(center(meshA[i]));
+  std::vector<double> valuesB(meshB.size(), -1.);
+
+  // The buffer in shared memory and the two ranks
+  std::vector<double> buffer(slabA.size());
+  std::atomic<bool> ready(false);
+  std::thread rankB([&]() {
+    while (!ready.load(std::memory_order_acquire))
+      std::this_thread::yield();
+    slabB.unpack(buffer.data(), valuesB.data());
+  });
+  std::thread rankA([&]() {
+    slabA.pack(valuesA.data(), buffer.data());
+    ready.store(true, std::memory_order_release);
+  });
+  rankA.join();
+  rankB.join();
+
+  for (unsigned int i = 0; i < slabA.size(); ++i)
+  {
+    if (buffer[i] != valuesA[meshA.index(slabA[i])])
+      throw std::logic_error("Packed value differs");
+    const auto e = slabB[i];
+    if (valuesB[meshB.index(e)] != f(b_to_a(center(e), periodic)))
+      throw std::logic_error("Unpacked value differs");
+  }
+  unsigned int changed = 0;
+  for (double v : valuesB)
+    if (v != -1.)
+      ++changed;
+  if (changed != slabB.size())
+    throw std::logic_error("Values outside the slab changed");
+
+  std::vector<double> back(slabB.size());
+  slabB.pack(valuesB.data(), back.data());
+  if (back != buffer)
+    throw std::logic_error("Pack after unpack differs");
+}
+
+int main()
+{
+  for (bool periodic : { false, true })
+  {
+    test<1>(periodic);
+    test<2>(periodic);
+    test<3>(periodic);
+  }
+  return 0;
+}
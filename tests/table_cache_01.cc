@@ -0,0 +1,71 @@
+// Unit test:
+// MappedTables::write()
+// MappedTables::open()
+// facet_table()
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+#include <tpcc/table_cache.h>
+
+constexpr std::array<unsigned short, 3> dim3{ { 2, 3, 4 } };
+constexpr std::array<unsigned short, 3> dim3b{ { 2, 3, 5 } };
+
+int main()
+{
+  const char* filename = "table_cache_01.tpcc";
+  TPCC::Lexicographic<3, 2> mesh(dim3);
+  auto facets = mesh.boundary();
+
+  std::vector<std::pair<std::string, std::vector<unsigned int>>> tables;
+  tables.emplace_back("facets", TPCC::facet_table(mesh));
+  tables.emplace_back("edges", TPCC::facet_table(facets));
+  tables.emplace_back("empty", std::vector<unsigned int>());
+  if (!TPCC::MappedTables<3, 2>::write(filename, mesh, tables))
+    throw std::runtime_error("Could not write file");
+
+  {
+    TPCC::MappedTables<3, 2> cache;
+    if (!cache.open(filename, mesh))
+      throw std::logic_error("Could not open valid file");
+    std::cout << "Tables: " << cache.n_tables() << std::endl;
+    for (const auto& t : tables)
+    {
+      auto view = cache.table(t.first);
+      std::cout << "  " << t.first << ": " << view.size() << std::endl;
+      if (!std::equal(view.begin(), view.end(), t.second.begin(), t.second.end()))
+        throw std::logic_error("Table differs");
+    }
+    if (cache.table("missing").size() != 0)
+      throw std::logic_error("Missing table found");
+    for (unsigned int i = 0; i < mesh.size(); ++i)
+      for (unsigned int f = 0; f < 4; ++f)
+        if (cache.table("facets")[4 * i + f] != facets.index(mesh[i].facet(f)))
+          throw std::logic_error("Facet table wrong");
+  }
+
+  // Different dimensions and different element dimension must be rejected
+  TPCC::MappedTables<3, 2> other;
+  if (other.open(filename, TPCC::Lexicographic<3, 2>(dim3b)))
+    throw std::logic_error("Opened file for wrong dimensions");
+  TPCC::MappedTables<3, 1> edges;
+  if (edges.open(filename, facets))
+    throw std::logic_error("Opened file for wrong element dimension");
+
+  // Corrupt a single byte of the data
+  {
+    std::fstream file(filename, std::ios::binary | std::ios::in | std::ios::out);
+    file.seekp(-3, std::ios::end);
+    file.put('\x7f');
+  }
+  if (other.open(filename, mesh))
+    throw std::logic_error("Opened corrupted file");
+  std::cout << "Corrupted file rejected" << std::endl;
+
+  std::remove(filename);
+  if (other.open(filename, mesh))
+    throw std::logic_error("Opened missing file");
+  return 0;
+}
@@ -0,0 +1,105 @@
+// Unit test:
+// Transfer::children()
+// Transfer::prolongate()
+// Transfer::restrict_values()
+// Transfer::restriction_matrix()
+// Transfer::prolongation_matrix()
+
+// Compare children with the elements obtained by doubling coordinates, check that restriction
+// inverts prolongation and that prolongation reproduces cochains of forms with coefficients
+// affine in the directions across the cells, for instance linear functions for k=0.
+
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+
+#include <tpcc/transfer.h>
+
+constexpr std::array<unsigned short, 2> dim2{ { 2, 3 } };
+constexpr std::array<unsigned short, 3> dim3{ { 2, 3, 4 } };
+
+template <int n, int k>
+void test(const std::array<unsigned short, n>& dim, unsigned int n_threads,
+          const std::array<bool, n>& periodic = {})
+{
+  TPCC::Lexicographic<n, k> coarse(dim, periodic);
+  TPCC::Transfer<n, k> transfer(coarse);
+  const auto& fine = transfer.fine();
+  std::cout << "Mesh-Dim: " << n << " Element-Dim: " << k << " coarse " << coarse.size()
+            << " fine " << fine.size() << std::endl;
+
+  for (unsigned int i = 0; i < coarse.size(); ++i)
+  {
+    const auto e = coarse[i];
+    const auto children = transfer.children(i);
+    for (unsigned int c = 0; c < children.size(); ++c)
+    {
+      const auto child = fine[children[c]];
+      if (child.direction_index() != e.direction_index())
+        throw std::logic_error("Child has different orientation");
+      for (unsigned int d = 0; d < n; ++d)
+        if (child[d] != 2 * e[d] && child[d] != 2 * e[d] + 1)
+          throw std::logic_error("Child not inside parent");
+      for (unsigned int j = 0; j < n - k; ++j)
+        if (child.across_coordinate(j) != 2 * e.across_coordinate(j))
+          throw std::logic_error("Child not in plane of parent");
+    }
+  }
+
+  std::vector<double> c(coarse.size()), f(fine.size()), pc(fine.size()), rf(coarse.size());
+  for (unsigned int i = 0; i < c.size(); ++i)
+    c[i] = std::sin(i + 1.);
+  for (unsigned int i = 0; i < f.size(); ++i)
+    f[i] = std::cos(i + 1.);
+  transfer.prolongate(c.data(), pc.data(), n_threads);
+  transfer.restrict_values(f.data(), rf.data(), n_threads);
+
+  // The cochain of a form with coefficient `1+sum (d+1) x_d` over the directions across,
+  // measured in coarse cells. Periodic directions are left out.
+  auto affine = [&](const auto& e, double h) {
+    double value = 1.;
+    for (unsigned int j = 0; j < n - k; ++j)
+      if (!periodic[e.across_direction(j)])
+        value += (e.across_direction(j) + 1) * h * e.across_coordinate(j);
+    return value * std::pow(h, k);
+  };
+  std::vector<double> a(coarse.size()), pa(fine.size());
+  for (unsigned int i = 0; i < coarse.size(); ++i)
+    a[i] = affine(coarse[i], 1.);
+  transfer.prolongate(a.data(), pa.data(), n_threads);
+  for (unsigned int i = 0; i < fine.size(); ++i)
+    if (std::abs(pa[i] - affine(fine[i], .5)) > 1.e-12)
+      throw std::logic_error("Prolongation not exact for affine coefficients");
+
+  // Restriction of prolongation is the identity
+  transfer.restrict_values(pc.data(), rf.data(), n_threads);
+  for (unsigned int i = 0; i < c.size(); ++i)
+    if (std::abs(rf[i] - c[i]) > 1.e-14)
+      throw std::logic_error("Restriction does not invert prolongation");
+
+  // Matrices yield the same results
+  std::vector<double> y(fine.size());
+  transfer.prolongation_matrix().vmult(y.data(), c.data());
+  for (unsigned int i = 0; i < fine.size(); ++i)
+    if (std::abs(y[i] - pc[i]) > 1.e-14)
+      throw std::logic_error("Prolongation matrix differs");
+  y.resize(coarse.size());
+  transfer.restriction_matrix().vmult(y.data(), pc.data());
+  if (y != rf)
+    throw std::logic_error("Restriction matrix differs");
+}
+
+int main()
+{
+  test<2, 0>(dim2, 1);
+  test<2, 1>(dim2, 2);
+  test<2, 2>(dim2, 3);
+  test<3, 0>(dim3, 1);
+  test<3, 1>(dim3, 2);
+  test<3, 2>(dim3, 3);
+  test<3, 3>(dim3, 4);
+  test<2, 0>(dim2, 2, { { true, false } });
+  test<2, 1>(dim2, 1, { { false, true } });
+  test<3, 1>(dim3, 3, { { true, false, true } });
+  return 0;
+}
@@ -0,0 +1,63 @@
+// Unit test:
+// write_vtk()
+
+// Compare the size of the output with the expected size, check that the output does not depend
+// on the chunk size and decode the first point.
+
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+#include <tpcc/slab.h>
+#include <tpcc/vtk.h>
+
+constexpr std::array<unsigned short, 2> dim2{ { 2, 3 } };
+constexpr std::array<unsigned short, 3> dim3{ { 2, 3, 4 } };
+
+template <class CELLS>
+void test(const CELLS& cells, unsigned int k)
+{
+  std::vector<double> values(cells.size());
+  for (unsigned int i = 0; i < values.size(); ++i)
+    values[i] = i;
+
+  std::ostringstream os1, os2;
+  TPCC::write_vtk(os1, cells, { { "index", values.data() } });
+  TPCC::write_vtk(os2, cells, { { "index", values.data() } }, 0.8, 1);
+  if (os1.str() != os2.str())
+    throw std::logic_error("Output depends on chunk size");
+
+  const std::string s = os1.str();
+  const std::size_t header = s.find("POINTS");
+  std::cout << s.substr(0, header) << "Cells: " << cells.size() << " Bytes: " << s.size()
+            << std::endl;
+  const std::size_t vertices = 1 << k;
+  const std::size_t binary = cells.size() * (vertices * 3 * 4 + (vertices + 1) * 4 + 4 + 8);
+  if (s.size() <= binary || s.size() > binary + 256)
+    throw std::logic_error("Output size wrong");
+
+  // The first coordinate of the first point is 0.1 or 0 in big endian
+  const std::size_t start = s.find('\n', header) + 1;
+  unsigned char bytes[4];
+  for (unsigned int i = 0; i < 4; ++i)
+    bytes[i] = s[start + 3 - i];
+  float x;
+  std::memcpy(&x, bytes, 4);
+  std::cout << "First coordinate: " << x << std::endl;
+  if (x != 0.f && std::abs(x - 0.1f) > 1.e-6)
+    throw std::logic_error("First point wrong");
+}
+
+int main()
+{
+  test(TPCC::Lexicographic<2, 0>(dim2), 0);
+  test(TPCC::Lexicographic<2, 1>(dim2), 1);
+  test(TPCC::Lexicographic<2, 2>(dim2), 2);
+  test(TPCC::Lexicographic<3, 3>(dim3), 3);
+  TPCC::Lexicographic<3, 2> mesh(dim3);
+  TPCC::Slab<3, 2> slab(mesh, { 0, 1 }, { false, false }, 2, 1);
+  test(slab, 2);
+  return 0;
+}